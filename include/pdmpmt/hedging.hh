@@ -0,0 +1,341 @@
+/**
+ * @file hedging.hh
+ * @author Derek Huang
+ * @brief C++ header for chunked scheduling with hedged straggler execution
+ * @copyright MIT License
+ */
+
+#ifndef PDMPMT_HEDGING_HH_
+#define PDMPMT_HEDGING_HH_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "pdmpmt/worker_pool.hh"
+
+namespace pdmpmt {
+
+/**
+ * Hedging policy for chunked runs.
+ *
+ * Once every chunk has been claimed, a worker with nothing left to claim
+ * starts another copy of any running chunk whose time since its latest copy
+ * started exceeds `slowdown` times its expected duration. The expected duration is the chunk
+ * cost times the mean time per unit cost of the chunks finished so far, so
+ * nothing is hedged until at least one chunk finishes. Each chunk runs at
+ * most `max_copies` copies at once, so a `max_copies` of 1 disables hedging.
+ */
+struct hedge_policy {
+  double slowdown = 2.;
+  unsigned int max_copies = 2u;
+};
+
+/**
+ * Hedged run statistics.
+ */
+struct hedge_stats {
+  std::size_t n_chunks = 0u;  // number of chunks
+  std::size_t n_hedges = 0u;  // number of extra copies started
+  std::size_t n_wins = 0u;    // number of chunks won by an extra copy
+};
+
+/**
+ * Cancellation token passed to each running copy of a chunk.
+ *
+ * A copy should poll `cancelled` every so often and return early once it is
+ * true, as another copy of the chunk has already finished and its own result
+ * will be discarded.
+ */
+class hedge_token {
+public:
+  /**
+   * Ctor.
+   *
+   * @param done Flag set once a copy of the chunk has finished
+   * @param copy Copy index, where 0 is the original copy
+   */
+  hedge_token(const std::atomic<bool>& done, unsigned int copy) noexcept
+    : done_{done}, copy_{copy}
+  {}
+
+  /**
+   * Return `true` if another copy of the chunk has already finished.
+   */
+  bool cancelled() const noexcept
+  {
+    return done_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Return the copy index, where 0 is the original copy.
+   */
+  auto copy() const noexcept { return copy_; }
+
+private:
+  const std::atomic<bool>& done_;
+  unsigned int copy_;
+};
+
+namespace detail {
+
+/**
+ * Shared state for a hedged chunked run.
+ *
+ * Chunks are claimed from a shared counter. Each chunk records the start time
+ * of its latest copy, number of copies started, and whether a copy has finished, on its own
+ * cache line since idle workers scan these while other workers update them.
+ *
+ * @tparam R Chunk result type
+ */
+template <typename R>
+class hedged_run {
+public:
+  /**
+   * Ctor.
+   *
+   * @param costs Per-chunk costs, e.g. sample counts
+   * @param policy Hedging policy
+   */
+  hedged_run(const std::vector<std::size_t>& costs, const hedge_policy& policy)
+    : costs_{costs},
+      policy_{policy},
+      chunks_{std::make_unique<chunk_state[]>(costs.size())},
+      results_(costs.size())
+  {}
+
+  /**
+   * Run chunks on the calling worker until all chunks are finished.
+   *
+   * @tparam F Callable with signature `R(std::size_t, const hedge_token&)`
+   *
+   * @param func Callable invoked with the chunk index and token
+   */
+  template <typename F>
+  void work(F& func)
+  {
+    auto n_chunks = costs_.size();
+    while (true) {
+      // idle workers spin here in the tail, so only claim with a
+      // read-modify-write while chunks are left to avoid contending on next_
+      if (next_.load(std::memory_order_relaxed) < n_chunks) {
+        auto i = next_.fetch_add(1u, std::memory_order_relaxed);
+        if (i < n_chunks) {
+          auto& chunk = chunks_[i];
+          chunk.start_ns.store(steady_ns(), std::memory_order_relaxed);
+          chunk.n_copies.store(1u, std::memory_order_relaxed);
+          // release so idle workers that see the copy running see the start
+          chunk.n_running.store(1u, std::memory_order_release);
+          execute(func, i, 0u);
+          continue;
+        }
+      }
+      // tail of the run, where idle workers look for stragglers
+      if (finished())
+        return;
+      if (!hedge(func)) {
+        cpu_relax();
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  /**
+   * Return the chunk results, valid once all workers have returned.
+   */
+  auto& results() noexcept { return results_; }
+
+  /**
+   * Return the run statistics, valid once all workers have returned.
+   */
+  auto stats() const noexcept
+  {
+    hedge_stats stats;
+    stats.n_chunks = costs_.size();
+    stats.n_hedges = n_hedges_.load(std::memory_order_relaxed);
+    stats.n_wins = n_wins_.load(std::memory_order_relaxed);
+    return stats;
+  }
+
+private:
+  struct alignas(cache_line_size) chunk_state {
+    std::atomic<std::int64_t> start_ns{};
+    std::atomic<unsigned int> n_copies{};
+    std::atomic<unsigned int> n_running{};
+    std::atomic<bool> done{};
+  };
+
+  const std::vector<std::size_t>& costs_;
+  hedge_policy policy_;
+  std::unique_ptr<chunk_state[]> chunks_;
+  std::vector<R> results_;
+  alignas(cache_line_size) std::atomic<std::size_t> next_{};
+  alignas(cache_line_size) std::atomic<std::size_t> n_done_{};
+  std::atomic<bool> failed_{};
+  std::atomic<std::int64_t> done_ns_{};
+  std::atomic<std::uint64_t> done_cost_{};
+  std::atomic<std::size_t> n_hedges_{};
+  std::atomic<std::size_t> n_wins_{};
+
+  /**
+   * Return `true` if all chunks are finished or a copy has thrown.
+   */
+  bool finished() const noexcept
+  {
+    return n_done_.load(std::memory_order_acquire) == costs_.size() ||
+      failed_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Run a copy of a chunk and keep its result if it is the first to finish.
+   *
+   * The caller must have already counted the copy as running.
+   *
+   * @tparam F Callable with signature `R(std::size_t, const hedge_token&)`
+   *
+   * @param func Callable invoked with the chunk index and token
+   * @param i Chunk index
+   * @param copy Copy index
+   */
+  template <typename F>
+  void execute(F& func, std::size_t i, unsigned int copy)
+  {
+    auto& chunk = chunks_[i];
+    auto start = steady_ns();
+    R result;
+    try {
+      result = func(i, hedge_token{chunk.done, copy});
+    }
+    catch (...) {
+      failed_.store(true, std::memory_order_relaxed);
+      throw;
+    }
+    chunk.n_running.fetch_sub(1u, std::memory_order_relaxed);
+    // only the first copy to finish writes its result
+    if (chunk.done.exchange(true, std::memory_order_acq_rel))
+      return;
+    results_[i] = std::move(result);
+    done_ns_.fetch_add(steady_ns() - start, std::memory_order_relaxed);
+    done_cost_.fetch_add(costs_[i], std::memory_order_relaxed);
+    if (copy)
+      n_wins_.fetch_add(1u, std::memory_order_relaxed);
+    n_done_.fetch_add(1u, std::memory_order_release);
+  }
+
+  /**
+   * Start another copy of the most overdue straggler, if any.
+   *
+   * @tparam F Callable with signature `R(std::size_t, const hedge_token&)`
+   *
+   * @param func Callable invoked with the chunk index and token
+   * @returns `true` if a copy was run
+   */
+  template <typename F>
+  bool hedge(F& func)
+  {
+    if (policy_.max_copies < 2u)
+      return false;
+    auto done_cost = done_cost_.load(std::memory_order_relaxed);
+    if (!done_cost)
+      return false;
+    auto ns_per_cost =
+      static_cast<double>(done_ns_.load(std::memory_order_relaxed)) /
+      static_cast<double>(done_cost);
+    auto now = steady_ns();
+    // pick the chunk that has exceeded its expected duration by the most
+    auto target = costs_.size();
+    double max_overdue = policy_.slowdown;
+    for (std::size_t i = 0; i < costs_.size(); i++) {
+      auto& chunk = chunks_[i];
+      // skip chunks that are unclaimed, not yet started, or finished
+      auto n_running = chunk.n_running.load(std::memory_order_acquire);
+      if (
+        !n_running ||
+        n_running >= policy_.max_copies ||
+        chunk.done.load(std::memory_order_relaxed)
+      )
+        continue;
+      auto expected_ns = ns_per_cost * static_cast<double>(costs_[i]);
+      if (expected_ns <= 0.)
+        continue;
+      auto elapsed_ns = static_cast<double>(
+        now - chunk.start_ns.load(std::memory_order_relaxed)
+      );
+      if (elapsed_ns > max_overdue * expected_ns) {
+        target = i;
+        max_overdue = elapsed_ns / expected_ns;
+      }
+    }
+    if (target == costs_.size())
+      return false;
+    // another idle worker may have picked the same chunk first
+    auto& chunk = chunks_[target];
+    auto n_running = chunk.n_running.load(std::memory_order_relaxed);
+    do {
+      if (!n_running || n_running >= policy_.max_copies)
+        return false;
+    }
+    while (
+      !chunk.n_running.compare_exchange_weak(
+        n_running, n_running + 1u, std::memory_order_relaxed
+      )
+    );
+    // measure overdue time from this copy so that with more than two copies
+    // the next one is only started once this one is overdue too
+    chunk.start_ns.store(steady_ns(), std::memory_order_relaxed);
+    auto copy = chunk.n_copies.fetch_add(1u, std::memory_order_relaxed);
+    n_hedges_.fetch_add(1u, std::memory_order_relaxed);
+    // each copy reruns the chunk from its start, so copies agree exactly
+    execute(func, target, copy);
+    return true;
+  }
+};
+
+}  // namespace detail
+
+/**
+ * Run chunks on a worker pool, hedging stragglers at the end of the run.
+ *
+ * Workers claim chunks dynamically. Once no unclaimed chunks are left, idle
+ * workers rerun chunks that are running slower than expected, e.g. because
+ * their worker was preempted or throttled, and the first copy to finish wins.
+ * Since each copy reruns the chunk from its start, `func` must be a pure
+ * function of the chunk index, e.g. by seeding a fresh PRNG per chunk, for
+ * the results not to depend on which copy wins.
+ *
+ * A copy that loses is only abandoned once it notices that its token was
+ * cancelled, so `func` should poll the token so that it can return early.
+ *
+ * @tparam R Chunk result type, must be default constructible
+ * @tparam F Callable with signature `R(std::size_t, const hedge_token&)`
+ *
+ * @param pool Worker pool to run chunks on
+ * @param costs Per-chunk costs, e.g. sample counts, used to estimate how long
+ *  each chunk should take
+ * @param func Callable invoked with the chunk index and token
+ * @param policy Hedging policy
+ * @param stats Address to write run statistics to, ignored if `nullptr`
+ * @returns Vector of chunk results
+ */
+template <typename R, typename F>
+std::vector<R> run_hedged(
+  worker_pool& pool,
+  const std::vector<std::size_t>& costs,
+  F&& func,
+  const hedge_policy& policy = {},
+  hedge_stats* stats = nullptr)
+{
+  detail::hedged_run<R> run{costs, policy};
+  pool.run([&run, &func](unsigned int) { run.work(func); });
+  if (stats)
+    *stats = run.stats();
+  return std::move(run.results());
+}
+
+}  // namespace pdmpmt
+
+#endif  // PDMPMT_HEDGING_HH_
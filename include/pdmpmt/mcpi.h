@@ -45,6 +45,45 @@ pdmpmt_rng_unit_circle_samples(
   pdmpmt_rng_type rng_type,
   unsigned seed) PDMPMT_NOEXCEPT;
 
+/**
+ * Draw and count samples in [-1, 1] x [-1, 1] that fall in the unit circle.
+ *
+ * Uses coarse-then-fine classification: each point draws a coarse cell index
+ * classified as inside, outside, or on the boundary of the circle through a
+ * precomputed table, and only boundary cells draw extra bits to refine. The
+ * distribution is exactly uniform over a lattice of 2^31 points per axis while
+ * drawing about 4x (MT19937) or 3x (MRG32k3a) fewer random bits than
+ * `pdmpmt_rng_unit_circle_samples`.
+ *
+ * @param n_samples Number of samples to draw
+ * @param rng_type PRNG type
+ * @param seed Seed value for the PRNG
+ * @param n_bits Address to write number of random bits drawn to, can be `NULL`
+ */
+PDMPMT_PUBLIC
+size_t
+pdmpmt_rng_unit_circle_samples_cf(
+  size_t n_samples,
+  pdmpmt_rng_type rng_type,
+  unsigned seed,
+  size_t *n_bits) PDMPMT_NOEXCEPT;
+
+/**
+ * Return the cell classification tables of `pdmpmt_rng_unit_circle_samples_cf`.
+ *
+ * Row `a` of the quadrant has cells `b < inner[a]` entirely inside the unit
+ * circle and cells `b >= outer[a]` entirely outside. The tables are the same
+ * as the `detail::mcpi_cells` tables used by the C++ `mcpi_cf`.
+ *
+ * @param inner Address to write the inner row limits to
+ * @param outer Address to write the outer row limits to
+ * @returns Number of rows of each table
+ */
+PDMPMT_PUBLIC unsigned int
+pdmpmt_mcpi_cell_tables(
+  const uint16_t **inner,
+  const uint16_t **outer) PDMPMT_NOEXCEPT;
+
 /**
  * Draw and count number of samples in [-1, 1] x [-1, 1] are in unit circle.
  *
@@ -135,6 +174,29 @@ PDMPMT_MSVC_WARNING_DISABLE(4244 5219)
 PDMPMT_MSVC_WARNING_POP()
 }
 
+/**
+ * Estimate pi using Monte Carlo with coarse-then-fine classification.
+ *
+ * @param n_samples Number of samples to use
+ * @param rng_type PRNG type
+ * @param seed Seed value for the PRNG
+ */
+PDMPMT_INLINE double
+pdmpmt_rng_smcpi_cf(
+  size_t n_samples,
+  pdmpmt_rng_type rng_type,
+  unsigned long seed) PDMPMT_NOEXCEPT
+{
+// MSVC complains that size_t to double may lose data
+PDMPMT_MSVC_WARNING_PUSH()
+PDMPMT_MSVC_WARNING_DISABLE(4244 5219)
+  double uctd = pdmpmt_rng_unit_circle_samples_cf(
+    n_samples, rng_type, seed, NULL
+  );
+  return 4 * uctd / n_samples;
+PDMPMT_MSVC_WARNING_POP()
+}
+
 /**
  * Estimate pi using Monte Carlo.
  *
@@ -320,6 +382,114 @@ pdmpmt_mt32_mcpi_omp(size_t n_samples) PDMPMT_NOEXCEPT
 }
 #endif  // _OPENMP
 
+/**
+ * Layout of a run of the `pdmpmt_rng_*` pi estimators.
+ *
+ * A run is identified by its PRNG type, seed, sample count, and number of
+ * jobs. Samples are indexed globally in job order, i.e. all the samples of job
+ * 0 come first, then those of job 1, etc., with each job assigned the sample
+ * count given by `pdmpmt_generate_sample_counts`.
+ *
+ * If `n_jobs` is `PDMPMT_MCPI_SERIAL_RUN`, i.e. 0, the run is the single
+ * stream of `pdmpmt_rng_smcpi`. Otherwise the run is that of
+ * `pdmpmt_rng_smcpi_ompm` with `n_jobs` threads, where each job is seeded from
+ * `pdmpmt_rng_generate_seeds`. The estimators take `unsigned` seeds, so the
+ * seed is truncated to `unsigned` and seeds that agree after truncation give
+ * the same run, including the same `pdmpmt_mcpi_run_id`.
+ */
+typedef struct {
+  pdmpmt_rng_type rng_type;  // PRNG type
+  unsigned long seed;        // seed value passed to the estimator
+  size_t n_samples;          // total number of samples
+  unsigned int n_jobs;       // number of jobs or PDMPMT_MCPI_SERIAL_RUN
+} pdmpmt_mcpi_run;
+
+// macro to indicate a run is that of the serial estimator
+#define PDMPMT_MCPI_SERIAL_RUN 0u
+
+/**
+ * Sample point of a run.
+ */
+typedef struct {
+  double x;    // x coordinate in [-1, 1]
+  double y;    // y coordinate in [-1, 1]
+  int inside;  // nonzero if the point is in the unit circle
+} pdmpmt_mcpi_point;
+
+/**
+ * Return the job a sample belongs to and the sample's offset within the job.
+ *
+ * @param run Run layout
+ * @param index Global sample index
+ * @param job Address to write the job index to
+ * @param offset Address to write the offset of the sample within the job to
+ * @returns 0 on success, -1 if `index` is out of range
+ */
+PDMPMT_PUBLIC int
+pdmpmt_mcpi_locate(
+  const pdmpmt_mcpi_run *run,
+  size_t index,
+  unsigned int *job,
+  size_t *offset) PDMPMT_NOEXCEPT;
+
+/**
+ * Return the range of global sample indices belonging to a job.
+ *
+ * @param run Run layout
+ * @param job Job index, must be 0 for a serial run
+ * @param first Address to write the global index of the job's first sample to
+ * @param n Address to write the job's sample count to
+ * @returns 0 on success, -1 if `job` is out of range
+ */
+PDMPMT_PUBLIC int
+pdmpmt_mcpi_job_range(
+  const pdmpmt_mcpi_run *run,
+  unsigned int job,
+  size_t *first,
+  size_t *n) PDMPMT_NOEXCEPT;
+
+/**
+ * Recompute a single sample point of a run.
+ *
+ * The job seed and the sample's position in the job's stream are reached
+ * with the PRNG jump-ahead, so the cost is O(log index) instead of replaying
+ * the run up to the sample. Each MT19937 jump is a product of polynomials
+ * over GF(2) of degree 19937, so it is far more expensive than an MRG32k3a
+ * jump, which is a product of 3 x 3 matrices.
+ *
+ * @param run Run layout
+ * @param index Global sample index
+ * @param point Address to write the sample point to
+ * @returns 0 on success, -1 if `index` is out of range
+ */
+PDMPMT_PUBLIC int
+pdmpmt_mcpi_sample_at(
+  const pdmpmt_mcpi_run *run,
+  size_t index,
+  pdmpmt_mcpi_point *point) PDMPMT_NOEXCEPT;
+
+/**
+ * Recompute the number of samples of a range that fall in the unit circle.
+ *
+ * The range may span several jobs. Each job piece starts with a jump-ahead,
+ * and if OpenMP is available, the range is split into one piece per thread,
+ * so any chunk of a run, e.g. a job whose reported count is suspicious, can
+ * be verified independently of the rest of the run.
+ *
+ * @param run Run layout
+ * @param first Global index of the first sample
+ * @param n Number of samples
+ * @param n_inside Address to write the number of samples in the circle to
+ * @returns 0 on success, -1 if the range is out of range or if memory
+ *  allocation for the PRNG fails
+ */
+PDMPMT_PUBLIC int
+pdmpmt_mcpi_count_range(
+  const pdmpmt_mcpi_run *run,
+  size_t first,
+  size_t n,
+  size_t *n_inside) PDMPMT_NOEXCEPT;
+
 PDMPMT_EXTERN_C_END
 
 #endif  // PDMPMT_MCPI_H_
@@ -9,6 +9,7 @@
 #define PDMPMT_MCPI_HH_
 
 #include <algorithm>
+#include <array>
 #include <cassert>
 #include <cstdint>
 #include <future>
@@ -30,6 +31,7 @@
 #include <thrust/random/uniform_real_distribution.h>
 #endif  // __CUDACC__
 
+#include "pdmpmt/type_traits.hh"
 #include "pdmpmt/warnings.h"
 
 namespace pdmpmt {
@@ -73,7 +75,8 @@ using entropy_source_t = std::enable_if_t<is_entropy_source<T>::value>;
 /**
  * Return number of samples in [-1, 1] x [-1, 1] that fall in the unit circle.
  *
- * We make a copy of the PRNG instance, otherwise its state will be changed.
+ * The PRNG state is advanced, so consecutive calls continue the same stream,
+ * e.g. to process a job in pieces.
  *
  * @tparam Rng *UniformRandomBitGenerator* or other entropy source
  *
@@ -82,7 +85,7 @@ using entropy_source_t = std::enable_if_t<is_entropy_source<T>::value>;
  */
 template <typename Rng, typename = entropy_source_t<Rng>>
 PDMPMT_XPU_FUNC
-auto unit_circle_samples(std::size_t n_samples, Rng rng)
+auto unit_circle_samples_advance(std::size_t n_samples, Rng& rng)
 {
 #if defined(__CUDACC__)
   thrust::random::uniform_real_distribution udist{-1., 1.};
@@ -103,6 +106,23 @@ auto unit_circle_samples(std::size_t n_samples, Rng rng)
   return n_inside;
 }
 
+/**
+ * Return number of samples in [-1, 1] x [-1, 1] that fall in the unit circle.
+ *
+ * We make a copy of the PRNG instance, otherwise its state will be changed.
+ *
+ * @tparam Rng *UniformRandomBitGenerator* or other entropy source
+ *
+ * @param n_samples Number of samples to use
+ * @param rng PRNG instance
+ */
+template <typename Rng, typename = entropy_source_t<Rng>>
+PDMPMT_XPU_FUNC
+auto unit_circle_samples(std::size_t n_samples, Rng rng)
+{
+  return unit_circle_samples_advance(n_samples, rng);
+}
+
 /**
  * Return number of samples in [-1, 1] x [-1, 1] that fall in the unit circle.
  *
@@ -123,6 +143,223 @@ inline auto unit_circle_samples(std::size_t n_samples, std::uint_fast64_t seed)
 #endif  // !defined(__CUDACC__)
 }
 
+/**
+ * Number of coarse bits per coordinate used for the cell index.
+ */
+inline constexpr unsigned mcpi_coarse_bits = 8u;
+
+/**
+ * Number of fine bits per coordinate used to refine boundary cells.
+ *
+ * With 8 + 22 bits the exact integer lattice test fits in 63 bits.
+ */
+inline constexpr unsigned mcpi_fine_bits = 22u;
+
+/**
+ * Number of cells along each axis of the [0, 1] x [0, 1] quadrant.
+ */
+inline constexpr unsigned mcpi_n_cells = 1u << mcpi_coarse_bits;
+
+/**
+ * Return the integer square root, i.e. the floor of the square root.
+ *
+ * @param n Value to take square root of
+ */
+constexpr std::uint_fast32_t isqrt(std::uint_fast32_t n) noexcept
+{
+  // binary search since std::sqrt is not constexpr
+  std::uint_fast32_t lo = 0;
+  std::uint_fast32_t hi = n / 2 + 1;
+  while (lo < hi) {
+    auto mid = lo + (hi - lo + 1) / 2;
+    if (mid * mid <= n)
+      lo = mid;
+    else
+      hi = mid - 1;
+  }
+  return lo;
+}
+
+/**
+ * Per-row limits classifying quadrant cells against the unit circle.
+ *
+ * Cell (a, b) covers [a, a + 1] x [b, b + 1] in units of `1 / mcpi_n_cells`.
+ * Cells with `b < inner[a]` are entirely inside the circle, cells with
+ * `b >= outer[a]` are entirely outside, and the rest straddle the boundary.
+ */
+struct mcpi_cell_table {
+  std::array<std::uint_least16_t, mcpi_n_cells> inner;
+  std::array<std::uint_least16_t, mcpi_n_cells> outer;
+};
+
+/**
+ * Compute the cell classification table at compile time.
+ */
+constexpr auto make_mcpi_cell_table() noexcept
+{
+  constexpr std::uint_fast32_t r2 = mcpi_n_cells * mcpi_n_cells;
+  mcpi_cell_table table{};
+  for (std::uint_fast32_t a = 0; a < mcpi_n_cells; a++) {
+    // inside if the far corner is in the circle, outside if the near one isn't
+    table.inner[a] = static_cast<std::uint_least16_t>(
+      isqrt(r2 - (a + 1) * (a + 1))
+    );
+    table.outer[a] = static_cast<std::uint_least16_t>(
+      isqrt(r2 - a * a - 1) + 1
+    );
+  }
+  return table;
+}
+
+/**
+ * Cell classification table used by `unit_circle_samples_cf`.
+ */
+inline constexpr auto mcpi_cells = make_mcpi_cell_table();
+
+/**
+ * Buffered source of uniform random bits.
+ *
+ * The PRNG must output uniform words of `word_bits` bits, i.e. its range must
+ * be [0, 2^w - 1]. Other generators can be adapted with
+ * `std::independent_bits_engine`.
+ *
+ * @tparam Rng *UniformRandomBitGenerator*
+ */
+template <typename Rng>
+class random_bit_stream {
+public:
+  static_assert(Rng::min() == 0, "Rng::min() must be 0");
+  static_assert(
+    (Rng::max() & (Rng::max() + 1u)) == 0u, "Rng::max() must be 2^w - 1"
+  );
+
+  /**
+   * Number of uniform bits output per PRNG invocation.
+   */
+  static constexpr unsigned word_bits = []
+  {
+    unsigned n = 0;
+    for (auto m = Rng::max(); m; m >>= 1)
+      n++;
+    return n;
+  }();
+
+  static_assert(word_bits <= 64, "Rng words must be at most 64 bits wide");
+
+  /**
+   * Ctor.
+   *
+   * @param rng PRNG providing the bits
+   */
+  random_bit_stream(Rng& rng) noexcept : rng_{rng} {}
+
+  /**
+   * Take the next `n` uniform bits.
+   *
+   * @param n Number of bits to take, at most 32
+   */
+  std::uint_fast64_t operator()(unsigned n)
+  {
+    assert(n <= 32u);
+    std::uint_fast64_t value = 0;
+    unsigned got = 0;
+    while (got < n) {
+      if (!n_buf_) {
+        buf_ = static_cast<std::uint_fast64_t>(rng_());
+        n_buf_ = word_bits;
+        n_drawn_ += word_bits;
+      }
+      auto k = std::min(n - got, n_buf_);
+      value |= (buf_ & ((std::uint_fast64_t{1} << k) - 1u)) << got;
+      buf_ >>= k;
+      n_buf_ -= k;
+      got += k;
+    }
+    return value;
+  }
+
+  /**
+   * Return the total number of bits drawn from the PRNG.
+   */
+  auto drawn() const noexcept { return n_drawn_; }
+
+private:
+  Rng& rng_;
+  std::uint_fast64_t buf_{};
+  unsigned n_buf_{};
+  std::size_t n_drawn_{};
+};
+
+/**
+ * Return number of samples in [-1, 1] x [-1, 1] that fall in the unit circle.
+ *
+ * Uses coarse-then-fine classification. By symmetry only |x|, |y| matter, so
+ * each point draws a quadrant cell index from `mcpi_coarse_bits` bits per
+ * coordinate, classified through `mcpi_cells`. Only boundary cells draw
+ * `mcpi_fine_bits` more bits per coordinate for an exact integer test, so the
+ * distribution is exactly uniform over the lattice of cell midpoints while
+ * drawing ~16.3 instead of 128 bits per sample with `std::mt19937_64`.
+ *
+ * We make a copy of the PRNG instance, otherwise its state will be changed.
+ *
+ * @tparam Rng *UniformRandomBitGenerator* with range [0, 2^w - 1]
+ *
+ * @param n_samples Number of samples to use
+ * @param rng PRNG instance
+ * @param n_bits Address to write number of random bits drawn to, can be null
+ */
+template <typename Rng, typename = uniform_random_bit_generator_t<Rng>>
+auto unit_circle_samples_cf(
+  std::size_t n_samples, Rng rng, std::size_t* n_bits = nullptr)
+{
+  // number of points classified per batch
+  constexpr std::size_t batch_size = 256u;
+  // squared radius in units of half a lattice spacing
+  constexpr auto r2 = std::uint_fast64_t{1} <<
+    (2u * (mcpi_coarse_bits + mcpi_fine_bits + 1u));
+  random_bit_stream<Rng> bits{rng};
+  // cell indices and classes for the current batch
+  std::array<std::uint8_t, batch_size> ca, cb, cls;
+  std::size_t n_inside = 0;
+  for (std::size_t i = 0; i < n_samples; i += batch_size) {
+    auto n_batch = std::min(batch_size, n_samples - i);
+    // coarse cell indices, both coordinates from one 16-bit draw
+    for (std::size_t j = 0; j < n_batch; j++) {
+      auto w = bits(2u * mcpi_coarse_bits);
+      ca[j] = static_cast<std::uint8_t>(w & (mcpi_n_cells - 1u));
+      cb[j] = static_cast<std::uint8_t>(w >> mcpi_coarse_bits);
+    }
+    // branch-free table lookup, 3 if inside, 2 if boundary, 0 if outside.
+    // this loop has no dependencies between iterations and is vectorizable
+    std::size_t n_batch_inside = 0;
+    for (std::size_t j = 0; j < n_batch; j++) {
+      cls[j] = static_cast<std::uint8_t>(
+        (cb[j] < mcpi_cells.inner[ca[j]]) |
+        ((cb[j] < mcpi_cells.outer[ca[j]]) << 1)
+      );
+      n_batch_inside += (cls[j] == 3u);
+    }
+    n_inside += n_batch_inside;
+    // refine boundary cells with the exact lattice test
+    for (std::size_t j = 0; j < n_batch; j++) {
+      if (cls[j] != 2u)
+        continue;
+      std::uint_fast64_t x = (std::uint_fast64_t{ca[j]} << mcpi_fine_bits) |
+        bits(mcpi_fine_bits);
+      std::uint_fast64_t y = (std::uint_fast64_t{cb[j]} << mcpi_fine_bits) |
+        bits(mcpi_fine_bits);
+      // midpoint of the fine lattice cell, in units of half a spacing
+      x = 2u * x + 1u;
+      y = 2u * y + 1u;
+      if (x * x + y * y <= r2)
+        n_inside++;
+    }
+  }
+  if (n_bits)
+    *n_bits = bits.drawn();
+  return n_inside;
+}
+
 /**
  * Return a vector of seed values for a specified PRNG instance's type.
  *
@@ -282,6 +519,40 @@ inline double mcpi(std::size_t n_samples)
   return mcpi(n_samples, std::random_device{}());
 }
 
+/**
+ * Estimate pi using Monte Carlo with coarse-then-fine classification.
+ *
+ * @tparam T Return type
+ * @tparam Rng *UniformRandomBitGenerator* with range [0, 2^w - 1]
+ *
+ * @param n_samples Number of samples to use
+ * @param rng PRNG instance
+ */
+template <
+  typename T, typename Rng, typename = uniform_random_bit_generator_t<Rng> >
+inline T mcpi_cf(std::size_t n_samples, const Rng& rng)
+{
+  // MSVC complains about size_t to double loss of data
+PDMPMT_MSVC_WARNING_PUSH()
+PDMPMT_MSVC_WARNING_DISABLE(4244 5219)
+  auto uctd = static_cast<T>(detail::unit_circle_samples_cf(n_samples, rng));
+  return 4 * (uctd / n_samples);
+PDMPMT_MSVC_WARNING_POP()
+}
+
+/**
+ * Estimate pi using Monte Carlo with coarse-then-fine classification.
+ *
+ * Uses the 64-bit Mersenne Twister implemented through `std::mt19937_64`.
+ *
+ * @param n_samples Number of samples to use
+ * @param seed Seed for the 64-bit Mersenne Twister
+ */
+inline double mcpi_cf(std::size_t n_samples, std::uint_fast64_t seed)
+{
+  return mcpi_cf<double>(n_samples, std::mt19937_64{seed});
+}
+
 /**
  * Parallel estimation of pi through Monte Carlo by launching async jobs.
  *
@@ -0,0 +1,84 @@
+/**
+ * @file mcpi_ci.h
+ * @author Derek Huang
+ * @brief C header for confidence intervals of chunked pi estimates
+ * @copyright MIT License
+ */
+
+#ifndef PDMPMT_MCPI_CI_H_
+#define PDMPMT_MCPI_CI_H_
+
+#include <stdint.h>
+
+#include "pdmpmt/block.h"
+#include "pdmpmt/common.h"
+#include "pdmpmt/dllexport.h"
+
+PDMPMT_EXTERN_C_BEGIN
+
+/**
+ * Confidence interval for pi estimated from per-chunk counts.
+ */
+typedef struct {
+  double estimate;   // pi estimate using all the chunks
+  double std_error;  // standard error of the estimate
+  double lower;      // lower confidence bound
+  double upper;      // upper confidence bound
+} pdmpmt_mcpi_ci;
+
+/**
+ * Compute a percentile bootstrap confidence interval from per-chunk counts.
+ *
+ * The chunks are resampled with the Poisson bootstrap, i.e. each chunk gets
+ * an independent Poisson(1) weight per resample. Chunks with equal circle and
+ * sample counts are grouped first, so a resample draws one Poisson variate
+ * per distinct pair of counts instead of one per chunk. Resamples are drawn
+ * in parallel if OpenMP is available and each one uses its own PRNG stream,
+ * so results do not depend on the thread count.
+ *
+ * @param circle_counts Block with per-chunk counts of samples in unit circle
+ * @param sample_counts Block with per-chunk total sample counts
+ * @param n_resamples Number of bootstrap resamples, must be positive
+ * @param level Confidence level in (0, 1), e.g. 0.95
+ * @param seed Seed value for the resampling PRNG
+ * @param ci Address to write the confidence interval to
+ * @returns 0 on success, -1 on memory allocation failure
+ */
+PDMPMT_PUBLIC int
+pdmpmt_mcpi_bootstrap_ci(
+  pdmpmt_block_ulong circle_counts,
+  pdmpmt_block_ulong sample_counts,
+  unsigned int n_resamples,
+  double level,
+  uint64_t seed,
+  pdmpmt_mcpi_ci *ci) PDMPMT_NOEXCEPT;
+
+/**
+ * Compute a batch means confidence interval from per-chunk counts.
+ *
+ * Consecutive chunks are grouped into batches with as equal a number of
+ * chunks as possible. The standard error is estimated from the spread of the
+ * batch estimates around the overall estimate, weighting each batch by its
+ * sample count, and the interval uses Student's t with `n_batches - 1`
+ * degrees of freedom. Batches are computed in parallel if OpenMP is available
+ * and their terms summed in a fixed order, so results do not depend on the
+ * thread count.
+ *
+ * @param circle_counts Block with per-chunk counts of samples in unit circle
+ * @param sample_counts Block with per-chunk total sample counts
+ * @param n_batches Number of batches, at least 2 and at most the chunk count
+ * @param level Confidence level in (0, 1), e.g. 0.95
+ * @param ci Address to write the confidence interval to
+ * @returns 0 on success, -1 on memory allocation failure
+ */
+PDMPMT_PUBLIC int
+pdmpmt_mcpi_batch_means_ci(
+  pdmpmt_block_ulong circle_counts,
+  pdmpmt_block_ulong sample_counts,
+  unsigned int n_batches,
+  double level,
+  pdmpmt_mcpi_ci *ci) PDMPMT_NOEXCEPT;
+
+PDMPMT_EXTERN_C_END
+
+#endif  // PDMPMT_MCPI_CI_H_
@@ -0,0 +1,257 @@
+/**
+ * @file mcpi_merge.hh
+ * @author Derek Huang
+ * @brief C++ header for merging streams of partial pi count records
+ * @copyright MIT License
+ */
+
+#ifndef PDMPMT_MCPI_MERGE_HH_
+#define PDMPMT_MCPI_MERGE_HH_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "pdmpmt/mcpi.h"
+#include "pdmpmt/mcpi_record.h"
+
+namespace pdmpmt {
+
+/**
+ * Incremental decoder for a stream of records.
+ *
+ * Bytes may be fed in arbitrary pieces, e.g. as they are read from a pipe,
+ * with any incomplete trailing record kept until the rest of it arrives.
+ */
+class mcpi_record_reader {
+public:
+  /**
+   * Decode all whole records from the buffered bytes and the given bytes.
+   *
+   * @tparam F Callable with signature `void(const pdmpmt_mcpi_record&)`
+   *
+   * @param data Bytes to append to the stream
+   * @param size Number of bytes
+   * @param func Callable invoked on each decoded record
+   * @returns `true` on success, `false` if the stream is malformed
+   */
+  template <typename F>
+  bool feed(const unsigned char* data, std::size_t size, F&& func)
+  {
+    // decode in place if nothing is buffered, the usual case for mmap
+    if (pending_.empty())
+      return consume(data, size, func);
+    pending_.insert(pending_.end(), data, data + size);
+    std::vector<unsigned char> bytes;
+    bytes.swap(pending_);
+    return consume(bytes.data(), bytes.size(), func);
+  }
+
+  /**
+   * Return the number of bytes of an incomplete trailing record.
+   *
+   * If nonzero once the stream has ended, the stream was truncated.
+   */
+  auto n_pending() const noexcept { return pending_.size(); }
+
+private:
+  std::vector<unsigned char> pending_;
+
+  /**
+   * Decode whole records and buffer any incomplete trailing record.
+   *
+   * @tparam F Callable with signature `void(const pdmpmt_mcpi_record&)`
+   *
+   * @param data Bytes to decode
+   * @param size Number of bytes
+   * @param func Callable invoked on each decoded record
+   * @returns `true` on success, `false` if the stream is malformed
+   */
+  template <typename F>
+  bool consume(const unsigned char* data, std::size_t size, F& func)
+  {
+    pdmpmt_mcpi_record rec;
+    std::size_t n_read;
+    while (true) {
+      auto status = pdmpmt_mcpi_record_decode(data, size, &rec, &n_read);
+      if (status < 0)
+        return false;
+      if (!status)
+        break;
+      func(rec);
+      data += n_read;
+      size -= n_read;
+    }
+    pending_.assign(data, data + size);
+    return true;
+  }
+};
+
+/**
+ * Merger of partial results into a pi estimate.
+ *
+ * Records are grouped by run and the sample ranges accepted for each run are
+ * kept in an ordered map. A record whose range is already covered by accepted
+ * ranges of its run, e.g. from a rerun or a hedged copy of a chunk, is
+ * dropped. A record that only partially overlaps accepted ranges, e.g. from
+ * ranges split with different chunk sizes, cannot be split by its counts, so
+ * if its run layout was given with `add_run`, only its uncovered parts are
+ * merged after recounting them with `pdmpmt_mcpi_count_range`. Otherwise it
+ * is dropped as a conflict. Each record costs O(log r + k) for r accepted
+ * ranges of its run and k ranges overlapping it, plus any recounting.
+ */
+class mcpi_merger {
+public:
+  /**
+   * Register a run layout so partially overlapping records can be clipped.
+   *
+   * @param run Run layout
+   */
+  void add_run(const pdmpmt_mcpi_run& run)
+  {
+    layouts_[pdmpmt_mcpi_run_id(&run)] = run;
+  }
+
+  /**
+   * Add a record.
+   *
+   * @param rec Record to add
+   * @returns `true` if all or part of it was accepted, `false` if it was
+   *  empty, already covered, or a conflict
+   */
+  bool add(const pdmpmt_mcpi_record& rec)
+  {
+    n_records_++;
+    if (!rec.n_samples || rec.first + rec.n_samples < rec.first) {
+      n_dropped_++;
+      return false;
+    }
+    auto& ranges = runs_[rec.run_id];
+    auto last = rec.first + rec.n_samples;
+    // first accepted range that may overlap this one
+    auto it = ranges.upper_bound(rec.first);
+    if (it != ranges.begin() && std::prev(it)->second > rec.first)
+      it--;
+    // no overlap, so the record is accepted whole
+    if (it == ranges.end() || it->first >= last) {
+      ranges.emplace_hint(it, rec.first, last);
+      n_samples_ += rec.n_samples;
+      n_inside_ += rec.n_inside;
+      return true;
+    }
+    // collect the uncovered gaps of the record
+    std::vector<std::pair<std::uint64_t, std::uint64_t>> gaps;
+    for (auto pos = rec.first; pos < last; it++) {
+      auto next = (it == ranges.end()) ? last : std::min(it->first, last);
+      if (pos < next)
+        gaps.emplace_back(pos, next);
+      if (it == ranges.end())
+        break;
+      pos = std::max(pos, it->second);
+    }
+    if (gaps.empty()) {
+      n_dropped_++;
+      return false;
+    }
+    // partial overlap, where the gaps must be recounted from the run layout
+    auto layout = layouts_.find(rec.run_id);
+    if (layout == layouts_.end()) {
+      n_dropped_++;
+      n_conflicts_++;
+      return false;
+    }
+    std::vector<std::size_t> gap_counts(gaps.size());
+    for (std::size_t i = 0; i < gaps.size(); i++) {
+      if (
+        pdmpmt_mcpi_count_range(
+          &layout->second,
+          gaps[i].first,
+          gaps[i].second - gaps[i].first,
+          &gap_counts[i]
+        )
+      ) {
+        n_dropped_++;
+        n_conflicts_++;
+        return false;
+      }
+    }
+    for (std::size_t i = 0; i < gaps.size(); i++) {
+      ranges.emplace(gaps[i].first, gaps[i].second);
+      n_samples_ += gaps[i].second - gaps[i].first;
+      n_inside_ += gap_counts[i];
+    }
+    n_clipped_++;
+    return true;
+  }
+
+  /**
+   * Return the number of records added, including dropped ones.
+   */
+  auto n_records() const noexcept { return n_records_; }
+
+  /**
+   * Return the number of records dropped as empty, covered, or conflicts.
+   */
+  auto n_dropped() const noexcept { return n_dropped_; }
+
+  /**
+   * Return the number of dropped records that only partially overlapped.
+   *
+   * These records had samples not covered by any accepted range, so the
+   * estimate is missing samples unless other records cover them.
+   */
+  auto n_conflicts() const noexcept { return n_conflicts_; }
+
+  /**
+   * Return the number of records clipped to their uncovered parts.
+   */
+  auto n_clipped() const noexcept { return n_clipped_; }
+
+  /**
+   * Return the number of distinct runs seen.
+   */
+  auto n_runs() const noexcept { return runs_.size(); }
+
+  /**
+   * Return the number of samples of the accepted records.
+   */
+  auto n_samples() const noexcept { return n_samples_; }
+
+  /**
+   * Return the number of samples in the unit circle of the accepted records.
+   */
+  auto n_inside() const noexcept { return n_inside_; }
+
+  /**
+   * Return the merged estimate of pi, 0 if no records were accepted.
+   */
+  double estimate() const noexcept
+  {
+    if (!n_samples_)
+      return 0.;
+    return 4 * (static_cast<double>(n_inside_) / n_samples_);
+  }
+
+private:
+  // accepted ranges of each run, as map from first index to one past last
+  std::unordered_map<
+    std::uint64_t, std::map<std::uint64_t, std::uint64_t>
+  > runs_;
+  // registered run layouts by run identifier
+  std::unordered_map<std::uint64_t, pdmpmt_mcpi_run> layouts_;
+  std::size_t n_records_ = 0u;
+  std::size_t n_dropped_ = 0u;
+  std::size_t n_conflicts_ = 0u;
+  std::size_t n_clipped_ = 0u;
+  std::uint64_t n_samples_ = 0u;
+  std::uint64_t n_inside_ = 0u;
+};
+
+}  // namespace pdmpmt
+
+#endif  // PDMPMT_MCPI_MERGE_HH_
@@ -0,0 +1,160 @@
+/**
+ * @file mcpi_pool.hh
+ * @author Derek Huang
+ * @brief C++ header for estimating pi using Monte Carlo on worker pools
+ * @copyright MIT License
+ */
+
+#ifndef PDMPMT_MCPI_POOL_HH_
+#define PDMPMT_MCPI_POOL_HH_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+
+#include "pdmpmt/hedging.hh"
+#include "pdmpmt/mcpi.hh"
+#include "pdmpmt/worker_pool.hh"
+
+namespace pdmpmt {
+
+/**
+ * Parallel estimation of pi through Monte Carlo using a worker pool.
+ *
+ * Each worker of the pool, including the calling thread, runs one job. Unlike
+ * `mcpi_async`, no threads are created per call, so with a suitable waiting
+ * policy the pool adds little latency to short runs.
+ *
+ * @tparam T Return type
+ * @tparam Rng *UniformRandomBitGenerator* or other entropy source
+ *
+ * @param n_samples Number of samples to use
+ * @param rng PRNG instance
+ * @param pool Worker pool to split work over
+ */
+template <typename T, typename Rng>
+T mcpi_pool(std::size_t n_samples, const Rng& rng, worker_pool& pool)
+{
+  // generate seeds used by jobs for generating samples + the sample counts
+  auto seeds = detail::generate_seeds(pool.size(), rng);
+  auto sample_counts = detail::generate_sample_counts(n_samples, pool.size());
+  // each worker writes only its own circle count
+  decltype(sample_counts) circle_counts(pool.size());
+  pool.run(
+    [&](unsigned int i)
+    {
+      circle_counts[i] = detail::
+        unit_circle_samples(sample_counts[i], Rng{seeds[i]});
+    }
+  );
+  return detail::mcpi_gather<T>(circle_counts, sample_counts);
+}
+
+/**
+ * Parallel estimation of pi through Monte Carlo using a worker pool.
+ *
+ * Uses the 64-bit Mersenne Twister implemented through `std::mt19937_64`.
+ *
+ * @param n_samples Number of samples to use
+ * @param seed Seed for the 64-bit Mersenne Twister
+ * @param pool Worker pool to split work over
+ */
+inline double
+mcpi_pool(std::size_t n_samples, std::uint_fast64_t seed, worker_pool& pool)
+{
+  return mcpi_pool<double>(n_samples, std::mt19937_64{seed}, pool);
+}
+
+namespace detail {
+
+/**
+ * Number of samples a hedged chunk draws between cancellation checks.
+ */
+inline constexpr std::size_t mcpi_hedge_poll_interval = 1u << 16;
+
+}  // namespace detail
+
+/**
+ * Parallel estimation of pi through Monte Carlo with hedged chunks.
+ *
+ * The samples are split into chunks, each with its own seed, that the pool
+ * workers claim dynamically. Near the end of the run, idle workers rerun
+ * chunks that take longer than `policy.slowdown` times their expected
+ * duration and the first copy to finish wins, which cuts the long tail from
+ * preempted or throttled workers. Since a copy reruns its chunk from the
+ * chunk's seed, the estimate does not depend on which copies win.
+ *
+ * @tparam T Return type
+ * @tparam Rng *UniformRandomBitGenerator* or other entropy source
+ *
+ * @param n_samples Number of samples to use
+ * @param rng PRNG instance
+ * @param pool Worker pool to split work over
+ * @param n_chunks Number of chunks, usually several per worker
+ * @param policy Hedging policy
+ * @param stats Address to write run statistics to, ignored if `nullptr`
+ */
+template <typename T, typename Rng>
+T mcpi_hedged(
+  std::size_t n_samples,
+  const Rng& rng,
+  worker_pool& pool,
+  std::size_t n_chunks,
+  const hedge_policy& policy = {},
+  hedge_stats* stats = nullptr)
+{
+  // generate seeds used by chunks for generating samples + the sample counts
+  auto seeds = detail::generate_seeds(n_chunks, rng);
+  auto sample_counts = detail::generate_sample_counts(n_samples, n_chunks);
+  auto circle_counts = run_hedged<std::size_t>(
+    pool,
+    sample_counts,
+    [&](std::size_t i, const hedge_token& token)
+    {
+      constexpr auto poll_interval = detail::mcpi_hedge_poll_interval;
+      Rng gen{seeds[i]};
+      std::size_t n_inside = 0;
+      // draw in pieces so a losing copy stops soon after being cancelled
+      for (
+        std::size_t n_done = 0;
+        n_done < sample_counts[i] && !token.cancelled();
+        n_done += poll_interval
+      ) {
+        auto n = std::min(poll_interval, sample_counts[i] - n_done);
+        n_inside += detail::unit_circle_samples_advance(n, gen);
+      }
+      return n_inside;
+    },
+    policy,
+    stats
+  );
+  return detail::mcpi_gather<T>(circle_counts, sample_counts);
+}
+
+/**
+ * Parallel estimation of pi through Monte Carlo with hedged chunks.
+ *
+ * Uses the 64-bit Mersenne Twister implemented through `std::mt19937_64`.
+ *
+ * @param n_samples Number of samples to use
+ * @param seed Seed for the 64-bit Mersenne Twister
+ * @param pool Worker pool to split work over
+ * @param n_chunks Number of chunks, usually several per worker
+ * @param policy Hedging policy
+ */
+inline double mcpi_hedged(
+  std::size_t n_samples,
+  std::uint_fast64_t seed,
+  worker_pool& pool,
+  std::size_t n_chunks,
+  const hedge_policy& policy = {})
+{
+  return mcpi_hedged<double>(
+    n_samples, std::mt19937_64{seed}, pool, n_chunks, policy
+  );
+}
+
+}  // namespace pdmpmt
+
+#endif  // PDMPMT_MCPI_POOL_HH_
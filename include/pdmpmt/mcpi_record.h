@@ -0,0 +1,114 @@
+/**
+ * @file mcpi_record.h
+ * @author Derek Huang
+ * @brief C header for streaming binary records of partial pi counts
+ * @copyright MIT License
+ */
+
+#ifndef PDMPMT_MCPI_RECORD_H_
+#define PDMPMT_MCPI_RECORD_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "pdmpmt/common.h"
+#include "pdmpmt/dllexport.h"
+#include "pdmpmt/mcpi.h"
+
+PDMPMT_EXTERN_C_BEGIN
+
+/**
+ * Partial result of a run, i.e. the circle count of a range of its samples.
+ *
+ * On the wire a record is a 4-byte payload length followed by the payload,
+ * which holds the four fields below as 8-byte integers, all little-endian.
+ * Decoders skip payload bytes past the known fields so that fields can be
+ * appended without breaking existing readers.
+ */
+typedef struct {
+  uint64_t run_id;     // identifier of the run, see `pdmpmt_mcpi_run_id`
+  uint64_t first;      // global index of the first sample of the range
+  uint64_t n_samples;  // number of samples in the range
+  uint64_t n_inside;   // number of samples in the range in the unit circle
+} pdmpmt_mcpi_record;
+
+// size of the length prefix of a record
+#define PDMPMT_MCPI_RECORD_PREFIX_SIZE 4u
+// size of the payload written by this version
+#define PDMPMT_MCPI_RECORD_PAYLOAD_SIZE 32u
+// size of a record written by this version
+#define PDMPMT_MCPI_RECORD_SIZE \
+  (PDMPMT_MCPI_RECORD_PREFIX_SIZE + PDMPMT_MCPI_RECORD_PAYLOAD_SIZE)
+// largest payload accepted by decoders, larger lengths are malformed
+#define PDMPMT_MCPI_RECORD_MAX_PAYLOAD_SIZE 4096u
+
+/**
+ * Return an identifier for a run.
+ *
+ * The identifier is a hash of the run layout, so records from different runs
+ * written to the same stream can be told apart.
+ *
+ * @param run Run layout
+ */
+PDMPMT_PUBLIC uint64_t
+pdmpmt_mcpi_run_id(const pdmpmt_mcpi_run *run) PDMPMT_NOEXCEPT;
+
+/**
+ * Encode a record.
+ *
+ * @param rec Record to encode
+ * @param buf Buffer of at least `PDMPMT_MCPI_RECORD_SIZE` bytes to write to
+ */
+PDMPMT_PUBLIC void
+pdmpmt_mcpi_record_encode(
+  const pdmpmt_mcpi_record *rec,
+  unsigned char *buf) PDMPMT_NOEXCEPT;
+
+/**
+ * Decode a record from the start of a buffer.
+ *
+ * @param buf Buffer to decode from
+ * @param size Number of bytes in the buffer
+ * @param rec Address to write the decoded record to
+ * @param n_read Address to write the number of bytes consumed to
+ * @returns 1 if a record was decoded, 0 if the buffer does not hold a whole
+ *  record yet, -1 if the length prefix is malformed
+ */
+PDMPMT_PUBLIC int
+pdmpmt_mcpi_record_decode(
+  const unsigned char *buf,
+  size_t size,
+  pdmpmt_mcpi_record *rec,
+  size_t *n_read) PDMPMT_NOEXCEPT;
+
+/**
+ * Compute the circle counts of a range of a run and write them as records.
+ *
+ * The range is split into chunks aligned to multiples of `chunk_size` in
+ * global sample index, so processes that compute overlapping ranges with the
+ * same chunk size emit identical records for the chunks they share, which a
+ * merger can drop as duplicates. Overlapping ranges should therefore start
+ * and end on chunk boundaries or the ends of the run, since a record that only
+ * partially overlaps a merged one can only be merged by recounting its
+ * uncovered part from the run layout. Each record is written as soon as its
+ * chunk is counted, so a reader sees partial results early.
+ *
+ * @param run Run layout
+ * @param first Global index of the first sample
+ * @param n Number of samples
+ * @param chunk_size Chunk size, must be positive
+ * @param fd File descriptor to write records to
+ * @returns 0 on success, -1 if the range is out of range, counting fails, or
+ *  writing fails
+ */
+PDMPMT_PUBLIC int
+pdmpmt_mcpi_emit(
+  const pdmpmt_mcpi_run *run,
+  size_t first,
+  size_t n,
+  size_t chunk_size,
+  int fd) PDMPMT_NOEXCEPT;
+
+PDMPMT_EXTERN_C_END
+
+#endif  // PDMPMT_MCPI_RECORD_H_
@@ -0,0 +1,137 @@
+/**
+ * @file monitor.h
+ * @author Derek Huang
+ * @brief C header for publishing live run counters to shared memory
+ * @copyright MIT License
+ */
+
+#ifndef PDMPMT_MONITOR_H_
+#define PDMPMT_MONITOR_H_
+
+#include <stdint.h>
+
+#include "pdmpmt/common.h"
+#include "pdmpmt/dllexport.h"
+
+PDMPMT_EXTERN_C_BEGIN
+
+/**
+ * Live run monitor backed by a named shared memory segment.
+ *
+ * The segment holds one cache line per worker. Each worker is the only writer
+ * of its cache line, which is guarded by a sequence lock so readers in other
+ * processes, e.g. `pdmpmt-top`, always see consistent counters. Publishing
+ * only performs relaxed stores and compiler/release fences, i.e. no locked
+ * instructions and no system calls.
+ */
+typedef struct pdmpmt_monitor pdmpmt_monitor;
+
+/**
+ * Counters published by a single worker.
+ */
+typedef struct {
+  uint64_t n_target;  // number of samples assigned to the worker
+  uint64_t n_done;    // number of samples drawn so far
+  uint64_t n_inside;  // number of drawn samples in the unit circle
+} pdmpmt_monitor_counts;
+
+/**
+ * Create a new named shared memory segment with the given number of workers.
+ *
+ * On POSIX systems the name is used with `shm_open`, with a leading slash
+ * added if missing. On Windows a named file mapping in the session-local
+ * namespace is used. On POSIX systems existing segments with the same name are
+ * replaced, while on Windows creation fails if a process still has a mapping
+ * with the same name open.
+ *
+ * @param name Segment name
+ * @param n_workers Number of worker slots, must be positive
+ * @returns New monitor on success, `NULL` on error
+ */
+PDMPMT_PUBLIC pdmpmt_monitor *
+pdmpmt_monitor_create(const char *name, unsigned int n_workers) PDMPMT_NOEXCEPT;
+
+/**
+ * Attach read-only to an existing named shared memory segment.
+ *
+ * @param name Segment name
+ * @returns Read-only monitor on success, `NULL` on error or if the segment was
+ *  not created by `pdmpmt_monitor_create`
+ */
+PDMPMT_PUBLIC pdmpmt_monitor *
+pdmpmt_monitor_open(const char *name) PDMPMT_NOEXCEPT;
+
+/**
+ * Detach from the shared memory segment and free the monitor.
+ *
+ * If the monitor was created with `pdmpmt_monitor_create`, the segment name is
+ * also removed. If the monitor is installed, it is uninstalled first.
+ *
+ * @param mon Monitor to close, no-op if `NULL`
+ */
+PDMPMT_PUBLIC void
+pdmpmt_monitor_close(pdmpmt_monitor *mon) PDMPMT_NOEXCEPT;
+
+/**
+ * Return the number of worker slots in the monitor.
+ *
+ * @param mon Monitor
+ */
+PDMPMT_PUBLIC unsigned int
+pdmpmt_monitor_n_workers(const pdmpmt_monitor *mon) PDMPMT_NOEXCEPT;
+
+/**
+ * Publish the counters of a worker.
+ *
+ * Must only be called by the thread owning the worker slot. Out of range
+ * worker indices are ignored so callers need not check the slot count.
+ *
+ * @param mon Monitor created with `pdmpmt_monitor_create`
+ * @param worker Worker slot index
+ * @param counts Counters to publish
+ */
+PDMPMT_PUBLIC void
+pdmpmt_monitor_publish(
+  pdmpmt_monitor *mon,
+  unsigned int worker,
+  const pdmpmt_monitor_counts *counts) PDMPMT_NOEXCEPT;
+
+/**
+ * Read a consistent snapshot of the counters of a worker.
+ *
+ * Retries a bounded number of times while the worker is updating the slot.
+ * A slot that stays torn, e.g. because its writer died mid-update or was
+ * descheduled for a long time, is reported instead of spun on forever.
+ *
+ * @param mon Monitor
+ * @param worker Worker slot index, must be less than the slot count
+ * @param counts Address to write the counters to, unchanged on failure
+ * @returns 0 on success, -1 if the slot could not be read consistently
+ */
+PDMPMT_PUBLIC int
+pdmpmt_monitor_read(
+  const pdmpmt_monitor *mon,
+  unsigned int worker,
+  pdmpmt_monitor_counts *counts) PDMPMT_NOEXCEPT;
+
+/**
+ * Install a monitor that the `mcpi.h` estimators publish to.
+ *
+ * Each job of an estimator publishes to the slot matching its job index, with
+ * jobs beyond the slot count not being published. Serial estimators use slot
+ * 0. Install before starting estimators and not while they are running.
+ *
+ * @param mon Monitor created with `pdmpmt_monitor_create`, `NULL` to uninstall
+ */
+PDMPMT_PUBLIC void
+pdmpmt_monitor_install(pdmpmt_monitor *mon) PDMPMT_NOEXCEPT;
+
+/**
+ * Return the installed monitor or `NULL` if there is none.
+ */
+PDMPMT_PUBLIC pdmpmt_monitor *
+pdmpmt_monitor_installed(void) PDMPMT_NOEXCEPT;
+
+PDMPMT_EXTERN_C_END
+
+#endif  // PDMPMT_MONITOR_H_
@@ -0,0 +1,310 @@
+/**
+ * @file reduce.hh
+ * @author Derek Huang
+ * @brief C++ header for bitwise-reproducible floating-point reductions
+ * @copyright MIT License
+ */
+
+#ifndef PDMPMT_REDUCE_HH_
+#define PDMPMT_REDUCE_HH_
+
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif  // _OPENMP
+
+#include "pdmpmt/warnings.h"
+#include "pdmpmt/worker_pool.hh"
+
+namespace pdmpmt {
+
+/**
+ * Floating-point sum carried together with its accumulated rounding error.
+ *
+ * Values are added with Neumaier's variant of Kahan summation, so the error of
+ * a long sum does not grow with its length. Two compensated sums are added by
+ * an error-free transformation of their high parts, so compensated partial
+ * sums can themselves be combined in a reduction tree.
+ *
+ * @note The compensation relies on strict IEEE semantics, so do not compile
+ *  with value-unsafe options such as `-ffast-math` or `/fp:fast`.
+ *
+ * @tparam T Floating-point type
+ */
+template <typename T>
+class compensated {
+public:
+  static_assert(std::is_floating_point_v<T>, "T must be floating-point");
+
+  /**
+   * Ctor.
+   *
+   * @param value Initial value
+   */
+  constexpr compensated(T value = T{}) noexcept : sum_{value} {}
+
+  /**
+   * Add a value.
+   *
+   * @param value Value to add
+   */
+  compensated& operator+=(T value) noexcept
+  {
+    auto sum = sum_ + value;
+    // recover the low-order bits lost by the larger operand
+    if (std::abs(sum_) >= std::abs(value))
+      err_ += (sum_ - sum) + value;
+    else
+      err_ += (value - sum) + sum_;
+    sum_ = sum;
+    return *this;
+  }
+
+  /**
+   * Add another compensated sum.
+   *
+   * @param other Compensated sum to add
+   */
+  compensated& operator+=(const compensated& other) noexcept
+  {
+    *this += other.sum_;
+    err_ += other.err_;
+    return *this;
+  }
+
+  /**
+   * Return the sum of two compensated sums.
+   *
+   * @param a First compensated sum
+   * @param b Second compensated sum
+   */
+  friend compensated
+  operator+(compensated a, const compensated& b) noexcept
+  {
+    return a += b;
+  }
+
+  /**
+   * Return the uncompensated running sum.
+   */
+  constexpr T sum() const noexcept { return sum_; }
+
+  /**
+   * Return the accumulated rounding error.
+   */
+  constexpr T error() const noexcept { return err_; }
+
+  /**
+   * Return the compensated sum.
+   */
+  constexpr T value() const noexcept { return sum_ + err_; }
+
+private:
+  T sum_;
+  T err_{};
+};
+
+namespace detail {
+
+/**
+ * Number of independent accumulators of a pairwise sum leaf.
+ */
+inline constexpr std::size_t pairwise_lanes = 8u;
+static_assert(pairwise_lanes == 8u, "lanes are combined as a fixed tree of 8");
+
+/**
+ * Largest number of values of a pairwise sum leaf.
+ */
+inline constexpr std::size_t pairwise_block = 128u;
+
+}  // namespace detail
+
+/**
+ * Sum a range of values by pairwise summation.
+ *
+ * The range is halved recursively, at multiples of the lane count, down to
+ * leaves of at most `detail::pairwise_block` values, each of which is summed
+ * with `detail::pairwise_lanes` interleaved accumulators so the compiler can
+ * vectorize it. The error grows as O(log n) instead of O(n) for a sequential
+ * sum, at nearly the speed of one, and since the order of operations only
+ * depends on the length of the range, the result is reproducible.
+ *
+ * @tparam It *RandomAccessIterator* over floating-point values
+ *
+ * @param first Iterator to the first value
+ * @param last Iterator one past the last value
+ */
+template <typename It>
+typename std::iterator_traits<It>::value_type pairwise_sum(It first, It last)
+{
+  using value_type = typename std::iterator_traits<It>::value_type;
+  static_assert(
+    std::is_floating_point_v<value_type>, "values must be floating-point"
+  );
+  constexpr auto n_lanes = detail::pairwise_lanes;
+  auto n = static_cast<std::size_t>(std::distance(first, last));
+  if (n > detail::pairwise_block) {
+    auto n_half = n / 2 / n_lanes * n_lanes;
+    auto mid = std::next(first, static_cast<std::ptrdiff_t>(n_half));
+    return pairwise_sum(first, mid) + pairwise_sum(mid, last);
+  }
+  value_type sum{};
+  std::size_t i = 0;
+  if (n >= n_lanes) {
+    std::array<value_type, n_lanes> lanes{};
+    for (; i + n_lanes <= n; i += n_lanes) {
+      for (std::size_t j = 0; j < n_lanes; j++)
+        lanes[j] += first[static_cast<std::ptrdiff_t>(i + j)];
+    }
+    sum = ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) +
+      ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+  }
+  for (; i < n; i++)
+    sum += first[static_cast<std::ptrdiff_t>(i)];
+  return sum;
+}
+
+/**
+ * Reduce a range of partial results with a fixed binary tree.
+ *
+ * The range is halved recursively and the halves are added, so the shape of
+ * the tree, and thus the result, only depends on the length of the range.
+ * When the partials are indexed by chunk rather than by thread, e.g. as
+ * returned by `run_hedged`, the reduction does not depend on the number of
+ * threads or the order in which chunks finished.
+ *
+ * @tparam It *RandomAccessIterator* over values supporting `operator+`
+ *
+ * @param first Iterator to the first partial
+ * @param last Iterator one past the last partial
+ * @returns Reduced value, value-initialized if the range is empty
+ */
+template <typename It>
+typename std::iterator_traits<It>::value_type tree_reduce(It first, It last)
+{
+  using value_type = typename std::iterator_traits<It>::value_type;
+  auto n = std::distance(first, last);
+  if (!n)
+    return value_type{};
+  if (n == 1)
+    return *first;
+  auto mid = std::next(first, n / 2);
+  return tree_reduce(first, mid) + tree_reduce(mid, last);
+}
+
+/**
+ * Reproducibly reduce chunk partials computed on the calling thread.
+ *
+ * The reproducible reductions compute one partial per chunk, each of which
+ * must be a pure function of its chunk index, e.g. by seeding a fresh PRNG
+ * per chunk, and reduce the partials with `tree_reduce`. Since the chunks are
+ * fixed by the caller rather than by the thread count, every backend gives
+ * bitwise-identical results for the same number of chunks.
+ *
+ * @tparam T Partial type, e.g. `double` or `compensated<double>`
+ * @tparam F Callable with signature `T(std::size_t)`
+ *
+ * @param n_chunks Number of chunks
+ * @param func Callable invoked with each chunk index
+ */
+template <typename T, typename F>
+T reproducible_reduce(std::size_t n_chunks, F&& func)
+{
+  std::vector<T> partials(n_chunks);
+  for (std::size_t i = 0; i < n_chunks; i++)
+    partials[i] = func(i);
+  return tree_reduce(partials.begin(), partials.end());
+}
+
+/**
+ * Reproducibly reduce chunk partials computed on a worker pool.
+ *
+ * Workers claim chunks dynamically, so uneven chunks are load balanced, while
+ * the result is identical to that of the serial `reproducible_reduce`.
+ *
+ * @tparam T Partial type, e.g. `double` or `compensated<double>`
+ * @tparam F Callable with signature `T(std::size_t)`
+ *
+ * @param pool Worker pool to compute partials on
+ * @param n_chunks Number of chunks
+ * @param func Callable invoked with each chunk index
+ */
+template <typename T, typename F>
+T reproducible_reduce(worker_pool& pool, std::size_t n_chunks, F&& func)
+{
+  std::vector<T> partials(n_chunks);
+  std::atomic<std::size_t> next_chunk{};
+  pool.run(
+    [&](unsigned int)
+    {
+      for (
+        auto i = next_chunk.fetch_add(1u, std::memory_order_relaxed);
+        i < n_chunks;
+        i = next_chunk.fetch_add(1u, std::memory_order_relaxed)
+      )
+        partials[i] = func(i);
+    }
+  );
+  return tree_reduce(partials.begin(), partials.end());
+}
+
+#ifdef _OPENMP
+/**
+ * Reproducibly reduce chunk partials computed with OpenMP.
+ *
+ * Chunks are scheduled dynamically, while the result is identical to that of
+ * the serial `reproducible_reduce`. If the number of threads is not given,
+ * i.e. left as 0, then OpenMP chooses number of threads.
+ *
+ * @note `func` must not throw, as exceptions cannot leave a parallel region.
+ *
+ * @tparam T Partial type, e.g. `double` or `compensated<double>`
+ * @tparam F Callable with signature `T(std::size_t)`
+ *
+ * @param n_chunks Number of chunks
+ * @param func Callable invoked with each chunk index
+ * @param n_threads Number of OpenMP threads to split work over
+ */
+template <typename T, typename F>
+T reproducible_reduce_omp(
+  std::size_t n_chunks, F&& func, unsigned int n_threads = 0u)
+{
+  std::vector<T> partials(n_chunks);
+  // MSVC complains about signed/unsigned mismatch
+PDMPMT_MSVC_WARNING_PUSH()
+PDMPMT_MSVC_WARNING_DISABLE(4365)
+  auto n_team = (n_threads) ? n_threads : omp_get_max_threads();
+PDMPMT_MSVC_WARNING_POP()
+  #pragma omp parallel for schedule(dynamic) num_threads(n_team)
+// for MSVC, since its OpenMP version is quite old (2.0), must use signed var
+  for (
+#ifdef _MSC_VER
+    std::intmax_t i = 0;
+    i < static_cast<decltype(i)>(n_chunks);
+#else
+    std::size_t i = 0;
+    i < n_chunks;
+#endif  // _MSC_VER
+    i++
+  ) {
+// MSVC complains of signed/unsigned mismatch as i is intmax_t
+PDMPMT_MSVC_WARNING_PUSH()
+PDMPMT_MSVC_WARNING_DISABLE(4365)
+    partials[i] = func(static_cast<std::size_t>(i));
+PDMPMT_MSVC_WARNING_POP()
+  }
+  return tree_reduce(partials.begin(), partials.end());
+}
+#endif  // _OPENMP
+
+}  // namespace pdmpmt
+
+#endif  // PDMPMT_REDUCE_HH_
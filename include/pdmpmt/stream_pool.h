@@ -0,0 +1,188 @@
+/**
+ * @file stream_pool.h
+ * @author Derek Huang
+ * @brief C header for a pool of disjoint PRNG streams leased by threads
+ * @copyright MIT License
+ */
+
+#ifndef PDMPMT_STREAM_POOL_H_
+#define PDMPMT_STREAM_POOL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "pdmpmt/common.h"
+#include "pdmpmt/dllexport.h"
+#include "pdmpmt/mcpi.h"
+
+PDMPMT_EXTERN_C_BEGIN
+
+/**
+ * Pool of pre-jumped, disjoint PRNG streams.
+ *
+ * The pool caches one stream of the prand stream hierarchy per slot, i.e.
+ * slot `i` holds stream `i` of the hierarchy rooted at the pool seed. Each
+ * lease hands out a whole substream, and a returned lease is moved to the
+ * next substream of its stream by a background thread, so concurrent callers
+ * that lease from the pool skip PRNG setup and never share samples.
+ *
+ * Ready and returned slots are kept in lock-free free lists, so leasing and
+ * returning never block. If no slot is ready the caller sets up a returned
+ * slot itself, and if every slot is leased, an uncached stream past the
+ * slots is created for the caller and released when returned.
+ */
+typedef struct pdmpmt_stream_pool pdmpmt_stream_pool;
+
+/**
+ * Substream leased from a pool.
+ */
+typedef struct pdmpmt_stream_lease pdmpmt_stream_lease;
+
+/**
+ * Create a new stream pool and start its background refill thread.
+ *
+ * @param rng_type PRNG type
+ * @param seed Seed value for the root of the stream hierarchy
+ * @param capacity Number of cached streams, must be positive
+ * @returns New pool or `NULL` on error
+ */
+PDMPMT_PUBLIC pdmpmt_stream_pool *
+pdmpmt_stream_pool_create(
+  pdmpmt_rng_type rng_type,
+  unsigned long seed,
+  unsigned int capacity) PDMPMT_NOEXCEPT;
+
+/**
+ * Stop the refill thread and release a pool.
+ *
+ * All leases must have been returned. If the pool is installed it is also
+ * uninstalled. Destroying `NULL` is a no-op.
+ *
+ * @param pool Pool to release
+ */
+PDMPMT_PUBLIC void
+pdmpmt_stream_pool_destroy(pdmpmt_stream_pool *pool) PDMPMT_NOEXCEPT;
+
+/**
+ * Return the number of cached streams of a pool.
+ *
+ * @param pool Pool
+ */
+PDMPMT_PUBLIC unsigned int
+pdmpmt_stream_pool_capacity(const pdmpmt_stream_pool *pool) PDMPMT_NOEXCEPT;
+
+/**
+ * Return the number of cached streams ready to be leased.
+ *
+ * The value is a snapshot and may be stale by the time it is used.
+ *
+ * @param pool Pool
+ */
+PDMPMT_PUBLIC unsigned int
+pdmpmt_stream_pool_n_ready(const pdmpmt_stream_pool *pool) PDMPMT_NOEXCEPT;
+
+/**
+ * Lease a substream from a pool.
+ *
+ * Thread-safe and lock-free. The lease must be returned to the same pool.
+ *
+ * @param pool Pool to lease from
+ * @returns Leased substream or `NULL` if memory allocation fails
+ */
+PDMPMT_PUBLIC pdmpmt_stream_lease *
+pdmpmt_stream_pool_lease(pdmpmt_stream_pool *pool) PDMPMT_NOEXCEPT;
+
+/**
+ * Return a lease to a pool.
+ *
+ * Thread-safe and lock-free. The substream must not be used afterwards.
+ *
+ * @param pool Pool the lease is from
+ * @param lease Lease to return
+ */
+PDMPMT_PUBLIC void
+pdmpmt_stream_pool_return(
+  pdmpmt_stream_pool *pool,
+  pdmpmt_stream_lease *lease) PDMPMT_NOEXCEPT;
+
+/**
+ * Return the position of a leased substream in the stream hierarchy.
+ *
+ * Samples drawn from a lease can be reproduced from its pool seed, stream
+ * index, and substream index with the prand stream hierarchy API.
+ *
+ * @param lease Lease
+ * @param stream Address to write the stream index to
+ * @param substream Address to write the substream index to
+ */
+PDMPMT_PUBLIC void
+pdmpmt_stream_lease_position(
+  const pdmpmt_stream_lease *lease,
+  uint64_t *stream,
+  uint64_t *substream) PDMPMT_NOEXCEPT;
+
+/**
+ * Fill a buffer with uniform values in (0, 1) drawn from a leased substream.
+ *
+ * @param lease Lease to draw from
+ * @param out Buffer to write to
+ * @param n Number of values to draw
+ */
+PDMPMT_PUBLIC void
+pdmpmt_stream_lease_uniform(
+  pdmpmt_stream_lease *lease,
+  double *out,
+  size_t n) PDMPMT_NOEXCEPT;
+
+/**
+ * Draw and count samples in [-1, 1] x [-1, 1] that fall in the unit circle.
+ *
+ * Samples are drawn from the leased substream like those of
+ * `pdmpmt_rng_unit_circle_samples`, i.e. two PRNG outputs per sample.
+ *
+ * @param n_samples Number of samples to draw
+ * @param lease Lease to draw from
+ */
+PDMPMT_PUBLIC size_t
+pdmpmt_stream_lease_unit_circle_samples(
+  size_t n_samples,
+  pdmpmt_stream_lease *lease) PDMPMT_NOEXCEPT;
+
+/**
+ * Estimate pi using Monte Carlo with a substream leased from a pool.
+ *
+ * Safe to call from many threads at once, as each call leases its own
+ * substream and returns it when done.
+ *
+ * @param n_samples Number of samples to use
+ * @param pool Pool to lease from, `NULL` for the installed pool
+ * @returns Estimate of pi, NaN if `n_samples` is zero, no pool was given or
+ *  installed, or leasing a substream fails
+ */
+PDMPMT_PUBLIC double
+pdmpmt_stream_pool_mcpi(
+  size_t n_samples,
+  pdmpmt_stream_pool *pool) PDMPMT_NOEXCEPT;
+
+/**
+ * Install a pool as the process-wide pool.
+ *
+ * The installed pool is used by `pdmpmt_stream_pool_mcpi` when it is given a
+ * `NULL` pool. Installing is atomic, but a pool must not be uninstalled or
+ * destroyed while other threads are still using it.
+ *
+ * @param pool Pool created with `pdmpmt_stream_pool_create`, `NULL` to
+ *  uninstall
+ */
+PDMPMT_PUBLIC void
+pdmpmt_stream_pool_install(pdmpmt_stream_pool *pool) PDMPMT_NOEXCEPT;
+
+/**
+ * Return the installed process-wide pool or `NULL` if there is none.
+ */
+PDMPMT_PUBLIC pdmpmt_stream_pool *
+pdmpmt_stream_pool_installed(void) PDMPMT_NOEXCEPT;
+
+PDMPMT_EXTERN_C_END
+
+#endif  // PDMPMT_STREAM_POOL_H_
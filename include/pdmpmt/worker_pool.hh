@@ -0,0 +1,571 @@
+/**
+ * @file worker_pool.hh
+ * @author Derek Huang
+ * @brief C++ header for a low-latency fork-join worker pool
+ * @copyright MIT License
+ */
+
+#ifndef PDMPMT_WORKER_POOL_HH_
+#define PDMPMT_WORKER_POOL_HH_
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif  // WIN32_LEAN_AND_MEAN
+// std::min and std::max are used below
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif  // NOMINMAX
+#include <Windows.h>
+// WaitOnAddress and WakeByAddressAll are in Synchronization.lib
+#ifdef _MSC_VER
+#pragma comment(lib, "Synchronization.lib")
+#endif  // _MSC_VER
+#endif  // !defined(__linux__) && defined(_WIN32)
+
+#if defined(__i386__) || defined(__x86_64__) || \
+  defined(_M_IX86) || defined(_M_X64)
+#include <immintrin.h>
+#endif  // !defined(__i386__) && ... && !defined(_M_X64)
+
+namespace pdmpmt {
+
+namespace detail {
+
+// destructive interference size assumed for padding shared state. GCC only
+// provides std::hardware_destructive_interference_size starting with 12.1
+inline constexpr std::size_t cache_line_size = 64u;
+
+// futex word type. the atomic must have the same representation as the word
+using wait_word = std::atomic<std::uint32_t>;
+static_assert(sizeof(wait_word) == sizeof(std::uint32_t));
+static_assert(wait_word::is_always_lock_free);
+
+/**
+ * Hint to the CPU that the calling thread is in a spin-wait loop.
+ *
+ * On x86 this is `pause`, which reduces power use and the memory order
+ * violation penalty on loop exit. On ARM this is `yield`.
+ */
+inline void cpu_relax() noexcept
+{
+#if defined(__i386__) || defined(__x86_64__) || \
+  defined(_M_IX86) || defined(_M_X64)
+  _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+  __asm__ __volatile__("yield");
+#elif defined(_M_ARM64) || defined(_M_ARM)
+  __yield();
+#endif  // !defined(__i386__) && ... && !defined(_M_ARM)
+}
+
+/**
+ * Block the calling thread while the word still holds the given value.
+ *
+ * May return spuriously, so callers must re-check the word. On systems with
+ * no futex-like primitive this sleeps briefly instead.
+ *
+ * @param word Word to wait on
+ * @param value Value the word is expected to hold
+ */
+inline void park(wait_word& word, std::uint32_t value) noexcept
+{
+#if defined(__linux__)
+  syscall(
+    SYS_futex,
+    reinterpret_cast<std::uint32_t*>(&word),
+    FUTEX_WAIT_PRIVATE,
+    value,
+    nullptr,
+    nullptr,
+    0
+  );
+#elif defined(_WIN32)
+  WaitOnAddress(&word, &value, sizeof value, INFINITE);
+#else
+  (void) word;
+  (void) value;
+  std::this_thread::sleep_for(std::chrono::microseconds{50});
+#endif  // !defined(__linux__) && !defined(_WIN32)
+}
+
+/**
+ * Wake all threads blocked in `park` on the word.
+ *
+ * @param word Word threads are waiting on
+ */
+inline void unpark_all(wait_word& word) noexcept
+{
+#if defined(__linux__)
+  syscall(
+    SYS_futex,
+    reinterpret_cast<std::uint32_t*>(&word),
+    FUTEX_WAKE_PRIVATE,
+    INT_MAX,
+    nullptr,
+    nullptr,
+    0
+  );
+#elif defined(_WIN32)
+  WakeByAddressAll(&word);
+#else
+  (void) word;
+#endif  // !defined(__linux__) && !defined(_WIN32)
+}
+
+/**
+ * Return the steady clock time in nanoseconds.
+ */
+inline std::int64_t steady_ns() noexcept
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()
+  ).count();
+}
+
+}  // namespace detail
+
+/**
+ * Waiting policy for the worker pool.
+ *
+ * Idle workers spin with `pause` for the spin window before parking on a
+ * futex. Spinning trades idle CPU for wake latency: a spinning worker sees a
+ * new task within about a hundred nanoseconds, while waking a parked worker
+ * costs a system call and a reschedule, typically tens of microseconds.
+ *
+ * The first `n_hot` workers are kept in hot standby, i.e. they never park
+ * between tasks and each keeps a CPU busy while the pool is idle.
+ */
+struct wait_policy {
+  std::chrono::nanoseconds spin_window{std::chrono::microseconds{50}};
+  unsigned int n_hot = 0u;
+};
+
+/**
+ * Worker wake latency statistics.
+ *
+ * The wake latency is the time from task submission until a worker starts
+ * running it. Latencies are also binned in a base 2 log histogram, where
+ * bucket `k` counts latencies in `[2^k, 2^(k + 1))` ns, with bucket 0 also
+ * counting zero latencies and the last bucket counting all longer latencies.
+ * The number of times `run` parked the calling thread past the spin window
+ * while waiting for the workers is also counted.
+ */
+struct wake_stats {
+  static constexpr unsigned int n_buckets = 32u;
+
+  std::uint64_t n_spin_wakes = 0u;    // wakes while spinning
+  std::uint64_t n_park_wakes = 0u;    // wakes after parking
+  std::uint64_t total_ns = 0u;        // total wake latency
+  std::uint64_t max_ns = 0u;          // maximum wake latency
+  std::uint64_t n_caller_parks = 0u;  // times run parked awaiting stragglers
+  std::array<std::uint64_t, n_buckets> histogram{};
+
+  /**
+   * Return the total number of wakes.
+   */
+  auto n_wakes() const noexcept
+  {
+    return n_spin_wakes + n_park_wakes;
+  }
+
+  /**
+   * Return the mean wake latency in nanoseconds, 0 if there were no wakes.
+   */
+  double mean_ns() const noexcept
+  {
+    return n_wakes() ? static_cast<double>(total_ns) / n_wakes() : 0.;
+  }
+
+  /**
+   * Return an upper bound for the given quantile of the wake latency.
+   *
+   * The bound is the upper edge of the histogram bucket containing the
+   * quantile, clamped to the maximum latency.
+   *
+   * @param q Quantile in [0, 1], e.g. 0.99 for the 99th percentile
+   */
+  std::uint64_t quantile_ns(double q) const noexcept
+  {
+    auto n_target = static_cast<std::uint64_t>(q * n_wakes());
+    std::uint64_t n_seen = 0u;
+    for (unsigned int k = 0; k < n_buckets; k++) {
+      n_seen += histogram[k];
+      if (n_seen && n_seen >= n_target)
+        return std::min(std::uint64_t{2} << k, max_ns);
+    }
+    return max_ns;
+  }
+};
+
+/**
+ * Fork-join worker pool with hybrid spin-then-park waiting.
+ *
+ * A pool of size `n` owns `n - 1` threads. `run` invokes a task for each
+ * worker index in `[0, n)`, with index 0 run by the calling thread, and
+ * returns once all indices are done, like an OpenMP parallel region. The
+ * calling thread waits for stragglers with the same spin-then-park policy.
+ *
+ * Unlike OpenMP, the waiting policy can be changed while the pool is alive,
+ * and the latency of each worker wake is recorded.
+ */
+class worker_pool {
+public:
+  /**
+   * Ctor.
+   *
+   * @param n_threads Pool size including the calling thread, 0 is treated as 1
+   * @param policy Waiting policy
+   */
+  explicit worker_pool(
+    unsigned int n_threads = std::thread::hardware_concurrency(),
+    const wait_policy& policy = {})
+    : n_threads_{std::max(n_threads, 1u)},
+      spin_ns_{static_cast<std::uint64_t>(policy.spin_window.count())},
+      n_hot_{policy.n_hot},
+      states_{std::make_unique<worker_state[]>(n_threads_)}
+  {
+    threads_.reserve(n_threads_ - 1u);
+    for (unsigned int i = 1; i < n_threads_; i++)
+      threads_.emplace_back([this, i] { worker_main(i); });
+  }
+
+  /**
+   * Dtor.
+   *
+   * Wakes all the workers, including parked ones, and joins them.
+   */
+  ~worker_pool()
+  {
+    stop_.store(true, std::memory_order_relaxed);
+    epoch_.fetch_add(1u);
+    detail::unpark_all(epoch_);
+    for (auto& thread : threads_)
+      thread.join();
+  }
+
+  worker_pool(const worker_pool&) = delete;
+  worker_pool& operator=(const worker_pool&) = delete;
+
+  /**
+   * Return the pool size, including the calling thread.
+   */
+  auto size() const noexcept { return n_threads_; }
+
+  /**
+   * Run a task for each worker index and block until all are done.
+   *
+   * If any invocation throws, the first exception caught is rethrown once all
+   * the workers are done. Concurrent calls are serialized. Calling `run` from
+   * within a task deadlocks.
+   *
+   * @tparam F Callable with signature `void(unsigned int)`
+   *
+   * @param func Task to invoke with each worker index
+   */
+  template <typename F>
+  void run(F&& func)
+  {
+    using func_type = std::remove_reference_t<F>;
+    std::lock_guard lock{run_mutex_};
+    task_ = [](const void* ctx, unsigned int index)
+    {
+      (*static_cast<func_type*>(const_cast<void*>(ctx)))(index);
+    };
+    task_ctx_ = std::addressof(func);
+    error_ = nullptr;
+    remaining_.store(n_threads_ - 1u, std::memory_order_relaxed);
+    submit_ns_.store(detail::steady_ns(), std::memory_order_relaxed);
+    // seq_cst pairs with the parker count increment in spin_then_park so we
+    // either see the parked workers or they see the new epoch
+    epoch_.fetch_add(1u);
+    if (n_parked_.load())
+      detail::unpark_all(epoch_);
+    execute(0u);
+    auto parked = spin_then_park(
+      remaining_,
+      [](std::uint32_t value) { return !value; },
+      0u,
+      n_caller_parked_
+    );
+    if (parked)
+      store(n_caller_parks_, load(n_caller_parks_) + 1u);
+    if (error_)
+      std::rethrow_exception(std::exchange(error_, nullptr));
+  }
+
+  /**
+   * Return the spin window.
+   */
+  auto spin_window() const noexcept
+  {
+    return std::chrono::nanoseconds{spin_ns_.load(std::memory_order_relaxed)};
+  }
+
+  /**
+   * Set the spin window.
+   *
+   * Takes effect the next time a worker starts waiting.
+   *
+   * @param window Spin window
+   */
+  void spin_window(std::chrono::nanoseconds window) noexcept
+  {
+    spin_ns_.store(
+      static_cast<std::uint64_t>(window.count()), std::memory_order_relaxed
+    );
+  }
+
+  /**
+   * Return the number of workers kept in hot standby.
+   */
+  auto hot_standby() const noexcept
+  {
+    return n_hot_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Set the number of workers kept in hot standby.
+   *
+   * Workers that are already parked become hot after their next wake.
+   *
+   * @param n_hot Number of workers to keep spinning between tasks
+   */
+  void hot_standby(unsigned int n_hot) noexcept
+  {
+    n_hot_.store(n_hot, std::memory_order_relaxed);
+  }
+
+  /**
+   * Return the wake latency statistics accumulated over all the workers.
+   *
+   * Call while no task is running for an exact snapshot.
+   */
+  wake_stats wake_statistics() const noexcept
+  {
+    wake_stats stats;
+    stats.n_caller_parks = load(n_caller_parks_);
+    for (unsigned int i = 1; i < n_threads_; i++) {
+      const auto& state = states_[i];
+      stats.n_spin_wakes += load(state.n_spin_wakes);
+      stats.n_park_wakes += load(state.n_park_wakes);
+      stats.total_ns += load(state.total_ns);
+      stats.max_ns = std::max(stats.max_ns, load(state.max_ns));
+      for (unsigned int k = 0; k < wake_stats::n_buckets; k++)
+        stats.histogram[k] += load(state.histogram[k]);
+    }
+    return stats;
+  }
+
+  /**
+   * Reset the wake latency statistics.
+   *
+   * Must not be called while a task is running.
+   */
+  void reset_wake_statistics() noexcept
+  {
+    store(n_caller_parks_, 0u);
+    for (unsigned int i = 1; i < n_threads_; i++) {
+      auto& state = states_[i];
+      store(state.n_spin_wakes, 0u);
+      store(state.n_park_wakes, 0u);
+      store(state.total_ns, 0u);
+      store(state.max_ns, 0u);
+      for (auto& bucket : state.histogram)
+        store(bucket, 0u);
+    }
+  }
+
+private:
+  using counter = std::atomic<std::uint64_t>;
+
+  /**
+   * Per-worker statistics, each written only by its own worker.
+   *
+   * Occupies whole cache lines so workers do not falsely share them.
+   */
+  struct alignas(detail::cache_line_size) worker_state {
+    counter n_spin_wakes{};
+    counter n_park_wakes{};
+    counter total_ns{};
+    counter max_ns{};
+    std::array<counter, wake_stats::n_buckets> histogram{};
+  };
+
+  unsigned int n_threads_;
+  std::atomic<std::uint64_t> spin_ns_;
+  std::atomic<unsigned int> n_hot_;
+  std::unique_ptr<worker_state[]> states_;
+  std::vector<std::thread> threads_;
+  // task state, written by run before the epoch is incremented
+  void (*task_)(const void*, unsigned int) = nullptr;
+  const void* task_ctx_ = nullptr;
+  std::atomic<std::int64_t> submit_ns_{};
+  std::atomic<bool> stop_{};
+  std::mutex run_mutex_;
+  std::mutex error_mutex_;
+  std::exception_ptr error_;
+  // wait words and the number of threads parked on each
+  alignas(detail::cache_line_size) detail::wait_word epoch_{};
+  alignas(detail::cache_line_size) detail::wait_word remaining_{};
+  alignas(detail::cache_line_size) detail::wait_word n_parked_{};
+  detail::wait_word n_caller_parked_{};
+  // only written by run, which is serialized
+  counter n_caller_parks_{};
+
+  /**
+   * Relaxed load of a statistics counter.
+   */
+  static std::uint64_t load(const counter& value) noexcept
+  {
+    return value.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Relaxed store to a statistics counter.
+   *
+   * Only the owning worker writes its counters, so no read-modify-write is
+   * needed and incrementing does not need a locked instruction.
+   */
+  static void store(counter& value, std::uint64_t new_value) noexcept
+  {
+    value.store(new_value, std::memory_order_relaxed);
+  }
+
+  /**
+   * Spin and then park until the word satisfies the predicate.
+   *
+   * @tparam P Callable with signature `bool(std::uint32_t)`
+   *
+   * @param word Word to wait on
+   * @param ready Predicate indicating the wait is over
+   * @param hot_index Worker index if the waiter may be kept in hot standby,
+   *  i.e. if it is at most the hot standby count, 0 otherwise
+   * @param n_parked Number of threads parked on the word
+   * @returns `true` if the waiter had to park, `false` otherwise
+   */
+  template <typename P>
+  bool spin_then_park(
+    detail::wait_word& word,
+    P ready,
+    unsigned int hot_index,
+    detail::wait_word& n_parked) noexcept
+  {
+    // only check the clock every so often as it costs more than a pause
+    constexpr unsigned int check_mask = 63u;
+    auto spin_ns = static_cast<std::int64_t>(
+      spin_ns_.load(std::memory_order_relaxed)
+    );
+    auto start = detail::steady_ns();
+    for (unsigned int i = 0;; i++) {
+      if (ready(word.load(std::memory_order_acquire)))
+        return false;
+      detail::cpu_relax();
+      if (
+        (i & check_mask) != check_mask ||
+        detail::steady_ns() - start < spin_ns
+      )
+        continue;
+      // hot standby can be changed while spinning so re-check it too. past
+      // the spin window, hot workers yield so an oversubscribed system still
+      // makes progress, which costs nothing if no other thread is runnable
+      if (!hot_index || hot_index > n_hot_.load(std::memory_order_relaxed))
+        break;
+      std::this_thread::yield();
+    }
+    n_parked.fetch_add(1u);
+    for (auto value = word.load(); !ready(value); value = word.load())
+      detail::park(word, value);
+    n_parked.fetch_sub(1u, std::memory_order_relaxed);
+    return true;
+  }
+
+  /**
+   * Run the task for a worker index, capturing any exception.
+   *
+   * @param index Worker index
+   */
+  void execute(unsigned int index) noexcept
+  {
+    try {
+      task_(task_ctx_, index);
+    }
+    catch (...) {
+      std::lock_guard lock{error_mutex_};
+      if (!error_)
+        error_ = std::current_exception();
+    }
+  }
+
+  /**
+   * Record the latency of a worker wake.
+   *
+   * @param state Worker statistics
+   * @param parked `true` if the worker had parked
+   */
+  void record_wake(worker_state& state, bool parked) noexcept
+  {
+    auto latency = static_cast<std::uint64_t>(std::max(
+      detail::steady_ns() - submit_ns_.load(std::memory_order_relaxed),
+      std::int64_t{0}
+    ));
+    auto& n_wakes = (parked) ? state.n_park_wakes : state.n_spin_wakes;
+    store(n_wakes, load(n_wakes) + 1u);
+    store(state.total_ns, load(state.total_ns) + latency);
+    store(state.max_ns, std::max(load(state.max_ns), latency));
+    unsigned int k = 0;
+    while (k + 1u < wake_stats::n_buckets && latency >> (k + 1u))
+      k++;
+    store(state.histogram[k], load(state.histogram[k]) + 1u);
+  }
+
+  /**
+   * Worker thread main loop.
+   *
+   * @param index Worker index, positive since 0 is the calling thread
+   */
+  void worker_main(unsigned int index) noexcept
+  {
+    auto& state = states_[index];
+    std::uint32_t seen = 0u;
+    while (true) {
+      auto parked = spin_then_park(
+        epoch_,
+        [seen](std::uint32_t value) { return value != seen; },
+        index,
+        n_parked_
+      );
+      seen = epoch_.load(std::memory_order_acquire);
+      if (stop_.load(std::memory_order_relaxed))
+        return;
+      record_wake(state, parked);
+      execute(index);
+      // seq_cst pairs with the caller parker count increment
+      if (remaining_.fetch_sub(1u) == 1u && n_caller_parked_.load())
+        detail::unpark_all(remaining_);
+    }
+  }
+};
+
+}  // namespace pdmpmt
+
+#endif  // PDMPMT_WORKER_POOL_HH_
@@ -0,0 +1,96 @@
+/**
+ * @file ziggurat.h
+ * @author Derek Huang
+ * @brief C header for bulk Ziggurat normal and exponential sampling
+ * @copyright MIT License
+ */
+
+#ifndef PDMPMT_ZIGGURAT_H_
+#define PDMPMT_ZIGGURAT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "pdmpmt/common.h"
+#include "pdmpmt/dllexport.h"
+#include "pdmpmt/mcpi.h"
+
+PDMPMT_EXTERN_C_BEGIN
+
+// number of Ziggurat layers, i.e. the layer index is 8 bits of a word
+#define PDMPMT_ZIGGURAT_N_LAYERS 256
+// start of the normal and exponential tails
+#define PDMPMT_ZIGGURAT_NORMAL_R 3.6541528853610088
+#define PDMPMT_ZIGGURAT_EXPONENTIAL_R 7.69711747013104972
+
+/**
+ * Ziggurat layer tables.
+ *
+ * `k[i]` is the acceptance bound for the magnitude bits in layer `i`, `w[i]`
+ * the scale from magnitude bits to a value, and `f[i]` the density at the
+ * layer's right edge. Layer 0 is the base layer plus the tail and layer 1 is
+ * the top layer, which is all wedge so `k[1]` is zero.
+ */
+typedef struct {
+  uint64_t k[PDMPMT_ZIGGURAT_N_LAYERS];
+  double w[PDMPMT_ZIGGURAT_N_LAYERS];
+  double f[PDMPMT_ZIGGURAT_N_LAYERS];
+} pdmpmt_ziggurat_table;
+
+/**
+ * Return the normal Ziggurat tables, using 52 magnitude bits.
+ *
+ * The C++ samplers in `ziggurat.hh` use the same tables.
+ */
+PDMPMT_PUBLIC const pdmpmt_ziggurat_table *
+pdmpmt_ziggurat_normal_table(void) PDMPMT_NOEXCEPT;
+
+/**
+ * Return the exponential Ziggurat tables, using 53 magnitude bits.
+ */
+PDMPMT_PUBLIC const pdmpmt_ziggurat_table *
+pdmpmt_ziggurat_exponential_table(void) PDMPMT_NOEXCEPT;
+
+/**
+ * Fill an array with standard normal samples using the Ziggurat method.
+ *
+ * Samples are drawn in blocks. For each block the PRNG fills a buffer of
+ * 64-bit words with its bulk fill function, a branch-free pass over all lanes
+ * accepts the ~99% of candidates falling inside a Ziggurat layer, and only the
+ * rejected lanes are redone by the scalar wedge and tail tests.
+ *
+ * Each call uses a freshly seeded PRNG, so use different seeds across calls.
+ *
+ * @param out Array to write samples to
+ * @param n Number of samples to write
+ * @param rng_type PRNG type
+ * @param seed Seed value for the PRNG
+ */
+PDMPMT_PUBLIC void
+pdmpmt_rng_normal_fill(
+  double *out,
+  size_t n,
+  pdmpmt_rng_type rng_type,
+  unsigned seed) PDMPMT_NOEXCEPT;
+
+/**
+ * Fill an array with standard exponential samples using the Ziggurat method.
+ *
+ * Blocked like `pdmpmt_rng_normal_fill`, with ~99% of lanes accepted in the
+ * branch-free pass.
+ *
+ * @param out Array to write samples to
+ * @param n Number of samples to write
+ * @param rng_type PRNG type
+ * @param seed Seed value for the PRNG
+ */
+PDMPMT_PUBLIC void
+pdmpmt_rng_exponential_fill(
+  double *out,
+  size_t n,
+  pdmpmt_rng_type rng_type,
+  unsigned seed) PDMPMT_NOEXCEPT;
+
+PDMPMT_EXTERN_C_END
+
+#endif  // PDMPMT_ZIGGURAT_H_
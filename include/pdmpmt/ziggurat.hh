@@ -0,0 +1,841 @@
+/**
+ * @file ziggurat.hh
+ * @author Derek Huang
+ * @brief C++ header for bulk Ziggurat normal and exponential distributions
+ * @copyright MIT License
+ */
+
+#ifndef PDMPMT_ZIGGURAT_HH_
+#define PDMPMT_ZIGGURAT_HH_
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <ios>
+#include <istream>
+#include <iterator>
+#include <limits>
+#include <ostream>
+#include <random>
+#include <type_traits>
+
+#include "pdmpmt/ziggurat.h"
+
+namespace pdmpmt {
+
+namespace detail {
+
+/**
+ * Number of samples drawn per block by the bulk fill functions.
+ */
+inline constexpr std::size_t ziggurat_block = 256u;
+
+/**
+ * Start of the normal tail.
+ */
+inline constexpr double normal_ziggurat_r = PDMPMT_ZIGGURAT_NORMAL_R;
+
+/**
+ * Start of the exponential tail.
+ */
+inline constexpr double exponential_ziggurat_r = PDMPMT_ZIGGURAT_EXPONENTIAL_R;
+
+/**
+ * Return the normal Ziggurat tables, using 52 magnitude bits.
+ *
+ * These are the tables used by the C fill functions, so users of this header
+ * must link against the pdmpmt library.
+ */
+inline const auto& normal_ziggurat_table() noexcept
+{
+  return *pdmpmt_ziggurat_normal_table();
+}
+
+/**
+ * Return the exponential Ziggurat tables, using 53 magnitude bits.
+ *
+ * These are the tables used by the C fill functions.
+ */
+inline const auto& exponential_ziggurat_table() noexcept
+{
+  return *pdmpmt_ziggurat_exponential_table();
+}
+
+/**
+ * Traits to check that a *UniformRandomBitGenerator* outputs full words.
+ *
+ * The Ziggurat samplers need 64 uniform bits per sample and accept 32-bit
+ * generators, e.g. `std::mt19937`, by combining two outputs.
+ *
+ * @tparam Rng *UniformRandomBitGenerator*
+ */
+template <typename Rng>
+struct is_word_generator : std::bool_constant<
+  Rng::min() == 0u &&
+  (
+    Rng::max() == std::numeric_limits<std::uint32_t>::max() ||
+    Rng::max() == std::numeric_limits<std::uint64_t>::max()
+  )
+> {};
+
+/**
+ * Return a uniform 64-bit word from the PRNG.
+ *
+ * @tparam Rng *UniformRandomBitGenerator* with 32 or 64-bit output
+ *
+ * @param rng PRNG instance
+ */
+template <typename Rng>
+inline std::uint64_t random_word(Rng& rng)
+{
+  static_assert(
+    is_word_generator<Rng>::value, "Rng must output 32 or 64-bit words"
+  );
+  if constexpr (Rng::max() == std::numeric_limits<std::uint64_t>::max())
+    return static_cast<std::uint64_t>(rng());
+  else {
+    auto hi = static_cast<std::uint64_t>(rng());
+    return (hi << 32) | static_cast<std::uint64_t>(rng());
+  }
+}
+
+/**
+ * Fill a buffer with uniform 64-bit words from the PRNG.
+ *
+ * @tparam Rng *UniformRandomBitGenerator* with 32 or 64-bit output
+ *
+ * @param rng PRNG instance
+ * @param words Buffer to fill
+ * @param n Number of words
+ */
+template <typename Rng>
+inline void random_words(Rng& rng, std::uint64_t* words, std::size_t n)
+{
+  for (std::size_t i = 0; i < n; i++)
+    words[i] = random_word(rng);
+}
+
+/**
+ * Return a uniform double in [0, 1) with 53 random bits.
+ *
+ * @tparam Rng *UniformRandomBitGenerator* with 32 or 64-bit output
+ *
+ * @param rng PRNG instance
+ */
+template <typename Rng>
+inline double random_double(Rng& rng)
+{
+  return static_cast<double>(random_word(rng) >> 11) * 0x1.0p-53;
+}
+
+/**
+ * Finish a standard normal sample from a word.
+ *
+ * Returns immediately if the word falls inside its layer, otherwise performs
+ * the wedge or tail test and on rejection continues with fresh words.
+ *
+ * @tparam Rng *UniformRandomBitGenerator* with 32 or 64-bit output
+ *
+ * @param rng PRNG instance
+ * @param word 64-bit word
+ */
+template <typename Rng>
+double normal_ziggurat_sample(Rng& rng, std::uint64_t word)
+{
+  constexpr auto mask = (std::uint64_t{1} << 52) - 1u;
+  constexpr auto r = normal_ziggurat_r;
+  const auto& table = normal_ziggurat_table();
+  while (true) {
+    auto idx = static_cast<unsigned int>(word & 0xffu);
+    auto sign = (word >> 8) & 1u;
+    auto rabs = (word >> 9) & mask;
+    auto x = static_cast<double>(rabs) * table.w[idx];
+    if (sign)
+      x = -x;
+    if (rabs < table.k[idx])
+      return x;
+    // tail, sampled with the method of Marsaglia (1964)
+    if (!idx) {
+      while (true) {
+        auto xx = -std::log1p(-random_double(rng)) / r;
+        auto yy = -std::log1p(-random_double(rng));
+        if (yy + yy > xx * xx)
+          return (sign) ? -(r + xx) : r + xx;
+      }
+    }
+    // wedge
+    auto f_lo = table.f[idx];
+    auto f_hi = table.f[idx - 1];
+    if ((f_hi - f_lo) * random_double(rng) + f_lo < std::exp(-.5 * x * x))
+      return x;
+    word = random_word(rng);
+  }
+}
+
+/**
+ * Finish a standard exponential sample from a word.
+ *
+ * @tparam Rng *UniformRandomBitGenerator* with 32 or 64-bit output
+ *
+ * @param rng PRNG instance
+ * @param word 64-bit word
+ */
+template <typename Rng>
+double exponential_ziggurat_sample(Rng& rng, std::uint64_t word)
+{
+  const auto& table = exponential_ziggurat_table();
+  while (true) {
+    auto bits = word >> 3;
+    auto idx = static_cast<unsigned int>(bits & 0xffu);
+    auto r = bits >> 8;
+    auto x = static_cast<double>(r) * table.w[idx];
+    if (r < table.k[idx])
+      return x;
+    // tail is memoryless so it is just the start of the tail plus a sample
+    if (!idx)
+      return exponential_ziggurat_r - std::log1p(-random_double(rng));
+    auto f_lo = table.f[idx];
+    auto f_hi = table.f[idx - 1];
+    if ((f_hi - f_lo) * random_double(rng) + f_lo < std::exp(-x))
+      return x;
+    word = random_word(rng);
+  }
+}
+
+/**
+ * Fill a range with standard normal samples in blocks.
+ *
+ * Each block is drawn as a buffer of words, a branch-free pass over all lanes
+ * accepts the ~99% of candidates inside their layer, and only the rejected
+ * lanes are finished by the scalar wedge and tail tests.
+ *
+ * @tparam Rng *UniformRandomBitGenerator* with 32 or 64-bit output
+ * @tparam OutputIt *LegacyOutputIterator*
+ * @tparam F Callable with signature `void(double*, std::size_t)` to apply to
+ *  each block of samples before writing
+ *
+ * @param rng PRNG instance
+ * @param first Start of the output range
+ * @param n Number of samples
+ * @param transform Transformation applied in place to each block
+ */
+template <typename Rng, typename OutputIt, typename F>
+OutputIt normal_ziggurat_fill(
+  Rng& rng, OutputIt first, std::size_t n, F transform)
+{
+  constexpr auto mask = (std::uint64_t{1} << 52) - 1u;
+  const auto& table = normal_ziggurat_table();
+  std::array<std::uint64_t, ziggurat_block> words;
+  std::array<double, ziggurat_block> x;
+  std::array<unsigned char, ziggurat_block> reject;
+  for (std::size_t done = 0; done < n; done += ziggurat_block) {
+    auto m = std::min(ziggurat_block, n - done);
+    random_words(rng, words.data(), m);
+    // branch-free lane pass. the table lookups are gathers, so this vectorizes
+    // on targets with gather instructions, e.g. AVX2
+    for (std::size_t i = 0; i < m; i++) {
+      auto idx = static_cast<unsigned int>(words[i] & 0xffu);
+      auto rabs = (words[i] >> 9) & mask;
+      auto mag = static_cast<double>(rabs) * table.w[idx];
+      x[i] = ((words[i] >> 8) & 1u) ? -mag : mag;
+      reject[i] = rabs >= table.k[idx];
+    }
+    // scalar fallback for the rejected lanes
+    for (std::size_t i = 0; i < m; i++) {
+      if (reject[i])
+        x[i] = normal_ziggurat_sample(rng, words[i]);
+    }
+    transform(x.data(), m);
+    first = std::copy(x.begin(), x.begin() + m, first);
+  }
+  return first;
+}
+
+/**
+ * Fill a range with standard exponential samples in blocks.
+ *
+ * @tparam Rng *UniformRandomBitGenerator* with 32 or 64-bit output
+ * @tparam OutputIt *LegacyOutputIterator*
+ * @tparam F Callable with signature `void(double*, std::size_t)` to apply to
+ *  each block of samples before writing
+ *
+ * @param rng PRNG instance
+ * @param first Start of the output range
+ * @param n Number of samples
+ * @param transform Transformation applied in place to each block
+ */
+template <typename Rng, typename OutputIt, typename F>
+OutputIt exponential_ziggurat_fill(
+  Rng& rng, OutputIt first, std::size_t n, F transform)
+{
+  const auto& table = exponential_ziggurat_table();
+  std::array<std::uint64_t, ziggurat_block> words;
+  std::array<double, ziggurat_block> x;
+  std::array<unsigned char, ziggurat_block> reject;
+  for (std::size_t done = 0; done < n; done += ziggurat_block) {
+    auto m = std::min(ziggurat_block, n - done);
+    random_words(rng, words.data(), m);
+    for (std::size_t i = 0; i < m; i++) {
+      auto bits = words[i] >> 3;
+      auto idx = static_cast<unsigned int>(bits & 0xffu);
+      auto r = bits >> 8;
+      x[i] = static_cast<double>(r) * table.w[idx];
+      reject[i] = r >= table.k[idx];
+    }
+    for (std::size_t i = 0; i < m; i++) {
+      if (reject[i])
+        x[i] = exponential_ziggurat_sample(rng, words[i]);
+    }
+    transform(x.data(), m);
+    first = std::copy(x.begin(), x.begin() + m, first);
+  }
+  return first;
+}
+
+/**
+ * Scoped stream formatting for reading and writing distribution parameters.
+ *
+ * Like the standard distributions, parameters are written in scientific
+ * notation separated by spaces, with enough digits given to round-trip. The
+ * original formatting of the stream is restored on destruction.
+ *
+ * @tparam CharT Character type
+ * @tparam Traits Character traits type
+ */
+template <typename CharT, typename Traits>
+class ziggurat_ios_format {
+public:
+  /**
+   * Ctor.
+   *
+   * @param ios Stream to format
+   * @param precision Number of significant digits to write
+   */
+  ziggurat_ios_format(
+    std::basic_ios<CharT, Traits>& ios, std::streamsize precision)
+    : ios_{ios},
+      flags_{ios.flags()},
+      fill_{ios.fill()},
+      precision_{ios.precision()}
+  {
+    ios.flags(
+      std::ios_base::dec | std::ios_base::left | std::ios_base::scientific |
+      std::ios_base::skipws
+    );
+    ios.fill(ios.widen(' '));
+    ios.precision(precision);
+  }
+
+  /**
+   * Dtor.
+   */
+  ~ziggurat_ios_format()
+  {
+    ios_.flags(flags_);
+    ios_.fill(fill_);
+    ios_.precision(precision_);
+  }
+
+  ziggurat_ios_format(const ziggurat_ios_format&) = delete;
+  ziggurat_ios_format& operator=(const ziggurat_ios_format&) = delete;
+
+private:
+  std::basic_ios<CharT, Traits>& ios_;
+  std::ios_base::fmtflags flags_;
+  CharT fill_;
+  std::streamsize precision_;
+};
+
+}  // namespace detail
+
+/**
+ * Normal distribution sampled with the Ziggurat method.
+ *
+ * Satisfies *RandomNumberDistribution*, so it is a drop-in replacement for
+ * `std::normal_distribution` wherever a distribution policy is accepted, with
+ * `fill` for bulk sampling. Bulk and scalar sampling draw from the same
+ * distribution but not in the same order.
+ *
+ * @tparam T Floating-point result type
+ */
+template <typename T = double>
+class normal_ziggurat {
+public:
+  static_assert(std::is_floating_point_v<T>);
+  using result_type = T;
+
+  /**
+   * Distribution parameters.
+   */
+  class param_type {
+  public:
+    using distribution_type = normal_ziggurat;
+
+    /**
+     * Ctor.
+     *
+     * @param mean Distribution mean
+     * @param stddev Distribution standard deviation, must be positive
+     */
+    explicit param_type(T mean = 0, T stddev = 1) noexcept
+      : mean_{mean}, stddev_{stddev}
+    {}
+
+    /**
+     * Return the distribution mean.
+     */
+    T mean() const noexcept { return mean_; }
+
+    /**
+     * Return the distribution standard deviation.
+     */
+    T stddev() const noexcept { return stddev_; }
+
+    /**
+     * Check if two sets of parameters are equal.
+     */
+    friend bool operator==(const param_type& a, const param_type& b) noexcept
+    {
+      return a.mean_ == b.mean_ && a.stddev_ == b.stddev_;
+    }
+
+    /**
+     * Check if two sets of parameters are not equal.
+     */
+    friend bool operator!=(const param_type& a, const param_type& b) noexcept
+    {
+      return !(a == b);
+    }
+
+    /**
+     * Write the parameters to a stream.
+     */
+    template <typename CharT, typename Traits>
+    friend auto&
+    operator<<(std::basic_ostream<CharT, Traits>& out, const param_type& param)
+    {
+      detail::ziggurat_ios_format format{out, digits};
+      return out << param.mean_ << out.widen(' ') << param.stddev_;
+    }
+
+    /**
+     * Read the parameters from a stream.
+     *
+     * On failure the parameters are unchanged and the stream failbit is set.
+     */
+    template <typename CharT, typename Traits>
+    friend auto&
+    operator>>(std::basic_istream<CharT, Traits>& in, param_type& param)
+    {
+      detail::ziggurat_ios_format format{in, digits};
+      T mean, stddev;
+      if (in >> mean >> stddev)
+        param = param_type{mean, stddev};
+      return in;
+    }
+
+  private:
+    // significant digits needed to round-trip the parameters
+    static constexpr int digits = std::numeric_limits<T>::max_digits10;
+    T mean_;
+    T stddev_;
+  };
+
+  /**
+   * Ctor.
+   *
+   * @param mean Distribution mean
+   * @param stddev Distribution standard deviation, must be positive
+   */
+  explicit normal_ziggurat(T mean = 0, T stddev = 1) noexcept
+    : param_{mean, stddev}
+  {}
+
+  /**
+   * Ctor.
+   *
+   * @param param Distribution parameters
+   */
+  explicit normal_ziggurat(const param_type& param) noexcept : param_{param} {}
+
+  /**
+   * Return the distribution mean.
+   */
+  T mean() const noexcept { return param_.mean(); }
+
+  /**
+   * Return the distribution standard deviation.
+   */
+  T stddev() const noexcept { return param_.stddev(); }
+
+  /**
+   * Return the distribution parameters.
+   */
+  param_type param() const noexcept { return param_; }
+
+  /**
+   * Set the distribution parameters.
+   *
+   * @param param Distribution parameters
+   */
+  void param(const param_type& param) noexcept { param_ = param; }
+
+  /**
+   * Reset the distribution state, a no-op as no state is cached.
+   */
+  void reset() noexcept {}
+
+  /**
+   * Return the smallest value that can be generated.
+   */
+  static constexpr T min() noexcept
+  {
+    return std::numeric_limits<T>::lowest();
+  }
+
+  /**
+   * Return the largest value that can be generated.
+   */
+  static constexpr T max() noexcept
+  {
+    return std::numeric_limits<T>::max();
+  }
+
+  /**
+   * Draw a sample.
+   *
+   * @tparam Rng *UniformRandomBitGenerator* with 32 or 64-bit output
+   *
+   * @param rng PRNG instance
+   */
+  template <typename Rng>
+  T operator()(Rng& rng)
+  {
+    return (*this)(rng, param_);
+  }
+
+  /**
+   * Draw a sample using the given parameters.
+   *
+   * @tparam Rng *UniformRandomBitGenerator* with 32 or 64-bit output
+   *
+   * @param rng PRNG instance
+   * @param param Distribution parameters
+   */
+  template <typename Rng>
+  T operator()(Rng& rng, const param_type& param)
+  {
+    auto z = detail::normal_ziggurat_sample(rng, detail::random_word(rng));
+    return static_cast<T>(param.mean() + param.stddev() * z);
+  }
+
+  /**
+   * Write samples to an output range.
+   *
+   * @tparam Rng *UniformRandomBitGenerator* with 32 or 64-bit output
+   * @tparam OutputIt *LegacyOutputIterator*
+   *
+   * @param rng PRNG instance
+   * @param first Start of the output range
+   * @param n Number of samples
+   * @returns Iterator past the last sample written
+   */
+  template <typename Rng, typename OutputIt>
+  OutputIt fill(Rng& rng, OutputIt first, std::size_t n)
+  {
+    double mean = param_.mean();
+    double stddev = param_.stddev();
+    return detail::normal_ziggurat_fill(
+      rng,
+      first,
+      n,
+      [mean, stddev](double* x, std::size_t m)
+      {
+        for (std::size_t i = 0; i < m; i++)
+          x[i] = mean + stddev * x[i];
+      }
+    );
+  }
+
+  /**
+   * Check if two distributions are equal.
+   *
+   * Since no state is cached, distributions with equal parameters are equal.
+   */
+  friend bool
+  operator==(const normal_ziggurat& a, const normal_ziggurat& b) noexcept
+  {
+    return a.param_ == b.param_;
+  }
+
+  /**
+   * Check if two distributions are not equal.
+   */
+  friend bool
+  operator!=(const normal_ziggurat& a, const normal_ziggurat& b) noexcept
+  {
+    return !(a == b);
+  }
+
+  /**
+   * Write the distribution state, i.e. its parameters, to a stream.
+   */
+  template <typename CharT, typename Traits>
+  friend auto& operator<<(
+    std::basic_ostream<CharT, Traits>& out, const normal_ziggurat& dist)
+  {
+    return out << dist.param_;
+  }
+
+  /**
+   * Read the distribution state, i.e. its parameters, from a stream.
+   */
+  template <typename CharT, typename Traits>
+  friend auto& operator>>(
+    std::basic_istream<CharT, Traits>& in, normal_ziggurat& dist)
+  {
+    return in >> dist.param_;
+  }
+
+private:
+  param_type param_;
+};
+
+/**
+ * Exponential distribution sampled with the Ziggurat method.
+ *
+ * Satisfies *RandomNumberDistribution*, so it is a drop-in replacement for
+ * `std::exponential_distribution` wherever a distribution policy is accepted,
+ * with `fill` for bulk sampling.
+ *
+ * @tparam T Floating-point result type
+ */
+template <typename T = double>
+class exponential_ziggurat {
+public:
+  static_assert(std::is_floating_point_v<T>);
+  using result_type = T;
+
+  /**
+   * Distribution parameters.
+   */
+  class param_type {
+  public:
+    using distribution_type = exponential_ziggurat;
+
+    /**
+     * Ctor.
+     *
+     * @param lambda Rate parameter, must be positive
+     */
+    explicit param_type(T lambda = 1) noexcept : lambda_{lambda} {}
+
+    /**
+     * Return the rate parameter.
+     */
+    T lambda() const noexcept { return lambda_; }
+
+    /**
+     * Check if two sets of parameters are equal.
+     */
+    friend bool operator==(const param_type& a, const param_type& b) noexcept
+    {
+      return a.lambda_ == b.lambda_;
+    }
+
+    /**
+     * Check if two sets of parameters are not equal.
+     */
+    friend bool operator!=(const param_type& a, const param_type& b) noexcept
+    {
+      return !(a == b);
+    }
+
+    /**
+     * Write the parameters to a stream.
+     */
+    template <typename CharT, typename Traits>
+    friend auto&
+    operator<<(std::basic_ostream<CharT, Traits>& out, const param_type& param)
+    {
+      detail::ziggurat_ios_format format{out, digits};
+      return out << param.lambda_;
+    }
+
+    /**
+     * Read the parameters from a stream.
+     *
+     * On failure the parameters are unchanged and the stream failbit is set.
+     */
+    template <typename CharT, typename Traits>
+    friend auto&
+    operator>>(std::basic_istream<CharT, Traits>& in, param_type& param)
+    {
+      detail::ziggurat_ios_format format{in, digits};
+      T lambda;
+      if (in >> lambda)
+        param = param_type{lambda};
+      return in;
+    }
+
+  private:
+    // significant digits needed to round-trip the parameters
+    static constexpr int digits = std::numeric_limits<T>::max_digits10;
+    T lambda_;
+  };
+
+  /**
+   * Ctor.
+   *
+   * @param lambda Rate parameter, must be positive
+   */
+  explicit exponential_ziggurat(T lambda = 1) noexcept : param_{lambda} {}
+
+  /**
+   * Ctor.
+   *
+   * @param param Distribution parameters
+   */
+  explicit exponential_ziggurat(const param_type& param) noexcept
+    : param_{param}
+  {}
+
+  /**
+   * Return the rate parameter.
+   */
+  T lambda() const noexcept { return param_.lambda(); }
+
+  /**
+   * Return the distribution parameters.
+   */
+  param_type param() const noexcept { return param_; }
+
+  /**
+   * Set the distribution parameters.
+   *
+   * @param param Distribution parameters
+   */
+  void param(const param_type& param) noexcept { param_ = param; }
+
+  /**
+   * Reset the distribution state, a no-op as no state is cached.
+   */
+  void reset() noexcept {}
+
+  /**
+   * Return the smallest value that can be generated.
+   */
+  static constexpr T min() noexcept { return 0; }
+
+  /**
+   * Return the largest value that can be generated.
+   */
+  static constexpr T max() noexcept
+  {
+    return std::numeric_limits<T>::max();
+  }
+
+  /**
+   * Draw a sample.
+   *
+   * @tparam Rng *UniformRandomBitGenerator* with 32 or 64-bit output
+   *
+   * @param rng PRNG instance
+   */
+  template <typename Rng>
+  T operator()(Rng& rng)
+  {
+    return (*this)(rng, param_);
+  }
+
+  /**
+   * Draw a sample using the given parameters.
+   *
+   * @tparam Rng *UniformRandomBitGenerator* with 32 or 64-bit output
+   *
+   * @param rng PRNG instance
+   * @param param Distribution parameters
+   */
+  template <typename Rng>
+  T operator()(Rng& rng, const param_type& param)
+  {
+    auto z = detail::exponential_ziggurat_sample(rng, detail::random_word(rng));
+    return static_cast<T>(z / param.lambda());
+  }
+
+  /**
+   * Write samples to an output range.
+   *
+   * @tparam Rng *UniformRandomBitGenerator* with 32 or 64-bit output
+   * @tparam OutputIt *LegacyOutputIterator*
+   *
+   * @param rng PRNG instance
+   * @param first Start of the output range
+   * @param n Number of samples
+   * @returns Iterator past the last sample written
+   */
+  template <typename Rng, typename OutputIt>
+  OutputIt fill(Rng& rng, OutputIt first, std::size_t n)
+  {
+    double lambda = param_.lambda();
+    return detail::exponential_ziggurat_fill(
+      rng,
+      first,
+      n,
+      [lambda](double* x, std::size_t m)
+      {
+        for (std::size_t i = 0; i < m; i++)
+          x[i] /= lambda;
+      }
+    );
+  }
+
+  /**
+   * Check if two distributions are equal.
+   *
+   * Since no state is cached, distributions with equal parameters are equal.
+   */
+  friend bool operator==(
+    const exponential_ziggurat& a, const exponential_ziggurat& b) noexcept
+  {
+    return a.param_ == b.param_;
+  }
+
+  /**
+   * Check if two distributions are not equal.
+   */
+  friend bool operator!=(
+    const exponential_ziggurat& a, const exponential_ziggurat& b) noexcept
+  {
+    return !(a == b);
+  }
+
+  /**
+   * Write the distribution state, i.e. its parameters, to a stream.
+   */
+  template <typename CharT, typename Traits>
+  friend auto& operator<<(
+    std::basic_ostream<CharT, Traits>& out, const exponential_ziggurat& dist)
+  {
+    return out << dist.param_;
+  }
+
+  /**
+   * Read the distribution state, i.e. its parameters, from a stream.
+   */
+  template <typename CharT, typename Traits>
+  friend auto& operator>>(
+    std::basic_istream<CharT, Traits>& in, exponential_ziggurat& dist)
+  {
+    return in >> dist.param_;
+  }
+
+private:
+  param_type param_;
+};
+
+}  // namespace pdmpmt
+
+#endif  // PDMPMT_ZIGGURAT_HH_
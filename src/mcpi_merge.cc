@@ -0,0 +1,393 @@
+/**
+ * @file mcpi_merge.cc
+ * @author Derek Huang
+ * @brief C++ program to merge streams of partial pi count records
+ * @copyright MIT License
+ */
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "pdmpmt/mcpi.h"
+#include "pdmpmt/mcpi_merge.hh"
+#include "pdmpmt/mcpi_record.h"
+
+namespace {
+
+// program name and usage. the executable is named mcpi-merge
+const std::string program_name{"mcpi-merge"};
+const std::string program_usage{
+  "Usage: " + program_name + " [-h] [-q] [-v] [-R RUN]... [FILE...]\n"
+  "\n"
+  "Merge streams of binary partial count records, e.g. as written by\n"
+  "pdmpmt-mcpi -e, into a single estimate of pi. FILE can be a regular file,\n"
+  "a pipe, or - for standard input, which is read if no FILE is given.\n"
+  "\n"
+  "Regular files are memory-mapped and decoded in place, while pipes are\n"
+  "read concurrently as data arrives. Records whose sample ranges are\n"
+  "covered by ranges already merged for the same run are dropped. Records\n"
+  "that only partially overlap, e.g. from ranges emitted with different\n"
+  "chunk sizes, have their uncovered parts recounted if their run is given\n"
+  "with -R and are otherwise conflicts, which make the merge fail. Prints\n"
+  "the line \"<samples> <inside> <pi>\" each time the merged estimate\n"
+  "changes.\n"
+  "\n"
+  "Options:\n"
+  "  -h, --help        Print this usage\n"
+  "  -q, --quiet       Only print the final merged estimate\n"
+  "  -v, --verbose     Print record, drop, and run counts to standard error\n"
+  "  -R, --run RNG:SEED:JOBS:N_SAMPLES\n"
+  "                    Layout of a run as given to pdmpmt-mcpi, used to\n"
+  "                    recount partially overlapping records of the run"
+};
+
+/**
+ * Struct for program arguments.
+ */
+struct cli_options {
+  bool print_usage = false;
+  bool quiet = false;
+  bool verbose = false;
+  std::vector<pdmpmt_mcpi_run> runs;
+  std::vector<std::string> files;
+};
+
+/**
+ * Parse an unsigned integer field of a run layout.
+ *
+ * @tparam T Unsigned integral type
+ *
+ * @param value Parsed value
+ * @param arg Field string
+ * @returns `true` on success, `false` on error
+ */
+template <typename T>
+bool parse_unsigned(T& value, std::string_view arg)
+{
+  std::string str{arg};
+  char* end;
+  auto parsed = std::strtoull(str.c_str(), &end, 10);
+  if (str.empty() || *end || str[0] == '-')
+    return false;
+  if (parsed > std::numeric_limits<T>::max())
+    return false;
+  value = static_cast<T>(parsed);
+  return true;
+}
+
+/**
+ * Parse a run layout given as `RNG:SEED:JOBS:N_SAMPLES`.
+ *
+ * @param run Run layout to populate
+ * @param arg Run layout string
+ * @returns `true` on success, `false` on error
+ */
+bool parse_run(pdmpmt_mcpi_run& run, std::string_view arg)
+{
+  std::string_view fields[4];
+  for (unsigned int i = 0; i < 4u; i++) {
+    auto pos = arg.find(':');
+    if ((i < 3u) == (pos == std::string_view::npos))
+      return false;
+    fields[i] = arg.substr(0, pos);
+    arg.remove_prefix((i < 3u) ? pos + 1 : arg.size());
+  }
+  if (fields[0] == "mrg32k3a")
+    run.rng_type = PDMPMT_RNG_MRG32K3A;
+  else if (fields[0] == "mt19937")
+    run.rng_type = PDMPMT_RNG_MT19937;
+  else
+    return false;
+  return parse_unsigned(run.seed, fields[1]) &&
+    run.seed <= std::numeric_limits<unsigned int>::max() &&
+    parse_unsigned(run.n_jobs, fields[2]) &&
+    parse_unsigned(run.n_samples, fields[3]) && run.n_samples;
+}
+
+/**
+ * Parse incoming command-line arguments.
+ *
+ * @param opts Options struct to populate
+ * @param argc Argument count from `main`
+ * @param argv Argument vector from `main`
+ * @returns `true` on success, `false` on error
+ */
+bool parse_args(cli_options& opts, int argc, char* argv[])
+{
+  // iterate through arguments
+  for (int i = 1; i < argc; i++) {
+    // string view for convenience
+    std::string_view arg{argv[i]};
+    // help option (break early)
+    if (arg == "-h" || arg == "--help") {
+      opts.print_usage = true;
+      return true;
+    }
+    // quiet option
+    else if (arg == "-q" || arg == "--quiet")
+      opts.quiet = true;
+    // verbose option
+    else if (arg == "-v" || arg == "--verbose")
+      opts.verbose = true;
+    // run layout option
+    else if (arg == "-R" || arg == "--run") {
+      pdmpmt_mcpi_run run;
+      if (!parse_run(run, (++i < argc) ? argv[i] : "")) {
+        std::cerr << "Error: " << arg << " requires RNG:SEED:JOBS:N_SAMPLES" <<
+          std::endl;
+        return false;
+      }
+      opts.runs.push_back(run);
+    }
+    // input file, where - is standard input
+    else if (!arg.empty() && (arg[0] != '-' || arg == "-"))
+      opts.files.emplace_back(arg);
+    // unknown
+    else {
+      std::cerr << "Error: Unknown argument " << arg << ". Try " <<
+        program_name << " --help for usage" << std::endl;
+      return false;
+    }
+  }
+  if (opts.files.empty())
+    opts.files.emplace_back("-");
+  // done
+  return true;
+}
+
+/**
+ * Input stream being read.
+ */
+struct input {
+  std::string name;
+  int fd;
+  pdmpmt::mcpi_record_reader reader;
+};
+
+/**
+ * Merger that tracks if the estimate changed since it was last printed.
+ */
+class printing_merger {
+public:
+  /**
+   * Ctor.
+   *
+   * @param quiet `true` to only print the final estimate
+   */
+  explicit printing_merger(bool quiet) noexcept : quiet_{quiet} {}
+
+  /**
+   * Add a record.
+   *
+   * @param rec Record to add
+   */
+  void operator()(const pdmpmt_mcpi_record& rec)
+  {
+    changed_ = merger_.add(rec) || changed_;
+  }
+
+  /**
+   * Print the estimate if it changed since it was last printed.
+   */
+  void update()
+  {
+    if (!quiet_ && changed_)
+      print();
+  }
+
+  /**
+   * Print the final estimate unless it was already printed.
+   */
+  void finish()
+  {
+    if (quiet_ || changed_ || !printed_)
+      print();
+  }
+
+  /**
+   * Register a run layout so partially overlapping records can be clipped.
+   *
+   * @param run Run layout
+   */
+  void add_run(const pdmpmt_mcpi_run& run)
+  {
+    merger_.add_run(run);
+  }
+
+  /**
+   * Return the merger.
+   */
+  const auto& merger() const noexcept { return merger_; }
+
+private:
+  pdmpmt::mcpi_merger merger_;
+  bool quiet_;
+  bool changed_ = false;
+  bool printed_ = false;
+
+  /**
+   * Print the merged estimate.
+   */
+  void print()
+  {
+    std::cout << merger_.n_samples() << ' ' << merger_.n_inside() << ' ' <<
+      std::setprecision(17) << merger_.estimate() << std::endl;
+    changed_ = false;
+    printed_ = true;
+  }
+};
+
+/**
+ * Decode a regular file in place by mapping it into memory.
+ *
+ * @param in Input to read, closed on return
+ * @param size File size
+ * @param merger Merger to add records to
+ * @returns `true` on success, `false` on error
+ */
+bool read_mapped(input& in, std::size_t size, printing_merger& merger)
+{
+  bool ok = true;
+  // zero-length mappings are invalid
+  if (size) {
+    auto data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, in.fd, 0);
+    if (data == MAP_FAILED) {
+      std::cerr << "Error: Cannot map " << in.name << std::endl;
+      close(in.fd);
+      return false;
+    }
+    ok = in.reader.feed(static_cast<const unsigned char*>(data), size, merger);
+    munmap(data, size);
+  }
+  close(in.fd);
+  if (!ok || in.reader.n_pending()) {
+    std::cerr << "Error: Malformed or truncated records in " << in.name <<
+      std::endl;
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Read the given streams concurrently until all have ended.
+ *
+ * @param inputs Inputs to read, all closed on return
+ * @param merger Merger to add records to
+ * @returns `true` on success, `false` if any stream had an error
+ */
+bool read_polled(std::vector<input>& inputs, printing_merger& merger)
+{
+  bool ok = true;
+  std::vector<pollfd> fds(inputs.size());
+  for (std::size_t i = 0; i < inputs.size(); i++)
+    fds[i] = {inputs[i].fd, POLLIN, 0};
+  auto n_open = inputs.size();
+  std::vector<unsigned char> buf(1u << 16);
+  while (n_open) {
+    if (poll(fds.data(), fds.size(), -1) < 0) {
+      if (errno == EINTR)
+        continue;
+      std::cerr << "Error: poll failed" << std::endl;
+      return false;
+    }
+    for (std::size_t i = 0; i < fds.size(); i++) {
+      if (fds[i].fd < 0 || !fds[i].revents)
+        continue;
+      auto& in = inputs[i];
+      // descriptors are left blocking, as their open file description may be
+      // shared with other processes, but one read after poll does not block.
+      // EAGAIN is still possible if a descriptor was inherited non-blocking
+      auto n_read = read(in.fd, buf.data(), buf.size());
+      if (n_read < 0 && (errno == EAGAIN || errno == EINTR))
+        continue;
+      bool ended = n_read <= 0;
+      if (n_read > 0 && !in.reader.feed(buf.data(), n_read, merger)) {
+        std::cerr << "Error: Malformed records in " << in.name << std::endl;
+        ended = true;
+        ok = false;
+      }
+      else if (n_read < 0) {
+        std::cerr << "Error: Cannot read " << in.name << std::endl;
+        ok = false;
+      }
+      else if (!n_read && in.reader.n_pending()) {
+        std::cerr << "Error: Truncated record in " << in.name << std::endl;
+        ok = false;
+      }
+      if (ended) {
+        close(in.fd);
+        // negative descriptors are ignored by poll
+        fds[i].fd = -1;
+        n_open--;
+      }
+    }
+    merger.update();
+  }
+  return ok;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[])
+{
+  cli_options opts;
+  if (!parse_args(opts, argc, argv))
+    return EXIT_FAILURE;
+  if (opts.print_usage) {
+    std::cout << program_usage << std::endl;
+    return EXIT_SUCCESS;
+  }
+  bool ok = true;
+  printing_merger merger{opts.quiet};
+  for (const auto& run : opts.runs)
+    merger.add_run(run);
+  std::vector<input> streams;
+  for (const auto& name : opts.files) {
+    input in{name, (name == "-") ? STDIN_FILENO : open(name.c_str(), O_RDONLY)};
+    struct stat info;
+    if (in.fd < 0 || fstat(in.fd, &info)) {
+      std::cerr << "Error: Cannot open " << name << std::endl;
+      if (in.fd >= 0)
+        close(in.fd);
+      ok = false;
+      continue;
+    }
+    // regular files are decoded in place, everything else is polled
+    if (S_ISREG(info.st_mode)) {
+      ok = read_mapped(in, static_cast<std::size_t>(info.st_size), merger) &&
+        ok;
+      merger.update();
+    }
+    else {
+      streams.push_back(std::move(in));
+    }
+  }
+  ok = read_polled(streams, merger) && ok;
+  merger.finish();
+  const auto& m = merger.merger();
+  if (opts.verbose)
+    std::cerr << program_name << ": " << m.n_records() << " records, " <<
+      m.n_dropped() << " dropped, " << m.n_clipped() << " clipped, " <<
+      m.n_runs() << " runs" << std::endl;
+  // the estimate is missing the uncovered samples of conflicting records
+  if (m.n_conflicts()) {
+    std::cerr << "Error: " << m.n_conflicts() << " records partially " <<
+      "overlap merged ranges. Give their runs with -R to recount them" <<
+      std::endl;
+    ok = false;
+  }
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -13,60 +13,392 @@
 #include <prand.h>
 
 #include "pdmpmt/block.h"
+#include "pdmpmt/monitor.h"
 #include "pdmpmt/warnings.h"
+#include "mcpi_impl.h"
 
 #ifdef _OPENMP
 #include <omp.h>
 #endif  // _OPENMP
 
-/**
- * Helper function to create a new prand structure.
- *
- * @param type PRNG type
- * @param seed PRNG seed value
- */
-static prand_t *
-make_prand(prand_rng_enum type, uint64_t seed)
+// jump-ahead step of the estimator PRNGs. hardcoded since each PRNG only has
+// one stream, but kept so the estimators reproduce their original sequences
+#define PRAND_STEP (1 << 14)
+
+prand_t *
+pdmpmt_make_prand(prand_rng_enum type, uint64_t seed, uint64_t step)
 {
   int rng_err = 0;
-  // note: step is hardcoded since we only have one stream
-  prand_t *rng = prand_init(type, seed, 1u, (1 << 14), &rng_err);
-  // note: should we more comprehensively check for errors?
+  prand_t *rng = prand_init(type, seed, 1u, step, &rng_err);
   assert(!PRAND_IS_ERROR(rng_err) && "RNG creation must not error");
   return rng;
 }
 
+// number of samples drawn between publishing to the installed monitor
+#define PUBLISH_INTERVAL (1u << 16)
+
+/**
+ * Publish the counters of a job to a monitor.
+ *
+ * @param mon Monitor to publish to
+ * @param worker Worker slot index, i.e. the job index
+ * @param n_target Number of samples assigned to the job
+ * @param n_done Number of samples drawn so far
+ * @param n_inside Number of drawn samples in the unit circle
+ */
+static inline void
+publish_counts(
+  pdmpmt_monitor *mon,
+  unsigned int worker,
+  size_t n_target,
+  size_t n_done,
+  size_t n_inside)
+{
+  pdmpmt_monitor_counts counts;
+  counts.n_target = n_target;
+  counts.n_done = n_done;
+  counts.n_inside = n_inside;
+  pdmpmt_monitor_publish(mon, worker, &counts);
+}
+
+/**
+ * Draw a sample in [-1, 1] x [-1, 1], consuming two PRNG outputs.
+ *
+ * @param rng PRNG to draw from
+ * @param x Address to write the x coordinate to
+ * @param y Address to write the y coordinate to
+ */
+static inline void
+draw_point(prand_t *rng, double *x, double *y)
+{
+  *x = 2 * rng->get_double_pos(rng->state) - 1;
+  *y = 2 * rng->get_double_pos(rng->state) - 1;
+}
+
+/**
+ * Count drawn samples that fall in the unit circle, i.e. 2-norm <= 1.
+ *
+ * @param rng PRNG to draw from
+ * @param n_samples Number of samples to draw
+ */
+size_t
+pdmpmt_prand_count_inside(prand_t *rng, size_t n_samples)
+{
+  size_t n_inside = 0;
+  double x, y;
+  // raw loop avoids memory allocations
+  for (size_t i = 0; i < n_samples; i++) {
+    draw_point(rng, &x, &y);
+    if (x * x + y * y <= 1)
+      n_inside++;
+  }
+  return n_inside;
+}
+
 /**
  * Draw and count samples in [-1, 1] x [-1, 1] that fall in the unit circle.
  *
+ * If a monitor is given, progress is published every `PUBLISH_INTERVAL`
+ * samples. Otherwise the samples are drawn in a single block.
+ *
  * @param n_samples Number of samples to draw
  * @param rng_type PRNG type
  * @param seed Seed value for the PRNG
+ * @param mon Monitor to publish to, can be `NULL`
+ * @param worker Worker slot index to publish to
  */
-size_t
-pdmpmt_rng_unit_circle_samples(
+static size_t
+unit_circle_samples(
   size_t n_samples,
   pdmpmt_rng_type rng_type,
-  unsigned seed)
+  unsigned seed,
+  pdmpmt_monitor *mon,
+  unsigned int worker)
 {
   assert(n_samples && "n_samples must be positive");
   // initialize PRNG
-  prand_t *rng = make_prand(rng_type, seed);
+  prand_t *rng = pdmpmt_make_prand(rng_type, seed, PRAND_STEP);
   // count number of samples that fall in unit circle, i.e. 2-norm <= 1
   size_t n_inside = 0;
-  double x, y;
-  // raw loop avoids memory allocations
-  for (size_t i = 0; i < n_samples; i++) {
-    x = 2 * rng->get_double_pos(rng->state) - 1;
-    y = 2 * rng->get_double_pos(rng->state) - 1;
-    if (x * x + y * y <= 1)
-      n_inside++;
+  size_t n_block = mon ? PUBLISH_INTERVAL : n_samples;
+  if (mon)
+    publish_counts(mon, worker, n_samples, 0, 0);
+  for (size_t i = 0; i < n_samples; i += n_block) {
+    size_t n_end = (n_samples - i < n_block) ? n_samples : i + n_block;
+    n_inside += pdmpmt_prand_count_inside(rng, n_end - i);
+    if (mon)
+      publish_counts(mon, worker, n_samples, n_end, n_inside);
   }
   // free and return
   prand_destroy(rng);
   return n_inside;
 }
 
+/**
+ * Draw and count samples in [-1, 1] x [-1, 1] that fall in the unit circle.
+ *
+ * If a monitor is installed, progress is published to worker slot 0.
+ *
+ * @param n_samples Number of samples to draw
+ * @param rng_type PRNG type
+ * @param seed Seed value for the PRNG
+ */
+size_t
+pdmpmt_rng_unit_circle_samples(
+  size_t n_samples,
+  pdmpmt_rng_type rng_type,
+  unsigned seed)
+{
+  return unit_circle_samples(
+    n_samples, rng_type, seed, pdmpmt_monitor_installed(), 0
+  );
+}
+
+// coarse bits per coordinate used for the cell index, fine bits used to refine
+// the position inside a cell. with 8 + 22 bits |x|, |y| live on a lattice of
+// 2^30 midpoints per unit, so the exact integer test below fits in 63 bits
+#define CF_COARSE_BITS 8
+#define CF_FINE_BITS 22
+// number of cells along each axis of the [0, 1] x [0, 1] quadrant
+#define CF_N_CELLS (1u << CF_COARSE_BITS)
+// number of points classified per batch
+#define CF_BATCH 256
+
+/**
+ * Number of cells in each row of the quadrant entirely inside the unit circle.
+ *
+ * Cell (a, b) covers [a, a + 1] x [b, b + 1] in units of `1 / CF_N_CELLS` and
+ * is inside if `(a + 1)^2 + (b + 1)^2 <= CF_N_CELLS^2`, so the row limit is
+ * `isqrt(CF_N_CELLS^2 - (a + 1)^2)`.
+ */
+static const uint16_t cf_inner[CF_N_CELLS] = {
+  255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+  255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 254, 254,
+  254, 254, 254, 254, 254, 254, 254, 253, 253, 253, 253, 253,
+  253, 253, 253, 252, 252, 252, 252, 252, 252, 251, 251, 251,
+  251, 251, 250, 250, 250, 250, 250, 249, 249, 249, 249, 248,
+  248, 248, 248, 247, 247, 247, 247, 246, 246, 246, 245, 245,
+  245, 245, 244, 244, 244, 243, 243, 243, 242, 242, 242, 241,
+  241, 241, 240, 240, 240, 239, 239, 238, 238, 238, 237, 237,
+  236, 236, 236, 235, 235, 234, 234, 233, 233, 233, 232, 232,
+  231, 231, 230, 230, 229, 229, 228, 228, 227, 227, 226, 226,
+  225, 225, 224, 223, 223, 222, 222, 221, 221, 220, 219, 219,
+  218, 218, 217, 216, 216, 215, 214, 214, 213, 213, 212, 211,
+  210, 210, 209, 208, 208, 207, 206, 205, 205, 204, 203, 202,
+  202, 201, 200, 199, 199, 198, 197, 196, 195, 194, 194, 193,
+  192, 191, 190, 189, 188, 187, 186, 185, 184, 183, 183, 182,
+  181, 180, 179, 177, 176, 175, 174, 173, 172, 171, 170, 169,
+  168, 167, 165, 164, 163, 162, 161, 159, 158, 157, 155, 154,
+  153, 151, 150, 149, 147, 146, 144, 143, 142, 140, 138, 137,
+  135, 134, 132, 130, 129, 127, 125, 123, 122, 120, 118, 116,
+  114, 112, 110, 108, 106, 103, 101, 99, 96, 94, 91, 89,
+  86, 83, 80, 77, 74, 70, 67, 63, 59, 55, 50, 45,
+  39, 31, 22, 0,
+};
+
+/**
+ * Number of cells in each row of the quadrant not entirely outside the circle.
+ *
+ * Cell (a, b) is outside if `a^2 + b^2 >= CF_N_CELLS^2`, so the row limit is
+ * `isqrt(CF_N_CELLS^2 - a^2 - 1) + 1`. Cells in `[cf_inner[a], cf_outer[a])`
+ * straddle the boundary and must be refined with the fine bits.
+ */
+static const uint16_t cf_outer[CF_N_CELLS] = {
+  256, 256, 256, 256, 256, 256, 256, 256, 256, 256, 256, 256,
+  256, 256, 256, 256, 256, 256, 256, 256, 256, 256, 256, 255,
+  255, 255, 255, 255, 255, 255, 255, 255, 254, 254, 254, 254,
+  254, 254, 254, 254, 253, 253, 253, 253, 253, 253, 252, 252,
+  252, 252, 252, 251, 251, 251, 251, 251, 250, 250, 250, 250,
+  249, 249, 249, 249, 248, 248, 248, 248, 247, 247, 247, 246,
+  246, 246, 246, 245, 245, 245, 244, 244, 244, 243, 243, 243,
+  242, 242, 242, 241, 241, 241, 240, 240, 239, 239, 239, 238,
+  238, 237, 237, 237, 236, 236, 235, 235, 234, 234, 234, 233,
+  233, 232, 232, 231, 231, 230, 230, 229, 229, 228, 228, 227,
+  227, 226, 226, 225, 224, 224, 223, 223, 222, 222, 221, 220,
+  220, 219, 219, 218, 217, 217, 216, 215, 215, 214, 214, 213,
+  212, 211, 211, 210, 209, 209, 208, 207, 206, 206, 205, 204,
+  203, 203, 202, 201, 200, 200, 199, 198, 197, 196, 195, 195,
+  194, 193, 192, 191, 190, 189, 188, 187, 186, 185, 184, 184,
+  183, 182, 181, 180, 178, 177, 176, 175, 174, 173, 172, 171,
+  170, 169, 168, 166, 165, 164, 163, 162, 160, 159, 158, 156,
+  155, 154, 152, 151, 150, 148, 147, 145, 144, 143, 141, 139,
+  138, 136, 135, 133, 131, 130, 128, 126, 124, 123, 121, 119,
+  117, 115, 113, 111, 109, 107, 104, 102, 100, 97, 95, 92,
+  90, 87, 84, 81, 78, 75, 71, 68, 64, 60, 56, 51,
+  46, 40, 32, 23,
+};
+
+unsigned int
+pdmpmt_mcpi_cell_tables(const uint16_t **inner, const uint16_t **outer)
+{
+  *inner = cf_inner;
+  *outer = cf_outer;
+  return CF_N_CELLS;
+}
+
+/**
+ * Buffered source of uniform random bits drawn from a prand generator.
+ */
+typedef struct {
+  prand_t *rng;            // PRNG providing the bits
+  uint64_t buf;            // unconsumed bits
+  unsigned int n_buf;      // number of unconsumed bits
+  unsigned int word_bits;  // uniform bits per accepted draw
+  size_t n_drawn;          // total number of bits drawn from the PRNG
+} bit_stream;
+
+/**
+ * Initialize a bit stream for the given PRNG.
+ *
+ * MT19937 outputs 32 uniform bits per draw. MRG32k3a outputs values in
+ * [1, m1] where m1 = 2^32 - 209, so we keep 24 bits per draw and reject the
+ * draws above 255 * 2^24 (about 0.4%) to keep the bits exactly uniform.
+ *
+ * @param bits Bit stream to initialize
+ * @param rng PRNG providing the bits
+ */
+static void
+bit_stream_init(bit_stream *bits, prand_t *rng)
+{
+  bits->rng = rng;
+  bits->buf = 0;
+  bits->n_buf = 0;
+  bits->word_bits = (rng->type == PRAND_RNG_MT19937) ? 32u : 24u;
+  bits->n_drawn = 0;
+}
+
+/**
+ * Draw the next word of uniform bits from the PRNG.
+ *
+ * @param bits Bit stream
+ */
+static uint64_t
+bit_stream_draw(bit_stream *bits)
+{
+  uint64_t word;
+  if (bits->rng->type == PRAND_RNG_MT19937) {
+    word = bits->rng->get(bits->rng->state);
+    bits->n_drawn += 32;
+    return word;
+  }
+  // rejection keeps only the range that is a multiple of 2^24
+  do {
+    word = bits->rng->get(bits->rng->state) - 1;
+    bits->n_drawn += 32;
+  }
+  while (word >= (UINT64_C(255) << 24));
+  return word & UINT64_C(0xffffff);
+}
+
+/**
+ * Take the next `n` uniform bits from the bit stream.
+ *
+ * @param bits Bit stream
+ * @param n Number of bits to take, at most 32
+ */
+static inline uint64_t
+bit_stream_take(bit_stream *bits, unsigned int n)
+{
+  assert(n <= 32 && "at most 32 bits can be taken at once");
+  uint64_t value = 0;
+  unsigned int got = 0;
+  while (got < n) {
+    if (!bits->n_buf) {
+      bits->buf = bit_stream_draw(bits);
+      bits->n_buf = bits->word_bits;
+    }
+    unsigned int k = n - got;
+    if (k > bits->n_buf)
+      k = bits->n_buf;
+    value |= (bits->buf & ((UINT64_C(1) << k) - 1)) << got;
+    bits->buf >>= k;
+    bits->n_buf -= k;
+    got += k;
+  }
+  return value;
+}
+
+/**
+ * Draw and count samples in [-1, 1] x [-1, 1] that fall in the unit circle.
+ *
+ * Uses coarse-then-fine classification. By symmetry only |x|, |y| matter, so
+ * each point first draws a cell index in the quadrant from `CF_COARSE_BITS`
+ * bits per coordinate. Cells entirely inside or outside the circle are
+ * classified through the row limit tables, and only the few cells straddling
+ * the boundary draw `CF_FINE_BITS` more bits per coordinate for an exact
+ * integer test. The sampled distribution is exactly uniform over the lattice
+ * of cell midpoints while consuming ~16.3 (MT19937) or ~21.8 (MRG32k3a, which
+ * keeps only 24 of each 32-bit draw) instead of 64 random bits per sample.
+ *
+ * @param n_samples Number of samples to draw
+ * @param rng_type PRNG type
+ * @param seed Seed value for the PRNG
+ * @param n_bits Address to write number of random bits drawn to, can be `NULL`
+ */
+size_t
+pdmpmt_rng_unit_circle_samples_cf(
+  size_t n_samples,
+  pdmpmt_rng_type rng_type,
+  unsigned seed,
+  size_t *n_bits)
+{
+  assert(n_samples && "n_samples must be positive");
+  prand_t *rng = pdmpmt_make_prand(rng_type, seed, PRAND_STEP);
+  pdmpmt_monitor *mon = pdmpmt_monitor_installed();
+  if (mon)
+    publish_counts(mon, 0, n_samples, 0, 0);
+  bit_stream bits;
+  bit_stream_init(&bits, rng);
+  // cell indices and classes for the current batch
+  uint8_t ca[CF_BATCH], cb[CF_BATCH], cls[CF_BATCH];
+  // squared radius in units of half a lattice spacing
+  const uint64_t r2 = UINT64_C(1) << (2 * (CF_COARSE_BITS + CF_FINE_BITS + 1));
+  size_t n_inside = 0;
+  for (size_t i = 0; i < n_samples; i += CF_BATCH) {
+    size_t n_batch = n_samples - i;
+    if (n_batch > CF_BATCH)
+      n_batch = CF_BATCH;
+    // coarse cell indices, both coordinates from one 16-bit draw
+    for (size_t j = 0; j < n_batch; j++) {
+      uint64_t w = bit_stream_take(&bits, 2 * CF_COARSE_BITS);
+      ca[j] = (uint8_t) (w & (CF_N_CELLS - 1));
+      cb[j] = (uint8_t) (w >> CF_COARSE_BITS);
+    }
+    // branch-free table lookup, 3 if inside, 2 if boundary, 0 if outside.
+    // this loop has no dependencies between iterations and is vectorizable
+    size_t n_batch_inside = 0;
+    for (size_t j = 0; j < n_batch; j++) {
+      cls[j] = (uint8_t) (
+        (cb[j] < cf_inner[ca[j]]) | ((cb[j] < cf_outer[ca[j]]) << 1)
+      );
+      n_batch_inside += (cls[j] == 3);
+    }
+    n_inside += n_batch_inside;
+    // refine boundary cells with the exact lattice test
+    for (size_t j = 0; j < n_batch; j++) {
+      if (cls[j] != 2)
+        continue;
+      uint64_t x = ((uint64_t) ca[j] << CF_FINE_BITS) |
+        bit_stream_take(&bits, CF_FINE_BITS);
+      uint64_t y = ((uint64_t) cb[j] << CF_FINE_BITS) |
+        bit_stream_take(&bits, CF_FINE_BITS);
+      // midpoint of the fine lattice cell, in units of half a spacing
+      x = 2 * x + 1;
+      y = 2 * y + 1;
+      if (x * x + y * y <= r2)
+        n_inside++;
+    }
+    // batch size divides the publishing interval
+    size_t n_done = i + n_batch;
+    if (mon && (!(n_done % PUBLISH_INTERVAL) || n_done == n_samples))
+      publish_counts(mon, 0, n_samples, n_done, n_inside);
+  }
+  if (n_bits)
+    *n_bits = bits.n_drawn;
+  prand_destroy(rng);
+  return n_inside;
+}
+
 /**
  * Return a new block of `unsigned long` values usable as GSL PRNG seeds.
  *
@@ -84,7 +416,7 @@ pdmpmt_rng_generate_seeds(
   // allocate new block and seeded PRNG
   pdmpmt_block_ulong seeds = pdmpmt_block_ulong_alloc(n_seeds);
   assert(seeds.data && "block memory must be allocated");
-  prand_t *rng = make_prand(rng_type, seed);
+  prand_t *rng = pdmpmt_make_prand(rng_type, seed, PRAND_STEP);
   // fill block with PRNG values to use as seeds
   // FIXME: have a more mathematically appropriate way to handle the reduction
   // in type width from uint64_t to unsigned long for 32-bit systems
@@ -150,6 +482,224 @@ pdmpmt_mcpi_gather(
   return 4 * ((double) n_inside / n_total);
 }
 
+/**
+ * Return the job a sample belongs to and the sample's offset within the job.
+ *
+ * Jobs are assigned sample counts as in `pdmpmt_generate_sample_counts`, so
+ * the first `n_samples % n_jobs` jobs have one more sample than the rest.
+ *
+ * @param run Run layout
+ * @param index Global sample index
+ * @param job Address to write the job index to
+ * @param offset Address to write the offset of the sample within the job to
+ * @returns 0 on success, -1 if `index` is out of range
+ */
+int
+pdmpmt_mcpi_locate(
+  const pdmpmt_mcpi_run *run,
+  size_t index,
+  unsigned int *job,
+  size_t *offset)
+{
+  if (index >= run->n_samples)
+    return -1;
+  if (run->n_jobs == PDMPMT_MCPI_SERIAL_RUN) {
+    *job = 0;
+    *offset = index;
+    return 0;
+  }
+  size_t base_count = run->n_samples / run->n_jobs;
+  size_t n_rem = run->n_samples % run->n_jobs;
+  // samples of the first n_rem jobs, which have one extra sample each
+  size_t n_head = n_rem * (base_count + 1);
+  if (index < n_head) {
+    *job = (unsigned int) (index / (base_count + 1));
+    *offset = index % (base_count + 1);
+  }
+  else {
+    *job = (unsigned int) (n_rem + (index - n_head) / base_count);
+    *offset = (index - n_head) % base_count;
+  }
+  return 0;
+}
+
+/**
+ * Return the range of global sample indices belonging to a job.
+ *
+ * @param run Run layout
+ * @param job Job index, must be 0 for a serial run
+ * @param first Address to write the global index of the job's first sample to
+ * @param n Address to write the job's sample count to
+ * @returns 0 on success, -1 if `job` is out of range
+ */
+int
+pdmpmt_mcpi_job_range(
+  const pdmpmt_mcpi_run *run,
+  unsigned int job,
+  size_t *first,
+  size_t *n)
+{
+  if (run->n_jobs == PDMPMT_MCPI_SERIAL_RUN) {
+    if (job)
+      return -1;
+    *first = 0;
+    *n = run->n_samples;
+    return 0;
+  }
+  if (job >= run->n_jobs)
+    return -1;
+  size_t base_count = run->n_samples / run->n_jobs;
+  size_t n_rem = run->n_samples % run->n_jobs;
+  *first = job * base_count + ((job < n_rem) ? job : n_rem);
+  *n = base_count + (job < n_rem);
+  return 0;
+}
+
+/**
+ * Create a PRNG positioned at a sample of a job's stream.
+ *
+ * The job seed is the job-th output of the seed PRNG as drawn by
+ * `pdmpmt_rng_generate_seeds`, truncated to `unsigned` as it is when passed to
+ * the job. Both the seed and the sample are reached by jumping ahead, and
+ * since each sample consumes two outputs, sample `offset` is at `2 * offset`.
+ *
+ * @param run Run layout
+ * @param job Job index
+ * @param offset Offset of the sample within the job
+ * @returns New PRNG or `NULL` if jumping ahead fails
+ */
+static prand_t *
+make_job_prand(const pdmpmt_mcpi_run *run, unsigned int job, size_t offset)
+{
+  int rng_err = 0;
+  unsigned seed;
+  if (run->n_jobs == PDMPMT_MCPI_SERIAL_RUN)
+    seed = (unsigned) run->seed;
+  else {
+    prand_t *seed_rng = pdmpmt_make_prand(
+      run->rng_type, (unsigned) run->seed, PRAND_STEP
+    );
+    seed_rng->jump(seed_rng->state, job, &rng_err);
+    if (PRAND_IS_ERROR(rng_err)) {
+      prand_destroy(seed_rng);
+      return NULL;
+    }
+    seed = (unsigned) seed_rng->get(seed_rng->state);
+    prand_destroy(seed_rng);
+  }
+  prand_t *rng = pdmpmt_make_prand(run->rng_type, seed, PRAND_STEP);
+  rng->jump(rng->state, 2 * (uint64_t) offset, &rng_err);
+  if (PRAND_IS_ERROR(rng_err)) {
+    prand_destroy(rng);
+    return NULL;
+  }
+  return rng;
+}
+
+/**
+ * Recompute a single sample point of a run.
+ *
+ * @param run Run layout
+ * @param index Global sample index
+ * @param point Address to write the sample point to
+ * @returns 0 on success, -1 if `index` is out of range
+ */
+int
+pdmpmt_mcpi_sample_at(
+  const pdmpmt_mcpi_run *run,
+  size_t index,
+  pdmpmt_mcpi_point *point)
+{
+  unsigned int job;
+  size_t offset;
+  if (pdmpmt_mcpi_locate(run, index, &job, &offset))
+    return -1;
+  prand_t *rng = make_job_prand(run, job, offset);
+  if (!rng)
+    return -1;
+  draw_point(rng, &point->x, &point->y);
+  point->inside = point->x * point->x + point->y * point->y <= 1;
+  prand_destroy(rng);
+  return 0;
+}
+
+/**
+ * Recompute the unit circle count of a range on the calling thread.
+ *
+ * A fresh PRNG is jumped to the start of each job piece of the range.
+ *
+ * @param run Run layout
+ * @param first Global index of the first sample, must be in range
+ * @param n Number of samples, must not run past the end of the run
+ * @param n_inside Address to write the number of samples in the circle to
+ * @returns 0 on success, -1 if jumping ahead fails
+ */
+static int
+count_range(
+  const pdmpmt_mcpi_run *run,
+  size_t first,
+  size_t n,
+  size_t *n_inside)
+{
+  unsigned int job;
+  size_t offset, job_first, job_n;
+  *n_inside = 0;
+  while (n) {
+    pdmpmt_mcpi_locate(run, first, &job, &offset);
+    pdmpmt_mcpi_job_range(run, job, &job_first, &job_n);
+    size_t n_piece = (job_n - offset < n) ? job_n - offset : n;
+    prand_t *rng = make_job_prand(run, job, offset);
+    if (!rng)
+      return -1;
+    *n_inside += pdmpmt_prand_count_inside(rng, n_piece);
+    prand_destroy(rng);
+    first += n_piece;
+    n -= n_piece;
+  }
+  return 0;
+}
+
+/**
+ * Recompute the number of samples of a range that fall in the unit circle.
+ *
+ * @param run Run layout
+ * @param first Global index of the first sample
+ * @param n Number of samples
+ * @param n_inside Address to write the number of samples in the circle to
+ * @returns 0 on success, -1 if the range is out of range or if memory
+ *  allocation for the PRNG fails
+ */
+int
+pdmpmt_mcpi_count_range(
+  const pdmpmt_mcpi_run *run,
+  size_t first,
+  size_t n,
+  size_t *n_inside)
+{
+  if (first > run->n_samples || n > run->n_samples - first)
+    return -1;
+#ifdef _OPENMP
+  // one piece per thread, each starting with its own jump-ahead
+  int n_pieces = omp_get_max_threads();
+  size_t total = 0;
+  int status = 0;
+// for MSVC, since its OpenMP version is quite old (2.0), must use signed var
+  int i;
+  #pragma omp parallel for reduction(+:total) reduction(|:status)
+  for (i = 0; i < n_pieces; i++) {
+    size_t lo = n / (size_t) n_pieces * (size_t) i;
+    size_t hi = (i == n_pieces - 1) ? n : n / (size_t) n_pieces * (i + 1);
+    size_t count;
+    status |= count_range(run, first + lo, hi - lo, &count);
+    total += count;
+  }
+  *n_inside = total;
+  return (status) ? -1 : 0;
+#else
+  return count_range(run, first, n, n_inside);
+#endif  // !_OPENMP
+}
+
 #ifdef _OPENMP
 /**
  * Parallel estimation of pi through Monte Carlo by using OpenMP directives.
@@ -181,6 +731,8 @@ pdmpmt_rng_smcpi_ompm(
   sample_counts = pdmpmt_generate_sample_counts(n_samples, n_threads);
   // compute circle counts with OpenMP
   pdmpmt_block_ulong circle_counts = pdmpmt_block_ulong_alloc(n_threads);
+  // each job publishes to the slot matching its index if a monitor is present
+  pdmpmt_monitor *mon = pdmpmt_monitor_installed();
 // for MSVC, since its OpenMP version is quite old (2.0), must use signed var.
 // furthermore, unlike when compiling C++ code, cannot use C99-style loop, even
 // with C11 language specification (/std:c11) passed to compiler
@@ -196,8 +748,8 @@ PDMPMT_MSVC_WARNING_PUSH()
 PDMPMT_MSVC_WARNING_DISABLE(4018 4267)
   #pragma omp parallel for
   for (i = 0; i < n_threads; i++) {
-    circle_counts.data[i] = pdmpmt_rng_unit_circle_samples(
-      sample_counts.data[i], rng_type, seeds.data[i]
+    circle_counts.data[i] = unit_circle_samples(
+      sample_counts.data[i], rng_type, seeds.data[i], mon, (unsigned int) i
     );
 PDMPMT_MSVC_WARNING_POP()
   }
@@ -0,0 +1,549 @@
+/**
+ * @file pdmpmt/mcpi_ci.c
+ * @author Derek Huang
+ * @brief C implementation for confidence intervals of chunked pi estimates
+ * @copyright MIT License
+ */
+
+#include "pdmpmt/mcpi_ci.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "pdmpmt/block.h"
+#include "pdmpmt/warnings.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif  // _OPENMP
+
+// MSVC only implements OpenMP 2.0, which has no simd construct
+#if defined(_OPENMP) && _OPENMP >= 201307L
+#define CI_HAS_OMP_SIMD 1
+#else
+#define CI_HAS_OMP_SIMD 0
+#endif  // !defined(_OPENMP) || _OPENMP < 201307L
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif  // M_PI
+
+/**
+ * Return the next value of a SplitMix64 PRNG and advance its state.
+ *
+ * Each resample seeds its own SplitMix64 stream so results do not depend on
+ * which thread draws which resample.
+ *
+ * @param state PRNG state
+ */
+static inline uint64_t
+splitmix64_next(uint64_t *state)
+{
+  uint64_t z = (*state += UINT64_C(0x9e3779b97f4a7c15));
+  z = (z ^ (z >> 30)) * UINT64_C(0xbf58476d1ce4e5b9);
+  z = (z ^ (z >> 27)) * UINT64_C(0x94d049bb133111eb);
+  return z ^ (z >> 31);
+}
+
+/**
+ * Return a uniform double in [0, 1) with 53 random bits.
+ *
+ * @param state PRNG state
+ */
+static inline double
+uniform01(uint64_t *state)
+{
+  return (double) (splitmix64_next(state) >> 11) * 0x1.0p-53;
+}
+
+/**
+ * Precomputed constants for drawing Poisson variates with a fixed mean.
+ *
+ * Small means use Knuth's multiplication method, large means use the PTRS
+ * transformed rejection method of Hormann (1993).
+ */
+typedef struct {
+  double mu;         // mean
+  double exp_neg;    // exp(-mu), small means only
+  double log_mu;     // log(mu)
+  double a;
+  double b;
+  double log_alpha;  // log(1 / alpha), i.e. -log(alpha)
+  double v_r;
+} poisson_params;
+
+// mean at and above which the PTRS method is used
+#define POISSON_PTRS_MIN 10.
+
+/**
+ * Initialize Poisson sampling constants for the given mean.
+ *
+ * @param params Constants to initialize
+ * @param mu Positive mean
+ */
+static void
+poisson_params_init(poisson_params *params, double mu)
+{
+  params->mu = mu;
+  params->exp_neg = exp(-mu);
+  params->log_mu = log(mu);
+  double b = 0.931 + 2.53 * sqrt(mu);
+  params->b = b;
+  params->a = -0.059 + 0.02483 * b;
+  params->log_alpha = log(1.1239 + 1.1328 / (b - 3.4));
+  params->v_r = 0.9277 - 3.6224 / (b - 2.);
+}
+
+/**
+ * Return the natural log of the factorial of a non-negative integer.
+ *
+ * Used instead of `lgamma`, which is not thread-safe as it writes `signgam`.
+ * Small values are tabulated and larger ones use the Stirling series, with
+ * relative error under 1e-13.
+ *
+ * @param k Non-negative integral value
+ */
+static double
+log_factorial(double k)
+{
+  // log(k!) for k = 0, ..., 9
+  static const double table[] = {
+    0., 0., 0.693147180559945, 1.7917594692280554, 3.178053830347945,
+    4.787491742782047, 6.579251212010102, 8.525161361065415,
+    10.604602902745249, 12.801827480081467
+  };
+  if (k < 10.)
+    return table[(int) k];
+  double x = k + 1.;
+  double x2 = 1. / (x * x);
+  // 0.5 * log(2 * pi) plus the series 1 / 12x - 1 / 360x^3 + ...
+  return (x - 0.5) * log(x) - x + 0.9189385332046727 +
+    (1. / 12. - x2 * (1. / 360. - x2 * (1. / 1260. - x2 / 1680.))) / x;
+}
+
+/**
+ * Draw a Poisson variate.
+ *
+ * @param params Sampling constants
+ * @param state PRNG state
+ */
+static uint64_t
+poisson_draw(const poisson_params *params, uint64_t *state)
+{
+  // multiplication method, taking mu + 1 uniforms on average
+  if (params->mu < POISSON_PTRS_MIN) {
+    uint64_t k = 0;
+    double prod = uniform01(state);
+    while (prod > params->exp_neg) {
+      k++;
+      prod *= uniform01(state);
+    }
+    return k;
+  }
+  // PTRS, accepting about 90% of candidates without evaluating log(k!)
+  while (1) {
+    double u = uniform01(state) - 0.5;
+    double v = uniform01(state);
+    double us = 0.5 - fabs(u);
+    double k = floor((2. * params->a / us + params->b) * u + params->mu + 0.43);
+    if (us >= 0.07 && v <= params->v_r)
+      return (uint64_t) k;
+    if (k < 0. || (us < 0.013 && v > us))
+      continue;
+    if (
+      log(v) + params->log_alpha - log(params->a / (us * us) + params->b) <=
+      -params->mu + k * params->log_mu - log_factorial(k)
+    )
+      return (uint64_t) k;
+  }
+}
+
+/**
+ * Return the standard normal quantile function value.
+ *
+ * Uses the rational approximation of Acklam, with relative error under
+ * 1.15e-9, which is far below the resolution of any Monte Carlo interval.
+ *
+ * @param p Probability in (0, 1)
+ */
+static double
+normal_quantile(double p)
+{
+  static const double a[] = {
+    -3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02,
+    1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00
+  };
+  static const double b[] = {
+    -5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02,
+    6.680131188771972e+01, -1.328068155288572e+01
+  };
+  static const double c[] = {
+    -7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+    -2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00
+  };
+  static const double d[] = {
+    7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00,
+    3.754408661907416e+00
+  };
+  const double p_low = 0.02425;
+  // lower and upper tails
+  if (p < p_low || p > 1. - p_low) {
+    double q = sqrt(-2. * log((p < p_low) ? p : 1. - p));
+    double x = (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q +
+      c[5]) / ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.);
+    return (p < p_low) ? x : -x;
+  }
+  // central region
+  double q = p - 0.5;
+  double r = q * q;
+  return (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) *
+    q / (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1.);
+}
+
+/**
+ * Return the Student's t quantile function value.
+ *
+ * Exact for 1 and 2 degrees of freedom, otherwise uses the Cornish-Fisher
+ * expansion in Abramowitz and Stegun 26.7.5 around the normal quantile.
+ *
+ * @param p Probability in (0, 1)
+ * @param dof Positive degrees of freedom
+ */
+static double
+t_quantile(double p, double dof)
+{
+  if (dof == 1.)
+    return tan(M_PI * (p - 0.5));
+  if (dof == 2.)
+    return (2. * p - 1.) / sqrt(2. * p * (1. - p));
+  double z = normal_quantile(p);
+  double z2 = z * z;
+  double g1 = z * (z2 + 1.) / 4.;
+  double g2 = z * ((5. * z2 + 16.) * z2 + 3.) / 96.;
+  double g3 = z * (((3. * z2 + 19.) * z2 + 17.) * z2 - 15.) / 384.;
+  double g4 =
+    z * ((((79. * z2 + 776.) * z2 + 1482.) * z2 - 1920.) * z2 - 945.) / 92160.;
+  return z + (g1 + (g2 + (g3 + g4 / dof) / dof) / dof) / dof;
+}
+
+/**
+ * Comparison function for sorting doubles with `qsort`.
+ */
+static int
+compare_double(const void *a, const void *b)
+{
+  double x = *(const double *) a;
+  double y = *(const double *) b;
+  return (x > y) - (x < y);
+}
+
+/**
+ * Return the linearly interpolated quantile of sorted values.
+ *
+ * @param values Sorted values
+ * @param n Number of values, must be positive
+ * @param q Quantile in [0, 1]
+ */
+static double
+sorted_quantile(const double *values, size_t n, double q)
+{
+  double pos = q * (double) (n - 1);
+  size_t i = (size_t) pos;
+  if (i + 1 >= n)
+    return values[n - 1];
+  return values[i] + (pos - (double) i) * (values[i + 1] - values[i]);
+}
+
+/**
+ * Summary statistics of the per-chunk counts.
+ */
+typedef struct {
+  uint64_t n_inside;
+  uint64_t n_total;
+} chunk_summary;
+
+/**
+ * Compute summary statistics of the per-chunk counts in a single pass.
+ *
+ * @param circle_counts Per-chunk counts of samples in unit circle
+ * @param sample_counts Per-chunk total sample counts
+ * @param n_chunks Number of chunks, must be positive
+ */
+static chunk_summary
+chunk_summary_compute(
+  const unsigned long *circle_counts,
+  const unsigned long *sample_counts,
+  size_t n_chunks)
+{
+  uint64_t n_inside = 0;
+  uint64_t n_total = 0;
+  // independent reductions over contiguous arrays vectorize well
+#if CI_HAS_OMP_SIMD
+  #pragma omp simd reduction(+: n_inside, n_total)
+#endif  // CI_HAS_OMP_SIMD
+  for (size_t i = 0; i < n_chunks; i++) {
+    n_inside += circle_counts[i];
+    n_total += sample_counts[i];
+  }
+  chunk_summary summary = {n_inside, n_total};
+  return summary;
+}
+
+/**
+ * Chunks with equal circle and sample counts, grouped for the bootstrap.
+ */
+typedef struct {
+  double *circle_counts;     // circle count of each group
+  double *sample_counts;     // sample count of each group
+  poisson_params *weights;   // weight distribution, mean is the group size
+  size_t n_groups;
+} chunk_groups;
+
+/**
+ * Circle and sample count pair of a chunk.
+ */
+typedef struct {
+  unsigned long n_circle;
+  unsigned long n_sample;
+} chunk_pair;
+
+/**
+ * Comparison function for sorting chunk pairs with `qsort`.
+ *
+ * Orders by sample count and then by circle count.
+ */
+static int
+compare_chunk_pair(const void *a, const void *b)
+{
+  const chunk_pair *x = (const chunk_pair *) a;
+  const chunk_pair *y = (const chunk_pair *) b;
+  if (x->n_sample != y->n_sample)
+    return (x->n_sample > y->n_sample) - (x->n_sample < y->n_sample);
+  return (x->n_circle > y->n_circle) - (x->n_circle < y->n_circle);
+}
+
+/**
+ * Free the arrays of the chunk groups.
+ *
+ * @param groups Groups to free
+ */
+static void
+chunk_groups_free(chunk_groups *groups)
+{
+  free(groups->circle_counts);
+  free(groups->sample_counts);
+  free(groups->weights);
+}
+
+/**
+ * Group chunks with equal circle and sample counts by sorting their pairs.
+ *
+ * There are never more groups than chunks, so grouping never increases the
+ * work per resample, and layouts whose sample counts differ by a few values,
+ * e.g. from `pdmpmt_generate_sample_counts`, still collapse to a few groups.
+ *
+ * @param groups Groups to fill
+ * @param circle_counts Per-chunk counts of samples in unit circle
+ * @param sample_counts Per-chunk total sample counts
+ * @param n_chunks Number of chunks, must be positive
+ * @returns 0 on success, -1 on memory allocation failure
+ */
+static int
+chunk_groups_init(
+  chunk_groups *groups,
+  const unsigned long *circle_counts,
+  const unsigned long *sample_counts,
+  size_t n_chunks)
+{
+  groups->n_groups = 0;
+  groups->circle_counts = malloc(n_chunks * sizeof *groups->circle_counts);
+  groups->sample_counts = malloc(n_chunks * sizeof *groups->sample_counts);
+  groups->weights = malloc(n_chunks * sizeof *groups->weights);
+  chunk_pair *pairs = malloc(n_chunks * sizeof *pairs);
+  if (
+    !groups->circle_counts || !groups->sample_counts || !groups->weights ||
+    !pairs
+  ) {
+    chunk_groups_free(groups);
+    free(pairs);
+    return -1;
+  }
+  for (size_t i = 0; i < n_chunks; i++) {
+    pairs[i].n_circle = circle_counts[i];
+    pairs[i].n_sample = sample_counts[i];
+  }
+  qsort(pairs, n_chunks, sizeof *pairs, compare_chunk_pair);
+  // each run of equal pairs becomes one group
+  for (size_t begin = 0, end; begin < n_chunks; begin = end) {
+    for (
+      end = begin + 1;
+      end < n_chunks && !compare_chunk_pair(pairs + begin, pairs + end);
+      end++
+    );
+    groups->circle_counts[groups->n_groups] = (double) pairs[begin].n_circle;
+    groups->sample_counts[groups->n_groups] = (double) pairs[begin].n_sample;
+    poisson_params_init(
+      groups->weights + groups->n_groups, (double) (end - begin)
+    );
+    groups->n_groups++;
+  }
+  free(pairs);
+  return 0;
+}
+
+/**
+ * Return the sum of values added in a fixed pairwise tree order.
+ *
+ * Like `tree_reduce` in `reduce.hh`, the result depends only on the values,
+ * not on how they were computed, e.g. on the number of threads.
+ *
+ * @param values Values to sum
+ * @param n Number of values
+ */
+static double
+tree_sum(const double *values, size_t n)
+{
+  if (!n)
+    return 0.;
+  if (n == 1)
+    return values[0];
+  return tree_sum(values, n / 2) + tree_sum(values + n / 2, n - n / 2);
+}
+
+int
+pdmpmt_mcpi_bootstrap_ci(
+  pdmpmt_block_ulong circle_counts,
+  pdmpmt_block_ulong sample_counts,
+  unsigned int n_resamples,
+  double level,
+  uint64_t seed,
+  pdmpmt_mcpi_ci *ci)
+{
+  assert(circle_counts.size && sample_counts.size);
+  assert(circle_counts.size == sample_counts.size);
+  assert(n_resamples && "n_resamples must be positive");
+  assert(level > 0. && level < 1. && "level must be in (0, 1)");
+  size_t n_chunks = circle_counts.size;
+  chunk_summary summary = chunk_summary_compute(
+    circle_counts.data, sample_counts.data, n_chunks
+  );
+  double p_hat = (double) summary.n_inside / (double) summary.n_total;
+  double *estimates = malloc(n_resamples * sizeof *estimates);
+  if (!estimates)
+    return -1;
+  // a sum of k Poisson(1) weights is Poisson(k), so equal chunks are grouped
+  chunk_groups groups;
+  if (
+    chunk_groups_init(
+      &groups, circle_counts.data, sample_counts.data, n_chunks
+    )
+  ) {
+    free(estimates);
+    return -1;
+  }
+// for MSVC, since its OpenMP version is quite old (2.0), must use signed var
+#ifdef _MSC_VER
+  int r;
+#else
+  unsigned int r;
+#endif  // _MSC_VER
+// MSVC complains about signed/unsigned mismatch in the loop condition
+PDMPMT_MSVC_WARNING_PUSH()
+PDMPMT_MSVC_WARNING_DISABLE(4018)
+  #pragma omp parallel for schedule(static)
+  for (r = 0; r < n_resamples; r++) {
+PDMPMT_MSVC_WARNING_POP()
+    // resample streams are decorrelated by SplitMix64 seeding
+    uint64_t state = seed ^ (UINT64_C(0xd1b54a32d192ed03) * ((uint64_t) r + 1));
+    double n_inside = 0.;
+    double n_total = 0.;
+    for (size_t g = 0; g < groups.n_groups; g++) {
+      double w = (double) poisson_draw(groups.weights + g, &state);
+      n_inside += w * groups.circle_counts[g];
+      n_total += w * groups.sample_counts[g];
+    }
+    // an empty resample has no estimate, which only happens for tiny inputs
+    estimates[r] = 4. * ((n_total > 0.) ? n_inside / n_total : p_hat);
+  }
+  chunk_groups_free(&groups);
+  // standard error is the standard deviation of the resample estimates
+  double mean = 0.;
+  for (unsigned int i = 0; i < n_resamples; i++)
+    mean += estimates[i];
+  mean /= n_resamples;
+  double ssd = 0.;
+  for (unsigned int i = 0; i < n_resamples; i++)
+    ssd += (estimates[i] - mean) * (estimates[i] - mean);
+  // percentile interval
+  qsort(estimates, n_resamples, sizeof *estimates, compare_double);
+  ci->estimate = 4. * p_hat;
+  ci->std_error = (n_resamples > 1) ? sqrt(ssd / (n_resamples - 1)) : 0.;
+  ci->lower = sorted_quantile(estimates, n_resamples, (1. - level) / 2.);
+  ci->upper = sorted_quantile(estimates, n_resamples, (1. + level) / 2.);
+  free(estimates);
+  return 0;
+}
+
+int
+pdmpmt_mcpi_batch_means_ci(
+  pdmpmt_block_ulong circle_counts,
+  pdmpmt_block_ulong sample_counts,
+  unsigned int n_batches,
+  double level,
+  pdmpmt_mcpi_ci *ci)
+{
+  assert(circle_counts.size && sample_counts.size);
+  assert(circle_counts.size == sample_counts.size);
+  assert(n_batches >= 2 && "n_batches must be at least 2");
+  assert(n_batches <= circle_counts.size && "n_batches must be <= n_chunks");
+  assert(level > 0. && level < 1. && "level must be in (0, 1)");
+  size_t n_chunks = circle_counts.size;
+  chunk_summary summary = chunk_summary_compute(
+    circle_counts.data, sample_counts.data, n_chunks
+  );
+  double p_hat = (double) summary.n_inside / (double) summary.n_total;
+  double mean_total = (double) summary.n_total / n_batches;
+  // squared weighted batch deviations from the overall estimate, i.e. the
+  // terms of the linearization variance of a ratio estimator. these are summed
+  // afterwards in a fixed order so the result does not depend on the threads
+  double *sq_devs = malloc(n_batches * sizeof *sq_devs);
+  if (!sq_devs)
+    return -1;
+#ifdef _MSC_VER
+  int b;
+#else
+  unsigned int b;
+#endif  // _MSC_VER
+PDMPMT_MSVC_WARNING_PUSH()
+PDMPMT_MSVC_WARNING_DISABLE(4018)
+  #pragma omp parallel for schedule(static)
+  for (b = 0; b < n_batches; b++) {
+PDMPMT_MSVC_WARNING_POP()
+    // chunks [begin, end) are split as evenly as possible over the batches
+    size_t begin = (size_t) b * n_chunks / n_batches;
+    size_t end = ((size_t) b + 1) * n_chunks / n_batches;
+    uint64_t n_inside = 0;
+    uint64_t n_total = 0;
+#if CI_HAS_OMP_SIMD
+    #pragma omp simd reduction(+: n_inside, n_total)
+#endif  // CI_HAS_OMP_SIMD
+    for (size_t i = begin; i < end; i++) {
+      n_inside += circle_counts.data[i];
+      n_total += sample_counts.data[i];
+    }
+    double dev = ((double) n_inside - p_hat * (double) n_total) / mean_total;
+    sq_devs[b] = dev * dev;
+  }
+  double ssd = tree_sum(sq_devs, n_batches);
+  free(sq_devs);
+  double std_error = 4. * sqrt(ssd / ((double) n_batches * (n_batches - 1)));
+  double half_width = t_quantile((1. + level) / 2., n_batches - 1.) * std_error;
+  ci->estimate = 4. * p_hat;
+  ci->std_error = std_error;
+  ci->lower = ci->estimate - half_width;
+  ci->upper = ci->estimate + half_width;
+  return 0;
+}
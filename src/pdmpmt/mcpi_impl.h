@@ -0,0 +1,41 @@
+/**
+ * @file pdmpmt/mcpi_impl.h
+ * @author Derek Huang
+ * @brief C header for internal helpers shared by the pi estimators
+ * @copyright MIT License
+ */
+
+#ifndef PDMPMT_MCPI_IMPL_H_
+#define PDMPMT_MCPI_IMPL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <prand.h>
+
+/**
+ * Create a new single-stream prand structure.
+ *
+ * The step is the jump-ahead distance precomputed for the stream. Estimators
+ * that never jump can pass 0 to skip computing the jump-ahead operator.
+ *
+ * @param type PRNG type
+ * @param seed PRNG seed value
+ * @param step Step size for jumping ahead
+ */
+prand_t *
+pdmpmt_make_prand(prand_rng_enum type, uint64_t seed, uint64_t step);
+
+/**
+ * Count drawn samples that fall in the unit circle, i.e. 2-norm <= 1.
+ *
+ * Each sample in [-1, 1] x [-1, 1] consumes two PRNG outputs, so estimators
+ * sharing this helper give bitwise-identical counts for the same PRNG state.
+ *
+ * @param rng PRNG to draw from
+ * @param n_samples Number of samples to draw
+ */
+size_t
+pdmpmt_prand_count_inside(prand_t *rng, size_t n_samples);
+
+#endif  // PDMPMT_MCPI_IMPL_H_
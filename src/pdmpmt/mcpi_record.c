@@ -0,0 +1,237 @@
+/**
+ * @file pdmpmt/mcpi_record.c
+ * @author Derek Huang
+ * @brief C source for streaming binary records of partial pi counts
+ * @copyright MIT License
+ */
+
+// write is not in strict ISO C
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif  // !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+
+#include "pdmpmt/mcpi_record.h"
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "pdmpmt/mcpi.h"
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif  // !defined(_WIN32)
+
+/**
+ * Mix a value into a hash state with the SplitMix64 finalizer.
+ *
+ * @param h Hash state
+ * @param value Value to mix in
+ */
+static inline uint64_t
+mix_u64(uint64_t h, uint64_t value)
+{
+  uint64_t z = h + value + UINT64_C(0x9e3779b97f4a7c15);
+  z = (z ^ (z >> 30)) * UINT64_C(0xbf58476d1ce4e5b9);
+  z = (z ^ (z >> 27)) * UINT64_C(0x94d049bb133111eb);
+  return z ^ (z >> 31);
+}
+
+/**
+ * Return an identifier for a run.
+ *
+ * @param run Run layout
+ */
+uint64_t
+pdmpmt_mcpi_run_id(const pdmpmt_mcpi_run *run)
+{
+  uint64_t h = 0;
+  h = mix_u64(h, (uint64_t) run->rng_type);
+  // the estimators only use the seed truncated to unsigned, so runs whose
+  // seeds agree after truncation are the same run
+  h = mix_u64(h, (uint64_t) (unsigned) run->seed);
+  h = mix_u64(h, (uint64_t) run->n_samples);
+  return mix_u64(h, (uint64_t) run->n_jobs);
+}
+
+/**
+ * Write a little-endian 32-bit value.
+ *
+ * @param buf Buffer to write 4 bytes to
+ * @param value Value to write
+ */
+static inline void
+store_u32(unsigned char *buf, uint32_t value)
+{
+  for (unsigned int i = 0; i < 4; i++)
+    buf[i] = (unsigned char) (value >> (8 * i));
+}
+
+/**
+ * Write a little-endian 64-bit value.
+ *
+ * @param buf Buffer to write 8 bytes to
+ * @param value Value to write
+ */
+static inline void
+store_u64(unsigned char *buf, uint64_t value)
+{
+  for (unsigned int i = 0; i < 8; i++)
+    buf[i] = (unsigned char) (value >> (8 * i));
+}
+
+/**
+ * Read a little-endian 32-bit value.
+ *
+ * @param buf Buffer to read 4 bytes from
+ */
+static inline uint32_t
+load_u32(const unsigned char *buf)
+{
+  uint32_t value = 0;
+  for (unsigned int i = 0; i < 4; i++)
+    value |= (uint32_t) buf[i] << (8 * i);
+  return value;
+}
+
+/**
+ * Read a little-endian 64-bit value.
+ *
+ * @param buf Buffer to read 8 bytes from
+ */
+static inline uint64_t
+load_u64(const unsigned char *buf)
+{
+  uint64_t value = 0;
+  for (unsigned int i = 0; i < 8; i++)
+    value |= (uint64_t) buf[i] << (8 * i);
+  return value;
+}
+
+/**
+ * Encode a record.
+ *
+ * @param rec Record to encode
+ * @param buf Buffer of at least `PDMPMT_MCPI_RECORD_SIZE` bytes to write to
+ */
+void
+pdmpmt_mcpi_record_encode(const pdmpmt_mcpi_record *rec, unsigned char *buf)
+{
+  store_u32(buf, PDMPMT_MCPI_RECORD_PAYLOAD_SIZE);
+  buf += PDMPMT_MCPI_RECORD_PREFIX_SIZE;
+  store_u64(buf, rec->run_id);
+  store_u64(buf + 8, rec->first);
+  store_u64(buf + 16, rec->n_samples);
+  store_u64(buf + 24, rec->n_inside);
+}
+
+/**
+ * Decode a record from the start of a buffer.
+ *
+ * @param buf Buffer to decode from
+ * @param size Number of bytes in the buffer
+ * @param rec Address to write the decoded record to
+ * @param n_read Address to write the number of bytes consumed to
+ * @returns 1 if a record was decoded, 0 if the buffer does not hold a whole
+ *  record yet, -1 if the length prefix is malformed
+ */
+int
+pdmpmt_mcpi_record_decode(
+  const unsigned char *buf,
+  size_t size,
+  pdmpmt_mcpi_record *rec,
+  size_t *n_read)
+{
+  if (size < PDMPMT_MCPI_RECORD_PREFIX_SIZE)
+    return 0;
+  uint32_t length = load_u32(buf);
+  if (
+    length < PDMPMT_MCPI_RECORD_PAYLOAD_SIZE ||
+    length > PDMPMT_MCPI_RECORD_MAX_PAYLOAD_SIZE
+  )
+    return -1;
+  if (size - PDMPMT_MCPI_RECORD_PREFIX_SIZE < length)
+    return 0;
+  buf += PDMPMT_MCPI_RECORD_PREFIX_SIZE;
+  rec->run_id = load_u64(buf);
+  rec->first = load_u64(buf + 8);
+  rec->n_samples = load_u64(buf + 16);
+  rec->n_inside = load_u64(buf + 24);
+  // any trailing payload bytes are from a newer version and are skipped
+  *n_read = PDMPMT_MCPI_RECORD_PREFIX_SIZE + length;
+  return 1;
+}
+
+/**
+ * Write a whole buffer to a file descriptor, retrying partial writes.
+ *
+ * @param fd File descriptor to write to
+ * @param buf Buffer to write
+ * @param size Number of bytes to write
+ * @returns 0 on success, -1 on error
+ */
+static int
+write_all(int fd, const unsigned char *buf, size_t size)
+{
+  while (size) {
+#if defined(_WIN32)
+    int n = _write(fd, buf, (unsigned int) size);
+#else
+    ssize_t n = write(fd, buf, size);
+#endif  // !defined(_WIN32)
+    if (n < 0) {
+      if (errno == EINTR)
+        continue;
+      return -1;
+    }
+    buf += n;
+    size -= (size_t) n;
+  }
+  return 0;
+}
+
+/**
+ * Compute the circle counts of a range of a run and write them as records.
+ *
+ * @param run Run layout
+ * @param first Global index of the first sample
+ * @param n Number of samples
+ * @param chunk_size Chunk size, must be positive
+ * @param fd File descriptor to write records to
+ * @returns 0 on success, -1 if the range is out of range, counting fails, or
+ *  writing fails
+ */
+int
+pdmpmt_mcpi_emit(
+  const pdmpmt_mcpi_run *run,
+  size_t first,
+  size_t n,
+  size_t chunk_size,
+  int fd)
+{
+  if (!chunk_size || first > run->n_samples || n > run->n_samples - first)
+    return -1;
+  unsigned char buf[PDMPMT_MCPI_RECORD_SIZE];
+  pdmpmt_mcpi_record rec;
+  rec.run_id = pdmpmt_mcpi_run_id(run);
+  size_t last = first + n;
+  while (first < last) {
+    // end the chunk at the next multiple of the chunk size
+    size_t chunk_end = (first / chunk_size + 1) * chunk_size;
+    if (chunk_end > last || chunk_end < first)
+      chunk_end = last;
+    size_t n_inside;
+    if (pdmpmt_mcpi_count_range(run, first, chunk_end - first, &n_inside))
+      return -1;
+    rec.first = first;
+    rec.n_samples = chunk_end - first;
+    rec.n_inside = n_inside;
+    pdmpmt_mcpi_record_encode(&rec, buf);
+    if (write_all(fd, buf, sizeof buf))
+      return -1;
+    first = chunk_end;
+  }
+  return 0;
+}
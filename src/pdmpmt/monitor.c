@@ -0,0 +1,356 @@
+/**
+ * @file pdmpmt/monitor.c
+ * @author Derek Huang
+ * @brief C source for publishing live run counters to shared memory
+ * @copyright MIT License
+ */
+
+// shm_open, ftruncate, etc. are not in strict ISO C
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif  // !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+
+#include "pdmpmt/monitor.h"
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pdmpmt/warnings.h"
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif  // WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif  // !defined(_WIN32)
+
+// MSVC only provides <stdatomic.h> for C with /experimental:c11atomics. the
+// __iso_volatile intrinsics are plain 64-bit accesses regardless of /volatile,
+// so ordering comes from the fences alone. x86/x64 do not reorder stores with
+// other stores or loads with other loads, so a compiler barrier suffices there,
+// while ARM64 needs a real barrier. other MSVC targets are not supported
+#if defined(_MSC_VER)
+#include <intrin.h>
+typedef volatile __int64 monitor_u64;
+#define MONITOR_STORE(p, v) __iso_volatile_store64(p, (__int64) (v))
+#define MONITOR_LOAD(p) ((uint64_t) __iso_volatile_load64(p))
+#define MONITOR_CAS(p, expected, desired) \
+  ((uint64_t) _InterlockedCompareExchange64( \
+    p, (__int64) (desired), (__int64) (expected) \
+  ) == (uint64_t) (expected))
+#if defined(_M_IX86) || defined(_M_X64)
+#define MONITOR_FENCE_RELEASE() _ReadWriteBarrier()
+#define MONITOR_FENCE_ACQUIRE() _ReadWriteBarrier()
+#elif defined(_M_ARM64)
+#define MONITOR_FENCE_RELEASE() __dmb(_ARM64_BARRIER_ISH)
+#define MONITOR_FENCE_ACQUIRE() __dmb(_ARM64_BARRIER_ISH)
+#else
+#error "monitor.c: unsupported MSVC target architecture"
+#endif  // !defined(_M_IX86) && !defined(_M_X64) && !defined(_M_ARM64)
+#else
+#include <stdatomic.h>
+typedef _Atomic uint64_t monitor_u64;
+#define MONITOR_STORE(p, v) atomic_store_explicit(p, v, memory_order_relaxed)
+#define MONITOR_LOAD(p) atomic_load_explicit(p, memory_order_relaxed)
+#define MONITOR_CAS(p, expected, desired) \
+  atomic_compare_exchange_strong(p, &(uint64_t){expected}, desired)
+#define MONITOR_FENCE_RELEASE() atomic_thread_fence(memory_order_release)
+#define MONITOR_FENCE_ACQUIRE() atomic_thread_fence(memory_order_acquire)
+#endif  // !defined(_MSC_VER)
+
+// cache line size assumed for the slot layout
+#define MONITOR_CACHE_LINE 64
+// segment magic number ("PDMT") and layout version
+#define MONITOR_MAGIC UINT32_C(0x544d4450)
+#define MONITOR_VERSION UINT32_C(1)
+// maximum segment name length, including the leading slash
+#define MONITOR_NAME_MAX 256
+// attempts at reading a slot before reporting it as torn
+#define MONITOR_READ_TRIES 1024
+
+/**
+ * Segment header occupying the first cache line.
+ */
+typedef struct {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t n_workers;
+  char pad[MONITOR_CACHE_LINE - 3 * sizeof(uint32_t)];
+} monitor_header;
+
+/**
+ * Worker slot occupying one cache line, guarded by a sequence lock.
+ *
+ * The sequence number is odd while the worker is updating the counters.
+ */
+typedef struct {
+  monitor_u64 seq;
+  monitor_u64 n_target;
+  monitor_u64 n_done;
+  monitor_u64 n_inside;
+  char pad[MONITOR_CACHE_LINE - 4 * sizeof(monitor_u64)];
+} monitor_slot;
+
+// layout must not depend on the compiler since readers may be other programs
+typedef char monitor_header_size_check[
+  (sizeof(monitor_header) == MONITOR_CACHE_LINE) ? 1 : -1
+];
+typedef char monitor_slot_size_check[
+  (sizeof(monitor_slot) == MONITOR_CACHE_LINE) ? 1 : -1
+];
+
+struct pdmpmt_monitor {
+  monitor_header *header;       // mapped segment
+  monitor_slot *slots;          // worker slots following the header
+  size_t size;                  // mapped size in bytes
+  int owner;                    // nonzero if created, i.e. writable
+  char name[MONITOR_NAME_MAX];  // segment name passed to the OS
+#if defined(_WIN32)
+  HANDLE mapping;               // file mapping handle
+#endif  // defined(_WIN32)
+};
+
+// monitor the mcpi.h estimators publish to, stored as an integer like the
+// installed pool in stream_pool.c so that the atomic macros apply
+static monitor_u64 installed_monitor;
+
+/**
+ * Allocate a new monitor and fill in the OS segment name.
+ *
+ * @param name Segment name
+ * @returns New monitor with no mapping, `NULL` on error
+ */
+static pdmpmt_monitor *
+monitor_alloc(const char *name)
+{
+  size_t len = strlen(name);
+  if (!len || len + 2 > MONITOR_NAME_MAX)
+    return NULL;
+  pdmpmt_monitor *mon = calloc(1, sizeof(*mon));
+  if (!mon)
+    return NULL;
+#if defined(_WIN32)
+  // session-local namespace does not need SeCreateGlobalPrivilege
+  const char prefix[] = "Local\\";
+  if (len + sizeof(prefix) > MONITOR_NAME_MAX) {
+    free(mon);
+    return NULL;
+  }
+  memcpy(mon->name, prefix, sizeof(prefix) - 1);
+  memcpy(mon->name + sizeof(prefix) - 1, name, len);
+#else
+  // POSIX shared memory names must start with a slash
+  size_t offset = (name[0] == '/') ? 0 : 1;
+  mon->name[0] = '/';
+  memcpy(mon->name + offset, name, len);
+#endif  // !defined(_WIN32)
+  // calloc already zero-terminated the name
+  return mon;
+}
+
+pdmpmt_monitor *
+pdmpmt_monitor_create(const char *name, unsigned int n_workers)
+{
+  assert(n_workers && "n_workers must be positive");
+  pdmpmt_monitor *mon = monitor_alloc(name);
+  if (!mon)
+    return NULL;
+  mon->size = sizeof(monitor_header) + n_workers * sizeof(monitor_slot);
+  mon->owner = 1;
+#if defined(_WIN32)
+  mon->mapping = CreateFileMappingA(
+    INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, (DWORD) mon->size, mon->name
+  );
+  if (!mon->mapping)
+    goto fail_alloc;
+  // a mapping another process still has open cannot be replaced and may have
+  // a different size, so fail instead of writing past the end of the view
+  if (GetLastError() == ERROR_ALREADY_EXISTS) {
+    CloseHandle(mon->mapping);
+    goto fail_alloc;
+  }
+  void *addr = MapViewOfFile(mon->mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+  if (!addr) {
+    CloseHandle(mon->mapping);
+    goto fail_alloc;
+  }
+#else
+  // replace any stale segment left behind by a crashed run
+  shm_unlink(mon->name);
+  int fd = shm_open(mon->name, O_RDWR | O_CREAT | O_EXCL, 0644);
+  if (fd < 0)
+    goto fail_alloc;
+  if (ftruncate(fd, (off_t) mon->size)) {
+    close(fd);
+    shm_unlink(mon->name);
+    goto fail_alloc;
+  }
+  void *addr = mmap(
+    NULL, mon->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0
+  );
+  close(fd);
+  if (addr == MAP_FAILED) {
+    shm_unlink(mon->name);
+    goto fail_alloc;
+  }
+#endif  // !defined(_WIN32)
+  mon->header = (monitor_header *) addr;
+  mon->slots = (monitor_slot *) (mon->header + 1);
+  mon->header->n_workers = n_workers;
+  mon->header->version = MONITOR_VERSION;
+  // readers check the magic last, so publish it after the rest of the header
+  MONITOR_FENCE_RELEASE();
+  mon->header->magic = MONITOR_MAGIC;
+  return mon;
+fail_alloc:
+  free(mon);
+  return NULL;
+}
+
+pdmpmt_monitor *
+pdmpmt_monitor_open(const char *name)
+{
+  pdmpmt_monitor *mon = monitor_alloc(name);
+  if (!mon)
+    return NULL;
+#if defined(_WIN32)
+  mon->mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, mon->name);
+  if (!mon->mapping)
+    goto fail_alloc;
+  void *addr = MapViewOfFile(mon->mapping, FILE_MAP_READ, 0, 0, 0);
+  if (!addr) {
+    CloseHandle(mon->mapping);
+    goto fail_alloc;
+  }
+  MEMORY_BASIC_INFORMATION info;
+  VirtualQuery(addr, &info, sizeof(info));
+  mon->size = info.RegionSize;
+#else
+  int fd = shm_open(mon->name, O_RDONLY, 0);
+  if (fd < 0)
+    goto fail_alloc;
+  struct stat st;
+  if (fstat(fd, &st) || (size_t) st.st_size < sizeof(monitor_header)) {
+    close(fd);
+    goto fail_alloc;
+  }
+  mon->size = (size_t) st.st_size;
+  void *addr = mmap(NULL, mon->size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED)
+    goto fail_alloc;
+#endif  // !defined(_WIN32)
+  mon->header = (monitor_header *) addr;
+  mon->slots = (monitor_slot *) (mon->header + 1);
+  // reject segments we did not create or that are too small for the slots
+  if (
+    mon->header->magic != MONITOR_MAGIC ||
+    mon->header->version != MONITOR_VERSION ||
+    mon->size <
+      sizeof(monitor_header) + mon->header->n_workers * sizeof(monitor_slot)
+  ) {
+    pdmpmt_monitor_close(mon);
+    return NULL;
+  }
+  return mon;
+fail_alloc:
+  free(mon);
+  return NULL;
+}
+
+void
+pdmpmt_monitor_close(pdmpmt_monitor *mon)
+{
+  if (!mon)
+    return;
+  // uninstall the monitor only if it is still installed
+  MONITOR_CAS(&installed_monitor, (uintptr_t) mon, 0u);
+#if defined(_WIN32)
+  UnmapViewOfFile(mon->header);
+  CloseHandle(mon->mapping);
+#else
+  munmap(mon->header, mon->size);
+  if (mon->owner)
+    shm_unlink(mon->name);
+#endif  // !defined(_WIN32)
+  free(mon);
+}
+
+unsigned int
+pdmpmt_monitor_n_workers(const pdmpmt_monitor *mon)
+{
+  return mon->header->n_workers;
+}
+
+void
+pdmpmt_monitor_publish(
+  pdmpmt_monitor *mon,
+  unsigned int worker,
+  const pdmpmt_monitor_counts *counts)
+{
+  assert(mon->owner && "read-only monitors cannot be published to");
+  if (worker >= mon->header->n_workers)
+    return;
+  monitor_slot *slot = mon->slots + worker;
+  // single writer, so the sequence number needs no read-modify-write
+  uint64_t seq = MONITOR_LOAD(&slot->seq);
+  MONITOR_STORE(&slot->seq, seq + 1);
+  MONITOR_FENCE_RELEASE();
+  MONITOR_STORE(&slot->n_target, counts->n_target);
+  MONITOR_STORE(&slot->n_done, counts->n_done);
+  MONITOR_STORE(&slot->n_inside, counts->n_inside);
+  MONITOR_FENCE_RELEASE();
+  MONITOR_STORE(&slot->seq, seq + 2);
+}
+
+int
+pdmpmt_monitor_read(
+  const pdmpmt_monitor *mon,
+  unsigned int worker,
+  pdmpmt_monitor_counts *counts)
+{
+  assert(worker < mon->header->n_workers && "worker index out of range");
+  monitor_slot *slot = mon->slots + worker;
+  // a writer that died mid-update leaves the sequence number odd forever, so
+  // give up after a bounded number of attempts instead of spinning
+  for (unsigned int i = 0; i < MONITOR_READ_TRIES; i++) {
+    uint64_t seq_begin = MONITOR_LOAD(&slot->seq);
+    MONITOR_FENCE_ACQUIRE();
+    pdmpmt_monitor_counts snap;
+    snap.n_target = MONITOR_LOAD(&slot->n_target);
+    snap.n_done = MONITOR_LOAD(&slot->n_done);
+    snap.n_inside = MONITOR_LOAD(&slot->n_inside);
+    MONITOR_FENCE_ACQUIRE();
+    uint64_t seq_end = MONITOR_LOAD(&slot->seq);
+    if (!(seq_begin & 1) && seq_begin == seq_end) {
+      *counts = snap;
+      return 0;
+    }
+  }
+  return -1;
+}
+
+void
+pdmpmt_monitor_install(pdmpmt_monitor *mon)
+{
+  assert((!mon || mon->owner) && "only created monitors can be installed");
+  // estimators only read the slots after loading the monitor
+  MONITOR_FENCE_RELEASE();
+  MONITOR_STORE(&installed_monitor, (uintptr_t) mon);
+}
+
+pdmpmt_monitor *
+pdmpmt_monitor_installed(void)
+{
+  uint64_t mon = MONITOR_LOAD(&installed_monitor);
+  MONITOR_FENCE_ACQUIRE();
+  return (pdmpmt_monitor *) (uintptr_t) mon;
+}
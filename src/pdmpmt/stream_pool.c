@@ -0,0 +1,620 @@
+/**
+ * @file pdmpmt/stream_pool.c
+ * @author Derek Huang
+ * @brief C source for a pool of disjoint PRNG streams leased by threads
+ * @copyright MIT License
+ */
+
+// pthreads are not in strict ISO C
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif  // !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+
+#include "pdmpmt/stream_pool.h"
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <prand.h>
+
+#include "pdmpmt/mcpi.h"
+#include "mcpi_impl.h"
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif  // WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#include <malloc.h>
+#else
+#include <pthread.h>
+#endif  // !defined(_WIN32)
+
+// MSVC only provides <stdatomic.h> for C with /experimental:c11atomics, so
+// the interlocked intrinsics are used instead. these are full barriers, while
+// loads are __iso_volatile accesses followed by an acquire fence, which is a
+// compiler barrier on x86/x64 and a real barrier on ARM64. like monitor.c,
+// other MSVC targets are not supported
+#if defined(_MSC_VER)
+#include <intrin.h>
+typedef volatile __int64 pool_u64;
+#if defined(_M_IX86) || defined(_M_X64)
+#define POOL_FENCE_ACQUIRE() _ReadWriteBarrier()
+#elif defined(_M_ARM64)
+#define POOL_FENCE_ACQUIRE() __dmb(_ARM64_BARRIER_ISH)
+#else
+#error "stream_pool.c: unsupported MSVC target architecture"
+#endif  // !defined(_M_IX86) && !defined(_M_X64) && !defined(_M_ARM64)
+#define POOL_LOAD(p) pool_load(p)
+#define POOL_STORE(p, v) ((void) _InterlockedExchange64(p, (__int64) (v)))
+#define POOL_FETCH_ADD(p, v) \
+  ((uint64_t) _InterlockedExchangeAdd64(p, (__int64) (v)))
+#define POOL_FETCH_SUB(p, v) \
+  ((uint64_t) _InterlockedExchangeAdd64(p, -(__int64) (v)))
+#else
+#include <stdatomic.h>
+typedef _Atomic uint64_t pool_u64;
+#define POOL_LOAD(p) atomic_load(p)
+#define POOL_STORE(p, v) atomic_store(p, v)
+#define POOL_FETCH_ADD(p, v) atomic_fetch_add(p, v)
+#define POOL_FETCH_SUB(p, v) atomic_fetch_sub(p, v)
+#endif  // !defined(_MSC_VER)
+
+#if defined(_MSC_VER)
+/**
+ * Atomically load a value with acquire semantics.
+ *
+ * @param p Address of the value
+ */
+static inline uint64_t
+pool_load(const pool_u64 *p)
+{
+  uint64_t value = (uint64_t) __iso_volatile_load64(p);
+  POOL_FENCE_ACQUIRE();
+  return value;
+}
+#endif  // _MSC_VER
+
+/**
+ * Atomically replace a value if it equals the expected value.
+ *
+ * @param p Address of the value
+ * @param expected Address of the expected value, updated on failure
+ * @param desired Value to store
+ * @returns Nonzero if the value was replaced
+ */
+static inline int
+pool_cas(pool_u64 *p, uint64_t *expected, uint64_t desired)
+{
+#if defined(_MSC_VER)
+  uint64_t old = (uint64_t) _InterlockedCompareExchange64(
+    p, (__int64) desired, (__int64) *expected
+  );
+  if (old == *expected)
+    return 1;
+  *expected = old;
+  return 0;
+#else
+  return atomic_compare_exchange_weak(p, expected, desired);
+#endif  // !defined(_MSC_VER)
+}
+
+// cache line size assumed for the slot layout
+#define POOL_CACHE_LINE 64
+// slot index of a lease that is not cached in a slot
+#define POOL_NO_SLOT UINT32_MAX
+// free list heads hold a 32-bit tag above the top slot index plus one, where
+// the tag is bumped on every update so that a stale head never compares equal
+#define POOL_INDEX_MASK UINT64_C(0xffffffff)
+
+/**
+ * Substream leased from a pool.
+ */
+struct pdmpmt_stream_lease {
+  prand_stream_t *node;  // stream node, sampling from the leased substream
+  uint64_t stream;       // index of the stream in the hierarchy
+  uint32_t slot;         // slot index or POOL_NO_SLOT
+  pool_u64 next;         // next slot index plus one in the free list
+};
+
+/**
+ * Pool slot padded to a cache line.
+ *
+ * Leases are used by different threads, so padding keeps the PRNG pointers
+ * and free list links of neighboring slots out of each other's cache lines.
+ * Slots are allocated with `slots_alloc` so that they are also aligned.
+ */
+typedef union {
+  struct pdmpmt_stream_lease lease;
+  char pad[POOL_CACHE_LINE];
+} pool_slot;
+
+/**
+ * Allocate zeroed slots aligned to a cache line.
+ *
+ * @param capacity Number of slots
+ * @returns Slots to release with `slots_free` or `NULL` on error
+ */
+static pool_slot *
+slots_alloc(unsigned int capacity)
+{
+  size_t size = capacity * sizeof(pool_slot);
+  // slots are a whole number of cache lines, as aligned_alloc requires
+#if defined(_WIN32)
+  pool_slot *slots = _aligned_malloc(size, POOL_CACHE_LINE);
+#else
+  pool_slot *slots = aligned_alloc(POOL_CACHE_LINE, size);
+#endif  // !defined(_WIN32)
+  if (slots)
+    memset(slots, 0, size);
+  return slots;
+}
+
+/**
+ * Release slots allocated with `slots_alloc`.
+ *
+ * @param slots Slots to release, can be `NULL`
+ */
+static void
+slots_free(pool_slot *slots)
+{
+#if defined(_WIN32)
+  _aligned_free(slots);
+#else
+  free(slots);
+#endif  // !defined(_WIN32)
+}
+
+/**
+ * Pool of pre-jumped, disjoint PRNG streams.
+ */
+struct pdmpmt_stream_pool {
+  prand_stream_t *root;      // root of the stream hierarchy
+  pool_slot *slots;          // cached streams
+  unsigned int capacity;     // number of slots
+  pool_u64 ready;            // free list of slots ready to be leased
+  pool_u64 stale;            // free list of slots to be moved ahead
+  pool_u64 n_ready;          // number of slots in the ready list
+  pool_u64 n_uncached;       // number of uncached streams created
+  pool_u64 n_returns;        // number of slots returned
+  pool_u64 waiting;          // nonzero if the refill thread may be sleeping
+  int stop;                  // nonzero if the refill thread should exit
+#if defined(_WIN32)
+  SRWLOCK lock;              // lock guarding the refill thread sleep
+  CONDITION_VARIABLE wake;   // condition the refill thread sleeps on
+  HANDLE thread;             // refill thread
+#else
+  pthread_mutex_t lock;      // lock guarding the refill thread sleep
+  pthread_cond_t wake;       // condition the refill thread sleeps on
+  pthread_t thread;          // refill thread
+#endif  // !defined(_WIN32)
+};
+
+// pool used by callers that do not manage their own, stored as an integer so
+// the same atomic operations can be used on it
+static pool_u64 installed_pool;
+
+/**
+ * Push a slot onto a free list.
+ *
+ * @param pool Pool owning the slot
+ * @param head Free list head
+ * @param slot Slot index
+ */
+static void
+slot_push(pdmpmt_stream_pool *pool, pool_u64 *head, uint32_t slot)
+{
+  uint64_t old = POOL_LOAD(head);
+  uint64_t desired;
+  do {
+    POOL_STORE(&pool->slots[slot].lease.next, old & POOL_INDEX_MASK);
+    desired = (((old >> 32) + 1) << 32) | ((uint64_t) slot + 1);
+  }
+  while (!pool_cas(head, &old, desired));
+}
+
+/**
+ * Pop a slot off a free list.
+ *
+ * A popped slot's link may be read after another thread has popped it, which
+ * is harmless since the tag makes the following exchange fail.
+ *
+ * @param pool Pool owning the slots
+ * @param head Free list head
+ * @returns Slot index or `POOL_NO_SLOT` if the list is empty
+ */
+static uint32_t
+slot_pop(pdmpmt_stream_pool *pool, pool_u64 *head)
+{
+  uint64_t old = POOL_LOAD(head);
+  uint64_t desired;
+  uint32_t slot;
+  do {
+    if (!(old & POOL_INDEX_MASK))
+      return POOL_NO_SLOT;
+    slot = (uint32_t) (old & POOL_INDEX_MASK) - 1;
+    desired = (((old >> 32) + 1) << 32) |
+      POOL_LOAD(&pool->slots[slot].lease.next);
+  }
+  while (!pool_cas(head, &old, desired));
+  return slot;
+}
+
+/**
+ * Move a lease to its next substream, splitting its stream off if needed.
+ *
+ * @param pool Pool owning the lease
+ * @param lease Lease to prepare
+ * @returns 0 on success, -1 on error
+ */
+static int
+lease_prepare(pdmpmt_stream_pool *pool, pdmpmt_stream_lease *lease)
+{
+  int rng_err = 0;
+  // streams start at their first substream
+  if (!lease->node) {
+    lease->node = prand_stream_split(pool->root, 1, lease->stream, &rng_err);
+    return (lease->node) ? 0 : -1;
+  }
+  prand_stream_next_substream(lease->node, &rng_err);
+  return PRAND_IS_ERROR(rng_err) ? -1 : 0;
+}
+
+/**
+ * Wait until a slot is returned or the pool is stopped.
+ *
+ * @param pool Pool
+ * @param n_seen Address of the number of returns already handled, updated
+ * @returns Nonzero if the pool is stopped
+ */
+static int
+refill_wait(pdmpmt_stream_pool *pool, uint64_t *n_seen)
+{
+  int stop;
+#if defined(_WIN32)
+  AcquireSRWLockExclusive(&pool->lock);
+#else
+  pthread_mutex_lock(&pool->lock);
+#endif  // !defined(_WIN32)
+  // returners check the flag after counting their return, so either the
+  // count below sees their return or they see the flag and signal
+  POOL_STORE(&pool->waiting, 1u);
+  while (!pool->stop && POOL_LOAD(&pool->n_returns) == *n_seen) {
+#if defined(_WIN32)
+    SleepConditionVariableSRW(&pool->wake, &pool->lock, INFINITE, 0);
+#else
+    pthread_cond_wait(&pool->wake, &pool->lock);
+#endif  // !defined(_WIN32)
+  }
+  POOL_STORE(&pool->waiting, 0u);
+  *n_seen = POOL_LOAD(&pool->n_returns);
+  stop = pool->stop;
+#if defined(_WIN32)
+  ReleaseSRWLockExclusive(&pool->lock);
+#else
+  pthread_mutex_unlock(&pool->lock);
+#endif  // !defined(_WIN32)
+  return stop;
+}
+
+/**
+ * Wake the refill thread.
+ *
+ * @param pool Pool
+ * @param stop Nonzero to also tell the refill thread to exit
+ */
+static void
+refill_wake(pdmpmt_stream_pool *pool, int stop)
+{
+#if defined(_WIN32)
+  AcquireSRWLockExclusive(&pool->lock);
+  pool->stop = pool->stop || stop;
+  WakeConditionVariable(&pool->wake);
+  ReleaseSRWLockExclusive(&pool->lock);
+#else
+  pthread_mutex_lock(&pool->lock);
+  pool->stop = pool->stop || stop;
+  pthread_cond_signal(&pool->wake);
+  pthread_mutex_unlock(&pool->lock);
+#endif  // !defined(_WIN32)
+}
+
+/**
+ * Refill thread main loop.
+ *
+ * Moves returned slots to their next substream and makes them ready, then
+ * sleeps until more slots are returned. On creation all slots are returned,
+ * so the first pass splits every cached stream off the root.
+ *
+ * @param arg Pool
+ */
+#if defined(_WIN32)
+static DWORD WINAPI
+#else
+static void *
+#endif  // !defined(_WIN32)
+refill_main(void *arg)
+{
+  pdmpmt_stream_pool *pool = (pdmpmt_stream_pool *) arg;
+  uint64_t n_seen = 0;
+  do {
+    uint32_t slot;
+    while ((slot = slot_pop(pool, &pool->stale)) != POOL_NO_SLOT) {
+      // on error the slot is left for the next return or a lessee to retry
+      if (lease_prepare(pool, &pool->slots[slot].lease)) {
+        slot_push(pool, &pool->stale, slot);
+        break;
+      }
+      POOL_FETCH_ADD(&pool->n_ready, 1u);
+      slot_push(pool, &pool->ready, slot);
+    }
+  }
+  while (!refill_wait(pool, &n_seen));
+#if defined(_WIN32)
+  return 0;
+#else
+  return NULL;
+#endif  // !defined(_WIN32)
+}
+
+/**
+ * Create a new stream pool and start its background refill thread.
+ *
+ * @param rng_type PRNG type
+ * @param seed Seed value for the root of the stream hierarchy
+ * @param capacity Number of cached streams, must be positive
+ * @returns New pool or `NULL` on error
+ */
+pdmpmt_stream_pool *
+pdmpmt_stream_pool_create(
+  pdmpmt_rng_type rng_type,
+  unsigned long seed,
+  unsigned int capacity)
+{
+  if (!capacity || capacity == POOL_NO_SLOT)
+    return NULL;
+  pdmpmt_stream_pool *pool = calloc(1, sizeof(*pool));
+  if (!pool)
+    return NULL;
+  int rng_err = 0;
+  pool->root = prand_stream_init(rng_type, seed, &rng_err);
+  pool->slots = slots_alloc(capacity);
+  if (!pool->root || !pool->slots) {
+    slots_free(pool->slots);
+    prand_stream_destroy(pool->root);
+    free(pool);
+    return NULL;
+  }
+  pool->capacity = capacity;
+  // uncached streams follow the cached ones
+  POOL_STORE(&pool->n_uncached, capacity);
+  // all slots start out stale with their stream not yet split off
+  for (unsigned int i = 0; i < capacity; i++) {
+    pool->slots[i].lease.stream = i;
+    pool->slots[i].lease.slot = i;
+    slot_push(pool, &pool->stale, capacity - 1 - i);
+  }
+#if defined(_WIN32)
+  InitializeSRWLock(&pool->lock);
+  InitializeConditionVariable(&pool->wake);
+  pool->thread = CreateThread(NULL, 0, refill_main, pool, 0, NULL);
+  if (!pool->thread) {
+#else
+  pthread_mutex_init(&pool->lock, NULL);
+  pthread_cond_init(&pool->wake, NULL);
+  if (pthread_create(&pool->thread, NULL, refill_main, pool)) {
+    pthread_cond_destroy(&pool->wake);
+    pthread_mutex_destroy(&pool->lock);
+#endif  // !defined(_WIN32)
+    slots_free(pool->slots);
+    prand_stream_destroy(pool->root);
+    free(pool);
+    return NULL;
+  }
+  return pool;
+}
+
+/**
+ * Stop the refill thread and release a pool.
+ *
+ * @param pool Pool to release
+ */
+void
+pdmpmt_stream_pool_destroy(pdmpmt_stream_pool *pool)
+{
+  if (!pool)
+    return;
+  // uninstall the pool only if it is still installed
+  uint64_t expected = (uint64_t) (uintptr_t) pool;
+  while (
+    !pool_cas(&installed_pool, &expected, 0u) &&
+    expected == (uint64_t) (uintptr_t) pool
+  );
+  refill_wake(pool, 1);
+#if defined(_WIN32)
+  WaitForSingleObject(pool->thread, INFINITE);
+  CloseHandle(pool->thread);
+#else
+  pthread_join(pool->thread, NULL);
+  pthread_cond_destroy(&pool->wake);
+  pthread_mutex_destroy(&pool->lock);
+#endif  // !defined(_WIN32)
+  for (unsigned int i = 0; i < pool->capacity; i++)
+    prand_stream_destroy(pool->slots[i].lease.node);
+  slots_free(pool->slots);
+  prand_stream_destroy(pool->root);
+  free(pool);
+}
+
+/**
+ * Return the number of cached streams of a pool.
+ *
+ * @param pool Pool
+ */
+unsigned int
+pdmpmt_stream_pool_capacity(const pdmpmt_stream_pool *pool)
+{
+  return pool->capacity;
+}
+
+/**
+ * Return the number of cached streams ready to be leased.
+ *
+ * @param pool Pool
+ */
+unsigned int
+pdmpmt_stream_pool_n_ready(const pdmpmt_stream_pool *pool)
+{
+  // counted before pushing and after popping so it never drops below zero
+  return (unsigned int) POOL_LOAD(&((pdmpmt_stream_pool *) pool)->n_ready);
+}
+
+/**
+ * Lease a substream from a pool.
+ *
+ * @param pool Pool to lease from
+ * @returns Leased substream or `NULL` if memory allocation fails
+ */
+pdmpmt_stream_lease *
+pdmpmt_stream_pool_lease(pdmpmt_stream_pool *pool)
+{
+  uint32_t slot = slot_pop(pool, &pool->ready);
+  if (slot != POOL_NO_SLOT) {
+    POOL_FETCH_SUB(&pool->n_ready, 1u);
+    return &pool->slots[slot].lease;
+  }
+  // refill is behind, so prepare a returned slot on the calling thread
+  slot = slot_pop(pool, &pool->stale);
+  if (slot != POOL_NO_SLOT) {
+    if (!lease_prepare(pool, &pool->slots[slot].lease))
+      return &pool->slots[slot].lease;
+    slot_push(pool, &pool->stale, slot);
+    return NULL;
+  }
+  // every slot is leased, so split off an uncached stream
+  pdmpmt_stream_lease *lease = calloc(1, sizeof(*lease));
+  if (!lease)
+    return NULL;
+  lease->stream = POOL_FETCH_ADD(&pool->n_uncached, 1u);
+  lease->slot = POOL_NO_SLOT;
+  if (lease_prepare(pool, lease)) {
+    free(lease);
+    return NULL;
+  }
+  return lease;
+}
+
+/**
+ * Return a lease to a pool.
+ *
+ * @param pool Pool the lease is from
+ * @param lease Lease to return
+ */
+void
+pdmpmt_stream_pool_return(pdmpmt_stream_pool *pool, pdmpmt_stream_lease *lease)
+{
+  if (lease->slot == POOL_NO_SLOT) {
+    prand_stream_destroy(lease->node);
+    free(lease);
+    return;
+  }
+  slot_push(pool, &pool->stale, lease->slot);
+  POOL_FETCH_ADD(&pool->n_returns, 1u);
+  // only take the lock if the refill thread may be sleeping
+  if (POOL_LOAD(&pool->waiting))
+    refill_wake(pool, 0);
+}
+
+/**
+ * Return the position of a leased substream in the stream hierarchy.
+ *
+ * @param lease Lease
+ * @param stream Address to write the stream index to
+ * @param substream Address to write the substream index to
+ */
+void
+pdmpmt_stream_lease_position(
+  const pdmpmt_stream_lease *lease,
+  uint64_t *stream,
+  uint64_t *substream)
+{
+  *stream = lease->stream;
+  *substream = lease->node->sub_index;
+}
+
+/**
+ * Fill a buffer with uniform values in (0, 1) drawn from a leased substream.
+ *
+ * @param lease Lease to draw from
+ * @param out Buffer to write to
+ * @param n Number of values to draw
+ */
+void
+pdmpmt_stream_lease_uniform(pdmpmt_stream_lease *lease, double *out, size_t n)
+{
+  prand_t *rng = lease->node->rng;
+  for (size_t i = 0; i < n; i++)
+    out[i] = rng->get_double_pos(rng->state);
+}
+
+/**
+ * Draw and count samples in [-1, 1] x [-1, 1] that fall in the unit circle.
+ *
+ * @param n_samples Number of samples to draw
+ * @param lease Lease to draw from
+ */
+size_t
+pdmpmt_stream_lease_unit_circle_samples(
+  size_t n_samples,
+  pdmpmt_stream_lease *lease)
+{
+  return pdmpmt_prand_count_inside(lease->node->rng, n_samples);
+}
+
+/**
+ * Estimate pi using Monte Carlo with a substream leased from a pool.
+ *
+ * @param n_samples Number of samples to use
+ * @param pool Pool to lease from, `NULL` for the installed pool
+ * @returns Estimate of pi, NaN on error
+ */
+double
+pdmpmt_stream_pool_mcpi(size_t n_samples, pdmpmt_stream_pool *pool)
+{
+  if (!n_samples)
+    return NAN;
+  if (!pool)
+    pool = pdmpmt_stream_pool_installed();
+  if (!pool)
+    return NAN;
+  pdmpmt_stream_lease *lease = pdmpmt_stream_pool_lease(pool);
+  if (!lease)
+    return NAN;
+  size_t n_inside = pdmpmt_stream_lease_unit_circle_samples(n_samples, lease);
+  pdmpmt_stream_pool_return(pool, lease);
+  return 4 * ((double) n_inside / n_samples);
+}
+
+/**
+ * Install a pool as the process-wide pool.
+ *
+ * @param pool Pool created with `pdmpmt_stream_pool_create`, `NULL` to
+ *  uninstall
+ */
+void
+pdmpmt_stream_pool_install(pdmpmt_stream_pool *pool)
+{
+  POOL_STORE(&installed_pool, (uintptr_t) pool);
+}
+
+/**
+ * Return the installed process-wide pool or `NULL` if there is none.
+ */
+pdmpmt_stream_pool *
+pdmpmt_stream_pool_installed(void)
+{
+  return (pdmpmt_stream_pool *) (uintptr_t) POOL_LOAD(&installed_pool);
+}
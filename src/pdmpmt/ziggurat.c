@@ -0,0 +1,758 @@
+/**
+ * @file pdmpmt/ziggurat.c
+ * @author Derek Huang
+ * @brief C implementation for bulk Ziggurat normal and exponential sampling
+ * @copyright MIT License
+ */
+
+#include "pdmpmt/ziggurat.h"
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <prand.h>
+
+#include "pdmpmt/mcpi.h"
+#include "mcpi_impl.h"
+
+// number of samples per block, sized so the buffers stay in L1 cache
+#define ZIG_BLOCK 256
+// start of the normal and exponential tails
+#define ZIG_NOR_R PDMPMT_ZIGGURAT_NORMAL_R
+#define ZIG_EXP_R PDMPMT_ZIGGURAT_EXPONENTIAL_R
+// normal magnitude bits, the other 12 bits being the layer index and sign
+#define ZIG_NOR_MASK ((UINT64_C(1) << 52) - 1)
+
+// tables generated with the tail start r and layer area v = r f(r) + the tail
+// area. the acceptance bounds k[i] are floor(2^b x[i - 1] / x[i]) with b = 52
+// (normal) or 53 (exponential) magnitude bits. k[1] is zero since the top
+// layer is all wedge, while k[0] and w[0] treat the base layer and tail as a
+// box of area v
+// normal layer tables
+static const pdmpmt_ziggurat_table zig_nor = {
+  // acceptance bounds
+  {
+    0x0ef33d8025ef64, 0x00000000000000, 0x0c08be98fbc661, 0x0da354fabd8128,
+    0x0e51f67ec1eedd, 0x0eb255e9d3f776, 0x0eef4b817ecab3, 0x0f19470afa44a7,
+    0x0f37ed61ffcb13, 0x0f4f4695612558, 0x0f61a5e41ba395, 0x0f707a755396a3,
+    0x0f7cb2ec284499, 0x0f86f10c6357d1, 0x0f8fa6578325dd, 0x0f9724c74dd0da,
+    0x0f9da907dbf507, 0x0fa360f581fa71, 0x0fa86fde5b4bf7, 0x0facf160d354db,
+    0x0fb0fb6718b90e, 0x0fb49f8d5374c5, 0x0fb7ec2366fe77, 0x0fbaece9a1e50c,
+    0x0fbdab9d040bee, 0x0fc03060ff6c57, 0x0fc2821037a248, 0x0fc4a67ae25bd1,
+    0x0fc6a2977aee2f, 0x0fc87aa92896a4, 0x0fca325e4bde85, 0x0fcbcce902231a,
+    0x0fcd4d12f839c4, 0x0fceb54d8fec99, 0x0fd007bf1dc930, 0x0fd1464dd6c4e5,
+    0x0fd272a8e2f450, 0x0fd38e4ff0c91e, 0x0fd49a9990b479, 0x0fd598b8920f53,
+    0x0fd689c08e99ec, 0x0fd76ea9c8e831, 0x0fd848547b08e8, 0x0fd9178bad2c8b,
+    0x0fd9dd07a7add2, 0x0fda9970105e8b, 0x0fdb4d5dc02e1f, 0x0fdbf95c5bfcd1,
+    0x0fdc9debb99a7d, 0x0fdd3b8118729d, 0x0fddd288342f90, 0x0fde6364369f63,
+    0x0fdeee708d514f, 0x0fdf7401a6b42e, 0x0fdff46599ed3f, 0x0fe06fe4bc24f2,
+    0x0fe0e6c225a259, 0x0fe1593c28b84c, 0x0fe1c78cbc3f99, 0x0fe231e9db1ca9,
+    0x0fe29885da1b92, 0x0fe2fb8fb54186, 0x0fe35b33558d4a, 0x0fe3b799d0002a,
+    0x0fe410e99ead7e, 0x0fe46746d47734, 0x0fe4bad34c095b, 0x0fe50baed29524,
+    0x0fe559f74ebc76, 0x0fe5a5c8e41211, 0x0fe5ef3e138689, 0x0fe6366fd91078,
+    0x0fe67b75c6d578, 0x0fe6be661e11aa, 0x0fe6ff55e5f4f2, 0x0fe73e5900a702,
+    0x0fe77b823e9e39, 0x0fe7b6e37070a1, 0x0fe7f08d774243, 0x0fe8289053f08c,
+    0x0fe85efb35173a, 0x0fe893dc840864, 0x0fe8c741f0cebc, 0x0fe8f9387d4ef6,
+    0x0fe929cc879b1d, 0x0fe95909d388eb, 0x0fe986fb939aa1, 0x0fe9b3ac714865,
+    0x0fe9df2694b6d5, 0x0fea0973abe67b, 0x0fea329cf166a4, 0x0fea5aab32952d,
+    0x0fea81a6d57419, 0x0feaa797de1cef, 0x0feacc85f3d91f, 0x0feaf07865e63c,
+    0x0feb13762fec12, 0x0feb3585fe2a4b, 0x0feb56ae3162b4, 0x0feb76f4e284f9,
+    0x0feb965fe62013, 0x0febb4f4cf9d7c, 0x0febd2b8f449cf, 0x0febefb16e2e3d,
+    0x0fec0be31ebde8, 0x0fec2752b15a14, 0x0fec42049dafd3, 0x0fec5bfd29f196,
+    0x0fec75406ceef4, 0x0fec8dd2500cb4, 0x0feca5b6911f10, 0x0fecbcf0c427fe,
+    0x0fecd38454fb15, 0x0fece97488c8b3, 0x0fecfec47f91b7, 0x0fed1377358528,
+    0x0fed278f844903, 0x0fed3b10242f4c, 0x0fed4dfbad586e, 0x0fed605498c3dd,
+    0x0fed721d414fe8, 0x0fed8357e4a982, 0x0fed9406a42cc8, 0x0feda42b85b704,
+    0x0fedb3c8746ab3, 0x0fedc2df416652, 0x0fedd171a46e52, 0x0feddf813c8ad3,
+    0x0feded0f90997f, 0x0fedfa1e0fd414, 0x0fee06ae124bc4, 0x0fee12c0d95a06,
+    0x0fee1e579006e0, 0x0fee29734b6524, 0x0fee34150ae4bb, 0x0fee3e3db89b3c,
+    0x0fee47ee2982f3, 0x0fee51271db086, 0x0fee59e9407f41, 0x0fee623528b42d,
+    0x0fee6a0b5897f1, 0x0fee716c3e077a, 0x0fee7858327b81, 0x0fee7ecf7b06b9,
+    0x0fee84d2484ab2, 0x0fee8a60b66343, 0x0fee8f7accc851, 0x0fee94207e25da,
+    0x0fee9851a829eb, 0x0fee9c0e13485b, 0x0fee9f557273f4, 0x0feea22762ccae,
+    0x0feea4836b42ab, 0x0feea668fc2d70, 0x0feea7d76ed6f9, 0x0feea8ce04fa0a,
+    0x0feea94be8333c, 0x0feea95029640f, 0x0feea8d9c0075e, 0x0feea7e7897654,
+    0x0feea678481d24, 0x0feea48aa29e83, 0x0feea21d22e4da, 0x0fee9f2e352025,
+    0x0fee9bbc26af2e, 0x0fee97c524f2e3, 0x0fee93473c0a39, 0x0fee8e40557515,
+    0x0fee88ae369c79, 0x0fee828e7f3dfd, 0x0fee7bdea7b888, 0x0fee749bff37ff,
+    0x0fee6cc3a9bd5e, 0x0fee64529e007f, 0x0fee5b45a32889, 0x0fee51994e57b6,
+    0x0fee474a0006cf, 0x0fee3c53e12c4f, 0x0fee30b2e02ad7, 0x0fee2462ad8204,
+    0x0fee175eb83c59, 0x0fee09a22a1447, 0x0fedfb27e349cb, 0x0fedebea76216c,
+    0x0feddbe422047d, 0x0fedcb0ece39d3, 0x0fedb964042cf4, 0x0feda6dce938c9,
+    0x0fed937237e98d, 0x0fed7f1c38a836, 0x0fed69d2b9c02b, 0x0fed538d06adff,
+    0x0fed3c41dea422, 0x0fed23e76a2fd7, 0x0fed0a732fe643, 0x0fecefda07fe34,
+    0x0fecd4100eb7b8, 0x0fecb708956eb4, 0x0fec98b61230c1, 0x0fec790a0da978,
+    0x0fec57f50f31fd, 0x0fec356686c961, 0x0fec114cb4b334, 0x0febeb948e6fd0,
+    0x0febc429a0b691, 0x0feb9af5ee0cdc, 0x0feb6fe1c98542, 0x0feb42d3ad1f9e,
+    0x0feb13b00b2d4b, 0x0feae2591a02e9, 0x0feaaeae992257, 0x0fea788d8ee326,
+    0x0fea3fcffd73e5, 0x0fea044c8dd9f6, 0x0fe9c5d62f563a, 0x0fe9843ba947a3,
+    0x0fe93f471d4729, 0x0fe8f6bd76c5d6, 0x0fe8aa5dc4e8e6, 0x0fe859e07ab1ea,
+    0x0fe804f690a940, 0x0fe7ab488233bf, 0x0fe74c751f6aa6, 0x0fe6e8102aa202,
+    0x0fe67da0b6abd8, 0x0fe60c9f38307e, 0x0fe5947338f742, 0x0fe51470977280,
+    0x0fe48bd436f458, 0x0fe3f9bffd1e37, 0x0fe35d35eeb19b, 0x0fe2b5122fe4fd,
+    0x0fe20003995557, 0x0fe13c82788314, 0x0fe068c4ee67af, 0x0fdf82b02b71a9,
+    0x0fde87c57efeaa, 0x0fdd7509c63bfd, 0x0fdc46e529bf13, 0x0fdaf8f82e0282,
+    0x0fd985e1b2ba75, 0x0fd7e6ef48cf03, 0x0fd613adbd650b, 0x0fd40149e2f011,
+    0x0fd1a1a7b4c7ac, 0x0fcee204761f9e, 0x0fcba8d85e11b1, 0x0fc7d26ecd2d23,
+    0x0fc32b2f1e22ed, 0x0fbd6581c0b83a, 0x0fb606c4005434, 0x0fac40582a2873,
+    0x0f9e971e014597, 0x0f89fa48a41dfb, 0x0f66c5f7f0302c, 0x0f1a5a4b331c4a
+  },
+  // widths
+  {
+    8.68362706080131701e-16, 4.77933017572754885e-17, 6.35435241740514521e-17,
+    7.45487048124761000e-17, 8.32936681579302947e-17, 9.06806040505942312e-17,
+    9.71486007656771254e-17, 1.02947503142409724e-16, 1.08234302884476445e-16,
+    1.13114701961089987e-16, 1.17663594570228891e-16, 1.21936172787143313e-16,
+    1.25974399146370607e-16, 1.29810998862640020e-16, 1.33472037368240932e-16,
+    1.36978648425711737e-16, 1.40348230012423574e-16, 1.43595294520569233e-16,
+    1.46732087423644022e-16, 1.49769046683910220e-16, 1.52715150035961856e-16,
+    1.55578181694607541e-16, 1.58364940092908755e-16, 1.61081401752749205e-16,
+    1.63732852039698433e-16, 1.66323990584208230e-16, 1.68859017086765841e-16,
+    1.71341701765596459e-16, 1.73775443658648495e-16, 1.76163319230009886e-16,
+    1.78508123169767199e-16, 1.80812402857991424e-16, 1.83078487648267428e-16,
+    1.85308513886180091e-16, 1.87504446393738743e-16, 1.89668097007747522e-16,
+    1.91801140648386124e-16, 1.93905129306250963e-16, 1.95981504266288145e-16,
+    1.98031606831281616e-16, 2.00056687762733177e-16, 2.02057915620716416e-16,
+    2.04036384154801995e-16, 2.05993118874036965e-16, 2.07929082904140074e-16,
+    2.09845182223703418e-16, 2.11742270357603345e-16, 2.13621152594498582e-16,
+    2.15482589785814482e-16, 2.17327301775643576e-16, 2.19155970504272610e-16,
+    2.20969242822353102e-16, 2.22767733047895436e-16, 2.24552025294143454e-16,
+    2.26322675592856688e-16, 2.28080213834501608e-16, 2.29825145544246691e-16,
+    2.31557953510407840e-16, 2.33279099280043364e-16, 2.34989024534709354e-16,
+    2.36688152357915791e-16, 2.38376888404542188e-16, 2.40055621981350381e-16,
+    2.41724727046750006e-16, 2.43384563137110089e-16, 2.45035476226149343e-16,
+    2.46677799523270350e-16, 2.48311854216108620e-16, 2.49937950162045193e-16,
+    2.51556386532965737e-16, 2.53167452417135778e-16, 2.54771427381694368e-16,
+    2.56368581998939585e-16, 2.57959178339286625e-16, 2.59543470433516922e-16,
+    2.61121704706701791e-16, 2.62694120385972417e-16, 2.64260949884118853e-16,
+    2.65822419160830582e-16, 2.67378748063236231e-16, 2.68930150647261493e-16,
+    2.70476835481199420e-16, 2.72019005932773108e-16, 2.73556860440867810e-16,
+    2.75090592773016566e-16, 2.76620392269638884e-16, 2.78146444075954262e-16,
+    2.79668929362422857e-16, 2.81188025534501926e-16, 2.82703906432447775e-16,
+    2.84216742521840459e-16, 2.85726701075459952e-16, 2.87233946347097797e-16,
+    2.88738639737847995e-16, 2.90240939955384036e-16, 2.91741003166694356e-16,
+    2.93238983144718016e-16, 2.94735031409293292e-16, 2.96229297362806451e-16,
+    2.97721928420902743e-16, 2.99213070138601159e-16, 3.00702866332132955e-16,
+    3.02191459196806053e-16, 3.03678989421180086e-16, 3.05165596297821824e-16,
+    3.06651417830895402e-16, 3.08136590840829668e-16, 3.09621251066292204e-16,
+    3.11105533263689248e-16, 3.12589571304399843e-16, 3.14073498269944617e-16,
+    3.15557446545280064e-16, 3.17041547910402853e-16, 3.18525933630440649e-16,
+    3.20010734544401138e-16, 3.21496081152744705e-16, 3.22982103703941558e-16,
+    3.24468932280169778e-16, 3.25956696882307838e-16, 3.27445527514370672e-16,
+    3.28935554267536968e-16, 3.30426907403912839e-16, 3.31919717440175234e-16,
+    3.33414115231237246e-16, 3.34910232054077845e-16, 3.36408199691876508e-16,
+    3.37908150518594980e-16, 3.39410217584148914e-16, 3.40914534700312604e-16,
+    3.42421236527501816e-16, 3.43930458662583134e-16, 3.45442337727858402e-16,
+    3.46957011461378353e-16, 3.48474618808741371e-16, 3.49995300016538100e-16,
+    3.51519196727607441e-16, 3.53046452078274009e-16, 3.54577210797743572e-16,
+    3.56111619309838843e-16, 3.57649825837265051e-16, 3.59191980508602995e-16,
+    3.60738235468235138e-16, 3.62288744989419152e-16, 3.63843665590734439e-16,
+    3.65403156156136996e-16, 3.66967378058870090e-16, 3.68536495289491352e-16,
+    3.70110674588289786e-16, 3.71690085582382199e-16, 3.73274900927794254e-16,
+    3.74865296456848721e-16, 3.76461451331202721e-16, 3.78063548200895890e-16,
+    3.79671773369794327e-16, 3.81286316967837640e-16, 3.82907373130524170e-16,
+    3.84535140186095759e-16, 3.86169820850914730e-16, 3.87811622433558475e-16,
+    3.89460757048192374e-16, 3.91117441837820296e-16, 3.92781899208053907e-16,
+    3.94454357072087416e-16, 3.96135049107613198e-16, 3.97824215026467914e-16,
+    3.99522100857856157e-16, 4.01228959246062612e-16, 4.02945049763632497e-16,
+    4.04670639241074699e-16, 4.06406002114224694e-16, 4.08151420790493479e-16,
+    4.09907186035326249e-16, 4.11673597380302126e-16, 4.13450963554423107e-16,
+    4.15239602940268292e-16, 4.17039844056831045e-16, 4.18852026071010687e-16,
+    4.20676499339901018e-16, 4.22513625986204444e-16, 4.24363780509307352e-16,
+    4.26227350434779415e-16, 4.28104737005311272e-16, 4.29996355916382885e-16,
+    4.31902638100262599e-16, 4.33824030562278785e-16, 4.35760997273684605e-16,
+    4.37714020125858451e-16, 4.39683599951051842e-16, 4.41670257615420053e-16,
+    4.43674535190656431e-16, 4.45696997211204011e-16, 4.47738232024753091e-16,
+    4.49798853244554672e-16, 4.51879501313005580e-16, 4.53980845187003105e-16,
+    4.56103584156741911e-16, 4.58248449810956371e-16, 4.60416208163114986e-16,
+    4.62607661954784272e-16, 4.64823653154320442e-16, 4.67065065671262862e-16,
+    4.69332828309332693e-16, 4.71627917983835031e-16, 4.73951363232586617e-16,
+    4.76304248053313639e-16, 4.78687716104872186e-16, 4.81102975314741622e-16,
+    4.83551302941152417e-16, 4.86034051145081097e-16, 4.88552653135360245e-16,
+    4.91108629959526857e-16, 4.93703598024033356e-16, 4.96339277440398627e-16,
+    4.99017501309182147e-16, 5.01740226071808946e-16, 5.04509543081872749e-16,
+    5.07327691573354108e-16, 5.10197073234156086e-16, 5.13120268630678275e-16,
+    5.16100055774322726e-16, 5.19139431175769761e-16, 5.22241633800023330e-16,
+    5.25410172417759535e-16, 5.28648856950494216e-16, 5.31961834533839742e-16,
+    5.35353631181649392e-16, 5.38829200133405024e-16, 5.42393978220170938e-16,
+    5.46053951907477745e-16, 5.49815735089281115e-16, 5.53686661246787305e-16,
+    5.57674893292657352e-16, 5.61789555355541370e-16, 5.66040892008242020e-16,
+    5.70440462129138711e-16, 5.75001376891989425e-16, 5.79738594572459266e-16,
+    5.84669289345547802e-16, 5.89813317647789844e-16, 5.95193814964144317e-16,
+    6.00837969627190734e-16, 6.06778040933344753e-16, 6.13052720872527962e-16,
+    6.19708989458162457e-16, 6.26804696330128242e-16, 6.34412240712750401e-16,
+    6.42623965954805442e-16, 6.51560331734499160e-16, 6.61382788509766218e-16,
+    6.72315046250558466e-16, 6.84680341756425679e-16, 6.98971833638761798e-16,
+    7.15999493483066224e-16, 7.37242430179879694e-16, 7.65893637080557177e-16,
+    8.11384933765648419e-16
+  },
+  // densities
+  {
+    1.00000000000000000e+00, 9.77101701267673373e-01, 9.59879091800108109e-01,
+    9.45198953442300871e-01, 9.32060075959231571e-01, 9.19991505039348012e-01,
+    9.08726440052131768e-01, 8.98095921898344307e-01, 8.87984660755834154e-01,
+    8.78309655808918066e-01, 8.69008688036857713e-01, 8.60033621196332199e-01,
+    8.51346258458678617e-01, 8.42915653112204843e-01, 8.34716292986884101e-01,
+    8.26726833946222039e-01, 8.18929191603702922e-01, 8.11307874312656718e-01,
+    8.03849483170964718e-01, 7.96542330422959299e-01, 7.89376143566024924e-01,
+    7.82341832654802727e-01, 7.75431304981187397e-01, 7.68637315798486487e-01,
+    7.61953346836795498e-01, 7.55373506507096448e-01, 7.48892447219157154e-01,
+    7.42505296340151388e-01, 7.36207598126862983e-01, 7.29995264561476453e-01,
+    7.23864533468630444e-01, 7.17811932630722183e-01, 7.11834248878248643e-01,
+    7.05928501332754532e-01, 7.00091918136511837e-01, 6.94321916126116934e-01,
+    6.88616083004672030e-01, 6.82972161644995079e-01, 6.77388036218773748e-01,
+    6.71861719897082432e-01, 6.66391343908750433e-01, 6.60975147776663441e-01,
+    6.55611470579697597e-01, 6.50298743110817035e-01, 6.45035480820822626e-01,
+    6.39820277453056807e-01, 6.34651799287623830e-01, 6.29528779924836912e-01,
+    6.24450015547026727e-01, 6.19414360605834546e-01, 6.14420723888914111e-01,
+    6.09468064925773656e-01, 6.04555390697467998e-01, 5.99681752619125596e-01,
+    5.94846243767987670e-01, 5.90047996332826230e-01, 5.85286179263371786e-01,
+    5.80559996100791453e-01, 5.75868682972354273e-01, 5.71211506735253782e-01,
+    5.66587763256165000e-01, 5.61996775814525118e-01, 5.57437893618766611e-01,
+    5.52910490425832957e-01, 5.48413963255266368e-01, 5.43947731190026706e-01,
+    5.39511234256952577e-01, 5.35103932380457947e-01, 5.30725304403662279e-01,
+    5.26374847171684590e-01, 5.22052074672321953e-01, 5.17756517229756463e-01,
+    5.13487720747327181e-01, 5.09245245995748164e-01, 5.05028667943468457e-01,
+    5.00837575126149126e-01, 4.96671569052490103e-01, 4.92530263643868815e-01,
+    4.88413284705458306e-01, 4.84320269426683603e-01, 4.80250865909047031e-01,
+    4.76204732719506141e-01, 4.72181538467730422e-01, 4.68180961405693874e-01,
+    4.64202689048174633e-01, 4.60246417812843200e-01, 4.56311852678716767e-01,
+    4.52398706861848965e-01, 4.48506701507203398e-01, 4.44635565395739785e-01,
+    4.40785034665804376e-01, 4.36954852547985995e-01, 4.33144769112652761e-01,
+    4.29354541029441927e-01, 4.25583931338022414e-01, 4.21832709229496339e-01,
+    4.18100649837848615e-01, 4.14387534040891625e-01, 4.10693148270188657e-01,
+    4.07017284329473761e-01, 4.03359739221114844e-01, 3.99720314980197555e-01,
+    3.96098818515832729e-01, 3.92495061459315842e-01, 3.88908860018788938e-01,
+    3.85340034840077450e-01, 3.81788410873393769e-01, 3.78253817245619295e-01,
+    3.74736087137891249e-01, 3.71235057668239554e-01, 3.67750569779032588e-01,
+    3.64282468129004056e-01, 3.60830600989648032e-01, 3.57394820145780501e-01,
+    3.53974980800076777e-01, 3.50570941481406106e-01, 3.47182563956793644e-01,
+    3.43809713146850715e-01, 3.40452257044521867e-01, 3.37110066637006045e-01,
+    3.33783015830718455e-01, 3.30470981379163586e-01, 3.27173842813601401e-01,
+    3.23891482376391093e-01, 3.20623784956905356e-01, 3.17370638029913610e-01,
+    3.14131931596337177e-01, 3.10907558126286510e-01, 3.07697412504292056e-01,
+    3.04501391976649993e-01, 3.01319396100803050e-01, 2.98151326696685481e-01,
+    2.94997087799961810e-01, 2.91856585617095210e-01, 2.88729728482182924e-01,
+    2.85616426815501756e-01, 2.82516593083707579e-01, 2.79430141761637940e-01,
+    2.76356989295668320e-01, 2.73297054068577072e-01, 2.70250256365875463e-01,
+    2.67216518343561471e-01, 2.64195763997261190e-01, 2.61187919132721214e-01,
+    2.58192911337619235e-01, 2.55210669954661962e-01, 2.52241126055942233e-01,
+    2.49284212418528578e-01, 2.46339863501263995e-01, 2.43408015422750479e-01,
+    2.40488605940500838e-01, 2.37581574431238340e-01, 2.34686861872330260e-01,
+    2.31804410824338891e-01, 2.28934165414680535e-01, 2.26076071322380528e-01,
+    2.23230075763917818e-01, 2.20396127480152332e-01, 2.17574176724331519e-01,
+    2.14764175251174000e-01, 2.11966076307030599e-01, 2.09179834621125493e-01,
+    2.06405406397881241e-01, 2.03642749310335436e-01, 2.00891822494657174e-01,
+    1.98152586545775666e-01, 1.95425003514134804e-01, 1.92709036903589648e-01,
+    1.90004651670465458e-01, 1.87311814223800804e-01, 1.84630492426799853e-01,
+    1.81960655599523125e-01, 1.79302274522848221e-01, 1.76655321443735552e-01,
+    1.74019770081839359e-01, 1.71395595637506504e-01, 1.68782774801212093e-01,
+    1.66181285764482628e-01, 1.63591108232366278e-01, 1.61012223437511648e-01,
+    1.58444614155924840e-01, 1.55888264724479753e-01, 1.53343161060263300e-01,
+    1.50809290681846148e-01, 1.48286642732574941e-01, 1.45775208005994417e-01,
+    1.43274978973513822e-01, 1.40785949814445061e-01, 1.38308116448551094e-01,
+    1.35841476571254116e-01, 1.33386029691669517e-01, 1.30941777173644719e-01,
+    1.28508722279999904e-01, 1.26086870220186276e-01, 1.23676228201596905e-01,
+    1.21276805484790626e-01, 1.18888613442910379e-01, 1.16511665625611230e-01,
+    1.14145977827838779e-01, 1.11791568163838437e-01, 1.09448457146812048e-01,
+    1.07116667774683996e-01, 1.04796225622487207e-01, 1.02487158941935344e-01,
+    1.00189498768810101e-01, 9.79032790388625895e-02, 9.56285367130090824e-02,
+    9.33653119126910958e-02, 9.11136480663738285e-02, 8.88735920682759695e-02,
+    8.66451944505581412e-02, 8.44285095703535410e-02, 8.22235958132029876e-02,
+    8.00305158146631529e-02, 7.78493367020961224e-02, 7.56801303589271779e-02,
+    7.35229737139813794e-02, 7.13779490588904719e-02, 6.92451443970068248e-02,
+    6.71246538277885663e-02, 6.50165779712429531e-02, 6.29210244377582245e-02,
+    6.08381083495400168e-02, 5.87679529209339246e-02, 5.67106901062030822e-02,
+    5.46664613248890943e-02, 5.26354182767923770e-02, 5.06177238609479413e-02,
+    4.86135532158686948e-02, 4.66230949019305271e-02, 4.46465522512946023e-02,
+    4.26841449164746117e-02, 4.07361106559410852e-02, 3.88027074045262377e-02,
+    3.68842156885674025e-02, 3.49809414617161737e-02, 3.30932194585786196e-02,
+    3.12214171919203282e-02, 2.93659397581333866e-02, 2.75272356696031478e-02,
+    2.57058040085489450e-02, 2.39022033057959098e-02, 2.21170627073088988e-02,
+    2.03510962300445380e-02, 1.86051212757246710e-02, 1.68800831525431870e-02,
+    1.51770883079353370e-02, 1.34974506017398899e-02, 1.18427578579079103e-02,
+    1.02149714397014868e-02, 8.61658276939874894e-03, 7.05087547137324151e-03,
+    5.52240329925101064e-03, 4.03797259336303744e-03, 2.60907274610216403e-03,
+    1.26028593049859797e-03
+  }
+};
+
+// exponential layer tables
+static const pdmpmt_ziggurat_table zig_exp = {
+  // acceptance bounds
+  {
+    0x1c5214272497c7, 0x00000000000000, 0x137d5bd79c3243, 0x186ef58e3f3c5b,
+    0x1a9bb7320eb0d6, 0x1bd127f7194492, 0x1c951d0f886528, 0x1d1bfe2d5c397c,
+    0x1d7e5bd56b18bc, 0x1dc934dd172c77, 0x1e0409dfac9dd0, 0x1e337b71d4783c,
+    0x1e5a8b177cb7a6, 0x1e7b42096f046e, 0x1e970daf08ae42, 0x1eaef5b14ef09f,
+    0x1ec3bd07b4655c, 0x1ed5f6f08799cf, 0x1ee614ae6e5689, 0x1ef46eca361cd0,
+    0x1f014b76ddd4a8, 0x1f0ce313a796b9, 0x1f176369f1f77d, 0x1f20f20c452571,
+    0x1f29ae1951a876, 0x1f31b18fb95533, 0x1f39125157c107, 0x1f3fe2eb6e694e,
+    0x1f463332d788fa, 0x1f4c10bf1d3a11, 0x1f51874c5c3324, 0x1f56a109c3ecc0,
+    0x1f5b66d9099998, 0x1f5fe08210d08d, 0x1f6414dd445771, 0x1f6809f685967a,
+    0x1f6bc52a2b02e8, 0x1f6f4b3d32e4f5, 0x1f72a07190f13b, 0x1f75c8974d09d8,
+    0x1f78c71b045cc1, 0x1f7b9f12413ff7, 0x1f7e5346079f8a, 0x1f80e63be21138,
+    0x1f835a3dad9162, 0x1f85b16056b915, 0x1f87ed89b24262, 0x1f8a10759374fc,
+    0x1f8c1bba3d39ad, 0x1f8e10cc45d04a, 0x1f8ff102013e17, 0x1f91bd968358e1,
+    0x1f9377ac47afd9, 0x1f95204f8b64dc, 0x1f96b878633893, 0x1f98410c968891,
+    0x1f99bae146ba82, 0x1f9b26bc697f00, 0x1f9c85561b717b, 0x1f9dd759cfd804,
+    0x1f9f1d6761a1cf, 0x1fa058140936c1, 0x1fa187eb3a333a, 0x1fa2ad6f6bc4fc,
+    0x1fa3c91ace0684, 0x1fa4db5fee6aa3, 0x1fa5e4aa4d097e, 0x1fa6e55ee46784,
+    0x1fa7dddca51ec5, 0x1fa8ce7ce6a876, 0x1fa9b793ce5ff0, 0x1faa9970adb85a,
+    0x1fab745e588233, 0x1fac48a3740585, 0x1fad1682bf9feb, 0x1fadde3b5782c1,
+    0x1faea008f21d6e, 0x1faf5c2418b07e, 0x1fb012c25b7a15, 0x1fb0c41681dff5,
+    0x1fb17050b6f1fc, 0x1fb2179eb2963b, 0x1fb2ba2bdfa84b, 0x1fb358217f4e19,
+    0x1fb3f1a6c9be0d, 0x1fb486e10cacd7, 0x1fb517f3c793fc, 0x1fb5a500c5fdaa,
+    0x1fb62e2837fe59, 0x1fb6b388c9010c, 0x1fb7353fb5079a, 0x1fb7b368dc7da9,
+    0x1fb82e1ed6ba0a, 0x1fb8a57b0347f6, 0x1fb919959a0f74, 0x1fb98a85ba7204,
+    0x1fb9f861796f26, 0x1fba633deee287, 0x1fbacb2f41ec17, 0x1fbb3048b49145,
+    0x1fbb929caea4e4, 0x1fbbf23cc8029e, 0x1fbc4f39d22996, 0x1fbca9a3e140d5,
+    0x1fbd018a548fa0, 0x1fbd56fbde729d, 0x1fbdaa068bd66c, 0x1fbdfab7cb3f42,
+    0x1fbe491c7364df, 0x1fbe9540c96960, 0x1fbedf3086b129, 0x1fbf26f6de6175,
+    0x1fbf6c9e828ae3, 0x1fbfb031a904c4, 0x1fbff1ba0ffdb2, 0x1fc03141024589,
+    0x1fc06ecf5b54b4, 0x1fc0aa6d8b1428, 0x1fc0e42399698b, 0x1fc11bf9298a65,
+    0x1fc151f57d1943, 0x1fc1861f770f4c, 0x1fc1b87d9e74b4, 0x1fc1e91620ea43,
+    0x1fc217eed505df, 0x1fc2450d3c8400, 0x1fc27076864fc2, 0x1fc29a2f906310,
+    0x1fc2c23ce98046, 0x1fc2e8a2d2c6b5, 0x1fc30d654122ee, 0x1fc33087de9c0f,
+    0x1fc3520e0b7ec8, 0x1fc371fadf66f8, 0x1fc390512a2887, 0x1fc3ad137497fa,
+    0x1fc3c844013349, 0x1fc3e1e4ccab40, 0x1fc3f9f78e4da9, 0x1fc4107db85061,
+    0x1fc4257877fd68, 0x1fc438e8b5bfc7, 0x1fc44acf15112b, 0x1fc45b2bf447e9,
+    0x1fc469ff6c4505, 0x1fc477495001b2, 0x1fc483092bfbba, 0x1fc48d3e457ff7,
+    0x1fc495e799d21c, 0x1fc49d03dd30b1, 0x1fc4a29179b434, 0x1fc4a68e8e07fc,
+    0x1fc4a8f8ebfb8d, 0x1fc4a9ce16ea9f, 0x1fc4a90b41fa36, 0x1fc4a6ad4e28a1,
+    0x1fc4a2b0c82e76, 0x1fc49d11e62de3, 0x1fc495cc852df4, 0x1fc48cdc265ec1,
+    0x1fc4823bec237a, 0x1fc475e696dee7, 0x1fc467d6817e83, 0x1fc458059dc038,
+    0x1fc4466d702e22, 0x1fc433070bcb9a, 0x1fc41dcb0d6e0e, 0x1fc406b196bbf7,
+    0x1fc3edb248cb62, 0x1fc3d2c43e593e, 0x1fc3b5de0591b5, 0x1fc396f599614d,
+    0x1fc376005a4594, 0x1fc352f3069372, 0x1fc32dc1b2281b, 0x1fc3065fbd7888,
+    0x1fc2dcbfcbf264, 0x1fc2b0d3b99fa0, 0x1fc2828c8ffcf0, 0x1fc251da79f164,
+    0x1fc21eacb6d39e, 0x1fc1e8f18c6757, 0x1fc1b09637bb3d, 0x1fc17586dccd0f,
+    0x1fc137ae74d6b8, 0x1fc0f6f6bb2416, 0x1fc0b348184da4, 0x1fc06c898baff1,
+    0x1fc022a092f365, 0x1fbfd5710f72ba, 0x1fbf84dd294890, 0x1fbf30c52fc60d,
+    0x1fbed907770cc6, 0x1fbe7d80327ddc, 0x1fbe1e094ba615, 0x1fbdba7a354408,
+    0x1fbd52a7b9f826, 0x1fbce663c6201b, 0x1fbc757d2c4de5, 0x1fbbffbf63b7aa,
+    0x1fbb84f23fe6a2, 0x1fbb04d9a0d18e, 0x1fba7f351a70ad, 0x1fb9f3bf92b61a,
+    0x1fb9622ed4abfc, 0x1fb8ca33174a18, 0x1fb82b76765b54, 0x1fb7859c5b895d,
+    0x1fb6d840d55594, 0x1fb622f7d96943, 0x1fb5654c6f37e2, 0x1fb49ebfbf69d3,
+    0x1fb3cec803e747, 0x1fb2f4cf539c40, 0x1fb21032442854, 0x1fb1203e5a9605,
+    0x1fb0243042e1c3, 0x1faf1b31c479a7, 0x1fae045767e106, 0x1facde9dbf2d73,
+    0x1faba8e640060b, 0x1faa61f399ff29, 0x1fa908656f66a2, 0x1fa79ab3508d3d,
+    0x1fa61726d1f213, 0x1fa47bd48bea00, 0x1fa2c693c5c095, 0x1fa0f4f47df316,
+    0x1f9f04336bbe0b, 0x1f9cf12b79f9bd, 0x1f9ab84415abc5, 0x1f98555b782fb9,
+    0x1f95c3abd03f7a, 0x1f92fda9cef1f3, 0x1f8ffcda9ae41d, 0x1f8cb99e7385f8,
+    0x1f892aec479608, 0x1f8545f904db90, 0x1f80fdc336039b, 0x1f7c427839e926,
+    0x1f7700a3582ace, 0x1f71200f1a241d, 0x1f6a8234b7352c, 0x1f630000a8e267,
+    0x1f5a66904fe3c6, 0x1f50724ece1173, 0x1f44c7665c6fdb, 0x1f36e5a38a59a4,
+    0x1f261434503409, 0x1f113e047b0414, 0x1ef6aefa57cbe7, 0x1ed38ca188151e,
+    0x1ea2a61e122db2, 0x1e5961c78b267d, 0x1dddf62bac0bb1, 0x1cdb4dd9e4e8c0
+  },
+  // widths
+  {
+    9.65574006320918495e-16, 7.08901424395587193e-18, 1.16394124966915612e-17,
+    1.52439151235324344e-17, 1.83328488572376734e-17, 2.10896510946450758e-17,
+    2.36112807784315792e-17, 2.59559577231091306e-17, 2.81617355419777021e-17,
+    3.02550413032139959e-17, 3.22550825483639130e-17, 3.41763234018504244e-17,
+    3.60299697873446790e-17, 3.78249077686966446e-17, 3.95683219809756741e-17,
+    4.12661177817596122e-17, 4.29232180844253857e-17, 4.45437774328238498e-17,
+    4.61313398148320011e-17, 4.76889572526465011e-17, 4.92192804372797579e-17,
+    5.07246290450315872e-17, 5.22070470279268283e-17, 5.36683466171820389e-17,
+    5.51101437283510581e-17, 5.65338867323967823e-17, 5.79408800485277771e-17,
+    5.93323036520895294e-17, 6.07092293284719067e-17, 6.20726343116320335e-17,
+    6.34234128030308637e-17, 6.47623857595615198e-17, 6.60903092576941510e-17,
+    6.74078816787273210e-17, 6.87157499118382354e-17, 7.00145147340394071e-17,
+    7.13047354966065327e-17, 7.25869342241465821e-17, 7.38615992138180063e-17,
+    7.51291882072373672e-17, 7.63901311955083442e-17, 7.76448329079785673e-17,
+    7.88936750272979918e-17, 8.01370181667546429e-17, 8.13752036404177207e-17,
+    8.26085550521004680e-17, 8.38373797253914924e-17, 8.50619699938533176e-17,
+    8.62826043678412162e-17, 8.74995485921619237e-17, 8.87130566069026214e-17,
+    8.99233714221536693e-17, 9.11307259159791903e-17, 9.23353435638179675e-17,
+    9.35374391064913757e-17, 9.47372191631295943e-17, 9.59348827945800718e-17,
+    9.71306220222153107e-17, 9.83246223064951999e-17, 9.95170629891508051e-17,
+    1.00708117702429579e-16, 1.01897954748469494e-16, 1.03086737451542282e-16,
+    1.04274624485618954e-16, 1.05461770179457727e-16, 1.06648324801191569e-16,
+    1.07834434824194948e-16, 1.09020243175835134e-16, 1.10205889470557897e-16,
+    1.11391510228619824e-16, 1.12577239081656823e-16, 1.13763206966168520e-16,
+    1.14949542305900979e-16, 1.16136371184021880e-16, 1.17323817505904628e-16,
+    1.18512003153267017e-16, 1.19701048130346565e-16, 1.20891070702738626e-16,
+    1.22082187529470664e-16, 1.23274513788841569e-16, 1.24468163298511302e-16,
+    1.25663248630289901e-16, 1.26859881220039828e-16, 1.28058171473075012e-16,
+    1.29258228865412005e-16, 1.30460162041202959e-16, 1.31664078906657332e-16,
+    1.32870086720738188e-16, 1.34078292182900042e-16, 1.35288801518117620e-16,
+    1.36501720559439851e-16, 1.37717154828288170e-16, 1.38935209612706441e-16,
+    1.40155990043757203e-16, 1.41379601170248568e-16, 1.42606148031966594e-16,
+    1.43835735731579092e-16, 1.45068469505368842e-16, 1.46304454792947646e-16,
+    1.47543797306095237e-16, 1.48786603096862656e-16, 1.50032978625073744e-16,
+    1.51283030825353992e-16, 1.52536867173812629e-16, 1.53794595754499743e-16,
+    1.55056325325757764e-16, 1.56322165386583800e-16, 1.57592226243117663e-16,
+    1.58866619075368440e-16, 1.60145456004291698e-16, 1.61428850159327891e-16,
+    1.62716915746513075e-16, 1.64009768117271844e-16, 1.65307523838003740e-16,
+    1.66610300760574231e-16, 1.67918218093822911e-16, 1.69231396476202251e-16,
+    1.70549958049663008e-16, 1.71874026534903190e-16, 1.73203727308100862e-16,
+    1.74539187479253422e-16, 1.75880535972249163e-16, 1.77227903606800674e-16,
+    1.78581423182373287e-16, 1.79941229564246397e-16, 1.81307459771850181e-16,
+    1.82680253069525251e-16, 1.84059751059858807e-16, 1.85446097779756971e-16,
+    1.86839439799419293e-16, 1.88239926324389230e-16, 1.89647709300861697e-16,
+    1.91062943524437678e-16, 1.92485786752524431e-16, 1.93916399820589991e-16,
+    1.95354946762490963e-16, 1.96801594935103812e-16, 1.98256515147501979e-16,
+    1.99719881794934257e-16, 2.01191872997873516e-16, 2.02672670746419903e-16,
+    2.04162461050358951e-16, 2.05661434095191837e-16, 2.07169784404473753e-16,
+    2.08687711008816021e-16, 2.10215417621929328e-16, 2.11753112824107641e-16,
+    2.13301010253577958e-16, 2.14859328806166356e-16, 2.16428292843760522e-16,
+    2.18008132412078427e-16, 2.19599083468287097e-16, 2.21201388119049619e-16,
+    2.22815294869618104e-16, 2.24441058884630859e-16, 2.26078942261317374e-16,
+    2.27729214315862104e-16, 2.29392151883731135e-16, 2.31068039634821381e-16,
+    2.32757170404353511e-16, 2.34459845540495835e-16, 2.36176375269777449e-16,
+    2.37907079081427719e-16, 2.39652286131862401e-16, 2.41412335670629328e-16,
+    2.43187577489225596e-16, 2.44978372394307071e-16, 2.46785092706928923e-16,
+    2.48608122789585221e-16, 2.50447859602955704e-16, 2.52304713294421701e-16,
+    2.54179107820581223e-16, 2.56071481606177076e-16, 2.57982288242053090e-16,
+    2.59911997224974642e-16, 2.61861094742392422e-16, 2.63830084505494233e-16,
+    2.65819488634184463e-16, 2.67829848597952517e-16, 2.69861726216948893e-16,
+    2.71915704727981850e-16, 2.73992389920581482e-16, 2.76092411348761663e-16,
+    2.78216423624643608e-16, 2.80365107800698346e-16, 2.82539172848025318e-16,
+    2.84739357238817409e-16, 2.86966430641981768e-16, 2.89221195741799560e-16,
+    2.91504490190529318e-16, 2.93817188707002814e-16, 2.96160205334546519e-16,
+    2.98534495873004478e-16, 3.00941060501261765e-16, 3.03380946608500243e-16,
+    3.05855251854485989e-16, 3.08365127481530951e-16, 3.10911781903426585e-16,
+    3.13496484599666312e-16, 3.16120570346710573e-16, 3.18785443821971312e-16,
+    3.21492584620679736e-16, 3.24243552730945164e-16, 3.27039994518224044e-16,
+    3.29883649277228315e-16, 3.32776356417167141e-16, 3.35720063355324408e-16,
+    3.38716834204550467e-16, 3.41768859352563650e-16, 3.44878466045342389e-16,
+    3.48048130103744179e-16, 3.51280488922297892e-16, 3.54578355922479137e-16,
+    3.57944736660427605e-16, 3.61382846821906010e-16, 3.64896132376454205e-16,
+    3.68488292209562034e-16, 3.72163303608020680e-16, 3.75925451041625555e-16,
+    3.79779358766887389e-16, 3.83730027878921319e-16, 3.87782878560789480e-16,
+    3.91943798431142837e-16, 3.96219198078677450e-16, 4.00616075105654169e-16,
+    4.05142088295657318e-16, 4.09805643890306251e-16, 4.14615996429090458e-16,
+    4.19583367207339893e-16, 4.24719084182438505e-16, 4.30035748166747070e-16,
+    4.35547431469395201e-16, 4.41269916903607040e-16, 4.47220987425993228e-16,
+    4.53420779856583448e-16, 4.59892220490593247e-16, 4.66661566471147578e-16,
+    4.73759085326249203e-16, 4.81219917282923793e-16, 4.89085182739220990e-16,
+    4.97403423619193975e-16, 5.06232507214415970e-16, 5.15642182887808295e-16,
+    5.25717580202227484e-16, 5.36564097711202063e-16, 5.48314403425870293e-16,
+    5.61138745467515864e-16, 5.75260648150333070e-16, 5.90981764165210201e-16,
+    6.08723141618090767e-16, 6.29097903487755705e-16, 6.53049205356404080e-16,
+    6.82139307902892863e-16, 7.19244496608936156e-16, 7.70609535003209675e-16,
+    8.54551703858402742e-16
+  },
+  // densities
+  {
+    1.00000000000000000e+00, 9.38143680862170815e-01, 9.00469929925743706e-01,
+    8.71704332381201485e-01, 8.47785500623987831e-01, 8.26993296643048770e-01,
+    8.08421651523006934e-01, 7.91527636972494286e-01, 7.75956852040114331e-01,
+    7.61463388849895062e-01, 7.47868621985193993e-01, 7.35038092431422485e-01,
+    7.22867659593571021e-01, 7.11274760805075013e-01, 7.00192655082787274e-01,
+    6.89566496117077099e-01, 6.79350572264764585e-01, 6.69506316731923956e-01,
+    6.60000841078998923e-01, 6.50805833414570212e-01, 6.41896716427265313e-01,
+    6.33251994214365399e-01, 6.24852738703665311e-01, 6.16682180915206990e-01,
+    6.08725382079621458e-01, 6.00968966365231672e-01, 5.93400901691732874e-01,
+    5.86010318477267478e-01, 5.78787358602844471e-01, 5.71723048664825262e-01,
+    5.64809192912399727e-01, 5.58038282262587004e-01, 5.51403416540640845e-01,
+    5.44898237672439167e-01, 5.38516872002861358e-01, 5.32253880263042767e-01,
+    5.26104213983619284e-01, 5.20063177368233154e-01, 5.14126393814748117e-01,
+    5.08289776410642435e-01, 5.02549501841347279e-01, 4.96901987241549159e-01,
+    4.91343869594032145e-01, 4.85871987341884526e-01, 4.80483363930453822e-01,
+    4.75175193037376986e-01, 4.69944825283959589e-01, 4.64789756250425790e-01,
+    4.59707615642137302e-01, 4.54696157474615115e-01, 4.49753251162754608e-01,
+    4.44876873414548124e-01, 4.40065100842353507e-01, 4.35316103215636241e-01,
+    4.30628137288458501e-01, 4.25999541143034011e-01, 4.21428728997616242e-01,
+    4.16914186433002543e-01, 4.12454465997160846e-01, 4.08048183152032062e-01,
+    4.03694012530529944e-01, 3.99390684475230739e-01, 3.95136981833289824e-01,
+    3.90931736984796774e-01, 3.86773829084137377e-01, 3.82662181496009501e-01,
+    3.78595759409580512e-01, 3.74573567615901881e-01, 3.70594648435145724e-01,
+    3.66658079781513879e-01, 3.62762973354817497e-01, 3.58908472948749557e-01,
+    3.55093752866787293e-01, 3.51318016437483172e-01, 3.47580494621636815e-01,
+    3.43880444704502242e-01, 3.40217149066779856e-01, 3.36589914028677384e-01,
+    3.32998068761808763e-01, 3.29440964264136160e-01, 3.25917972393556021e-01,
+    3.22428484956089001e-01, 3.18971912844957017e-01, 3.15547685227128727e-01,
+    3.12155248774179384e-01, 3.08794066934559963e-01, 3.05463619244590034e-01,
+    3.02163400675693306e-01, 2.98892921015581514e-01, 2.95651704281260974e-01,
+    2.92439288161892408e-01, 2.89255223489677582e-01, 2.86099073737076715e-01,
+    2.82970414538780635e-01, 2.79868833236972758e-01, 2.76793928448517190e-01,
+    2.73745309652802804e-01, 2.70722596799059856e-01, 2.67725419932044628e-01,
+    2.64753418835062038e-01, 2.61806242689362811e-01, 2.58883549749016062e-01,
+    2.55985007030415268e-01, 2.53110290015629347e-01, 2.50259082368862185e-01,
+    2.47431075665327543e-01, 2.44625969131892024e-01, 2.41843469398877131e-01,
+    2.39083290262449094e-01, 2.36345152457059560e-01, 2.33628783437433291e-01,
+    2.30933917169627356e-01, 2.28260293930716618e-01, 2.25607660116683956e-01,
+    2.22975768058120111e-01, 2.20364375843359439e-01, 2.17773247148700472e-01,
+    2.15202151075378628e-01, 2.12650861992978224e-01, 2.10119159388988230e-01,
+    2.07606827724221982e-01, 2.05113656293837654e-01, 2.02639439093708962e-01,
+    2.00183974691911210e-01, 1.97747066105098818e-01, 1.95328520679563189e-01,
+    1.92928149976771296e-01, 1.90545769663195363e-01, 1.88181199404254262e-01,
+    1.85834262762197083e-01, 1.83504787097767436e-01, 1.81192603475496261e-01,
+    1.78897546572478278e-01, 1.76619454590494829e-01, 1.74358169171353411e-01,
+    1.72113535315319977e-01, 1.69885401302527550e-01, 1.67673618617250081e-01,
+    1.65478041874935922e-01, 1.63298528751901734e-01, 1.61134939917591952e-01,
+    1.58987138969314129e-01, 1.56854992369365148e-01, 1.54738369384468027e-01,
+    1.52637142027442801e-01, 1.50551185001039839e-01, 1.48480375643866735e-01,
+    1.46424593878344889e-01, 1.44383722160634720e-01, 1.42357645432472146e-01,
+    1.40346251074862399e-01, 1.38349428863580176e-01, 1.36367070926428829e-01,
+    1.34399071702213602e-01, 1.32445327901387494e-01, 1.30505738468330773e-01,
+    1.28580204545228199e-01, 1.26668629437510671e-01, 1.24770918580830933e-01,
+    1.22886979509545108e-01, 1.21016721826674792e-01, 1.19160057175327641e-01,
+    1.17316899211555525e-01, 1.15487163578633506e-01, 1.13670767882744286e-01,
+    1.11867631670056283e-01, 1.10077676405185357e-01, 1.08300825451033755e-01,
+    1.06537004050001632e-01, 1.04786139306570159e-01, 1.03048160171257702e-01,
+    1.01322997425953631e-01, 9.96105836706371317e-02, 9.79108533114922130e-02,
+    9.62237425504328253e-02, 9.45491893760558727e-02, 9.28871335560435690e-02,
+    9.12375166310401969e-02, 8.96002819100328862e-02, 8.79753744672702315e-02,
+    8.63627411407569268e-02, 8.47623305323681464e-02, 8.31740930096323966e-02,
+    8.15979807092374193e-02, 8.00339475423199054e-02, 7.84819492016064352e-02,
+    7.69419431704805173e-02, 7.54138887340584096e-02, 7.38977469923647462e-02,
+    7.23934808757087517e-02, 7.09010551623718427e-02, 6.94204364987287825e-02,
+    6.79515934219366430e-02, 6.64944963853398158e-02, 6.50491177867538045e-02,
+    6.36154319998073758e-02, 6.21934154085410362e-02, 6.07830464454796604e-02,
+    5.93843056334202798e-02, 5.79971756312006592e-02, 5.66216412837428698e-02,
+    5.52576896766970305e-02, 5.39053101960460801e-02, 5.25644945930716853e-02,
+    5.12352370551262815e-02, 4.99175342827063787e-02, 4.86113855733795036e-02,
+    4.73167929131815615e-02, 4.60337610761751836e-02, 4.47622977329432889e-02,
+    4.35024135688881972e-02, 4.22541224133162543e-02, 4.10174413804148402e-02,
+    3.97923910233741393e-02, 3.85789955030748713e-02, 3.73772827729593818e-02,
+    3.61872847819314433e-02, 3.50090376973974313e-02, 3.38425821508743577e-02,
+    3.26879635089595555e-02, 3.15452321728936225e-02, 3.04144439104666216e-02,
+    2.92956602246374105e-02, 2.81889487639786461e-02, 2.70943837809558032e-02,
+    2.60120466451342208e-02, 2.49420264197317866e-02, 2.38844205115581742e-02,
+    2.28393354063852402e-02, 2.18068875042835807e-02, 2.07872040725781138e-02,
+    1.97804243380097396e-02, 1.87867007446960235e-02, 1.78062004109113547e-02,
+    1.68391068260399408e-02, 1.58856218399731561e-02, 1.49459680116911485e-02,
+    1.40203914031819428e-02, 1.31091649312549911e-02, 1.22125924262553778e-02,
+    1.13310135978346004e-02, 1.04648101810299807e-02, 9.61441364250221163e-03,
+    8.78031498580897699e-03, 7.96307743801704347e-03, 7.16335318363499080e-03,
+    6.38190593731918342e-03, 5.61964220720548909e-03, 4.87765598354239580e-03,
+    4.15729512083379705e-03, 3.46026477783690405e-03, 2.78879879357407569e-03,
+    2.14596774371890713e-03, 1.53629978030157257e-03, 9.67269282327174319e-04,
+    4.54134353841496603e-04
+  }
+};
+
+// MRG32k3a outputs values in [1, m1] where m1 = 2^32 - 209. subtracting 1 and
+// rejecting values from 255 * 2^24 on (about 0.4%) leaves 24 uniform bits
+#define ZIG_MRG_BITS 24
+#define ZIG_MRG_LIMIT (UINT64_C(255) << ZIG_MRG_BITS)
+#define ZIG_MRG_MASK ((UINT64_C(1) << ZIG_MRG_BITS) - 1)
+
+/**
+ * Return 24 uniform bits from a MRG32k3a PRNG.
+ *
+ * @param rng MRG32k3a PRNG
+ */
+static inline uint64_t
+next_mrg_bits(prand_t *rng)
+{
+  uint64_t value;
+  do {
+    value = rng->get(rng->state) - 1;
+  }
+  while (value >= ZIG_MRG_LIMIT);
+  return value & ZIG_MRG_MASK;
+}
+
+/**
+ * Fill a buffer with 64-bit words using the PRNG bulk fill function.
+ *
+ * MT19937 outputs 32 uniform bits per draw, so two draws are combined per
+ * word. MRG32k3a draws only give 24 uniform bits each after rejection, so
+ * three accepted draws are combined per word, with the rejected draws of the
+ * bulk fill replaced by scalar draws.
+ *
+ * @param rng PRNG
+ * @param raw Scratch buffer of `3 * n` words
+ * @param words Buffer of `n` words to fill
+ * @param n Number of words
+ */
+static void
+fill_words(prand_t *rng, uint64_t *raw, uint64_t *words, size_t n)
+{
+  if (rng->type == PRAND_RNG_MT19937) {
+    rng->get_array(rng->state, raw, 2 * n);
+    for (size_t i = 0; i < n; i++)
+      words[i] = (raw[2 * i] << 32) | (raw[2 * i + 1] & UINT64_C(0xffffffff));
+    return;
+  }
+  rng->get_array(rng->state, raw, 3 * n);
+  // compact the accepted draws in place, keeping their order
+  size_t n_accepted = 0;
+  for (size_t i = 0; i < 3 * n; i++) {
+    uint64_t value = raw[i] - 1;
+    if (value < ZIG_MRG_LIMIT)
+      raw[n_accepted++] = value & ZIG_MRG_MASK;
+  }
+  while (n_accepted < 3 * n)
+    raw[n_accepted++] = next_mrg_bits(rng);
+  for (size_t i = 0; i < n; i++)
+    words[i] = raw[3 * i] | (raw[3 * i + 1] << ZIG_MRG_BITS) |
+      (raw[3 * i + 2] << (2 * ZIG_MRG_BITS));
+}
+
+/**
+ * Return a 64-bit word from the PRNG.
+ *
+ * @param rng PRNG
+ */
+static inline uint64_t
+next_word(prand_t *rng)
+{
+  if (rng->type == PRAND_RNG_MT19937) {
+    uint64_t hi = rng->get(rng->state);
+    return (hi << 32) | (rng->get(rng->state) & UINT64_C(0xffffffff));
+  }
+  uint64_t lo = next_mrg_bits(rng);
+  uint64_t mid = next_mrg_bits(rng);
+  return lo | (mid << ZIG_MRG_BITS) |
+    (next_mrg_bits(rng) << (2 * ZIG_MRG_BITS));
+}
+
+/**
+ * Return a uniform double in [0, 1) with 53 random bits.
+ *
+ * @param rng PRNG
+ */
+static inline double
+next_double(prand_t *rng)
+{
+  return (double) (next_word(rng) >> 11) * 0x1.0p-53;
+}
+
+/**
+ * Finish a normal sample whose word was rejected by the lane pass.
+ *
+ * Performs the wedge or tail test for the word and on rejection continues
+ * with the usual scalar Ziggurat loop on fresh words.
+ *
+ * @param rng PRNG
+ * @param word Rejected 64-bit word
+ */
+static double
+normal_slow(prand_t *rng, uint64_t word)
+{
+  while (1) {
+    unsigned int idx = (unsigned int) (word & 0xff);
+    uint64_t sign = (word >> 8) & 1;
+    uint64_t rabs = (word >> 9) & ZIG_NOR_MASK;
+    double x = (double) rabs * zig_nor.w[idx];
+    if (sign)
+      x = -x;
+    if (rabs < zig_nor.k[idx])
+      return x;
+    // tail, sampled with the method of Marsaglia (1964)
+    if (!idx) {
+      while (1) {
+        double xx = -log1p(-next_double(rng)) / ZIG_NOR_R;
+        double yy = -log1p(-next_double(rng));
+        if (yy + yy > xx * xx)
+          return (sign) ? -(ZIG_NOR_R + xx) : ZIG_NOR_R + xx;
+      }
+    }
+    // wedge
+    double f_lo = zig_nor.f[idx];
+    double f_hi = zig_nor.f[idx - 1];
+    if ((f_hi - f_lo) * next_double(rng) + f_lo < exp(-.5 * x * x))
+      return x;
+    word = next_word(rng);
+  }
+}
+
+/**
+ * Finish an exponential sample whose word was rejected by the lane pass.
+ *
+ * @param rng PRNG
+ * @param word Rejected 64-bit word
+ */
+static double
+exponential_slow(prand_t *rng, uint64_t word)
+{
+  while (1) {
+    uint64_t bits = word >> 3;
+    unsigned int idx = (unsigned int) (bits & 0xff);
+    uint64_t r = bits >> 8;
+    double x = (double) r * zig_exp.w[idx];
+    if (r < zig_exp.k[idx])
+      return x;
+    // tail is memoryless so it is just the start of the tail plus a sample
+    if (!idx)
+      return ZIG_EXP_R - log1p(-next_double(rng));
+    double f_lo = zig_exp.f[idx];
+    double f_hi = zig_exp.f[idx - 1];
+    if ((f_hi - f_lo) * next_double(rng) + f_lo < exp(-x))
+      return x;
+    word = next_word(rng);
+  }
+}
+
+const pdmpmt_ziggurat_table *
+pdmpmt_ziggurat_normal_table(void)
+{
+  return &zig_nor;
+}
+
+const pdmpmt_ziggurat_table *
+pdmpmt_ziggurat_exponential_table(void)
+{
+  return &zig_exp;
+}
+
+void
+pdmpmt_rng_normal_fill(
+  double *out,
+  size_t n,
+  pdmpmt_rng_type rng_type,
+  unsigned seed)
+{
+  prand_t *rng = pdmpmt_make_prand(rng_type, seed, 0u);
+  uint64_t raw[3 * ZIG_BLOCK];
+  uint64_t words[ZIG_BLOCK];
+  unsigned char reject[ZIG_BLOCK];
+  for (size_t done = 0; done < n; done += ZIG_BLOCK) {
+    size_t m = (n - done < ZIG_BLOCK) ? n - done : ZIG_BLOCK;
+    double *x = out + done;
+    fill_words(rng, raw, words, m);
+    // branch-free lane pass. the table lookups are gathers, so this vectorizes
+    // on targets with gather instructions, e.g. AVX2
+    for (size_t i = 0; i < m; i++) {
+      uint64_t word = words[i];
+      unsigned int idx = (unsigned int) (word & 0xff);
+      uint64_t rabs = (word >> 9) & ZIG_NOR_MASK;
+      double mag = (double) rabs * zig_nor.w[idx];
+      x[i] = ((word >> 8) & 1) ? -mag : mag;
+      reject[i] = (unsigned char) (rabs >= zig_nor.k[idx]);
+    }
+    // scalar fallback for the rejected lanes
+    for (size_t i = 0; i < m; i++) {
+      if (reject[i])
+        x[i] = normal_slow(rng, words[i]);
+    }
+  }
+  prand_destroy(rng);
+}
+
+void
+pdmpmt_rng_exponential_fill(
+  double *out,
+  size_t n,
+  pdmpmt_rng_type rng_type,
+  unsigned seed)
+{
+  prand_t *rng = pdmpmt_make_prand(rng_type, seed, 0u);
+  uint64_t raw[3 * ZIG_BLOCK];
+  uint64_t words[ZIG_BLOCK];
+  unsigned char reject[ZIG_BLOCK];
+  for (size_t done = 0; done < n; done += ZIG_BLOCK) {
+    size_t m = (n - done < ZIG_BLOCK) ? n - done : ZIG_BLOCK;
+    double *x = out + done;
+    fill_words(rng, raw, words, m);
+    for (size_t i = 0; i < m; i++) {
+      uint64_t bits = words[i] >> 3;
+      unsigned int idx = (unsigned int) (bits & 0xff);
+      uint64_t r = bits >> 8;
+      x[i] = (double) r * zig_exp.w[idx];
+      reject[i] = (unsigned char) (r >= zig_exp.k[idx]);
+    }
+    for (size_t i = 0; i < m; i++) {
+      if (reject[i])
+        x[i] = exponential_slow(rng, words[i]);
+    }
+  }
+  prand_destroy(rng);
+}
@@ -0,0 +1,229 @@
+/**
+ * @file pdmpmt_mcpi.cc
+ * @author Derek Huang
+ * @brief C++ program to estimate pi over a range of a run's samples
+ * @copyright MIT License
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <string_view>
+
+#if defined(_WIN32)
+#include <fcntl.h>
+#include <io.h>
+#endif  // defined(_WIN32)
+
+#include "pdmpmt/mcpi.h"
+#include "pdmpmt/mcpi_record.h"
+
+namespace {
+
+// program name and usage. the executable is named pdmpmt-mcpi
+const std::string program_name{"pdmpmt-mcpi"};
+const std::string program_usage{
+  "Usage: " + program_name + " [-h] [-e] [-r RNG] [-s SEED] [-j JOBS]\n"
+  "         [-f FIRST] [-n COUNT] [-c CHUNK] N_SAMPLES\n"
+  "\n"
+  "Estimate pi over the samples [FIRST, FIRST + COUNT) of a run of N_SAMPLES\n"
+  "samples, laid out like the pdmpmt_rng_smcpi_ompm run with JOBS jobs or\n"
+  "like the pdmpmt_rng_smcpi run if JOBS is 0. Runs of several processes\n"
+  "with the same RNG, SEED, JOBS, and N_SAMPLES cover disjoint or\n"
+  "overlapping ranges of the same samples.\n"
+  "\n"
+  "Prints \"<samples> <inside> <pi>\" for the range, or with -e, writes\n"
+  "length-prefixed binary records of the counts of each CHUNK-aligned\n"
+  "chunk of the range to standard output for mcpi-merge.\n"
+  "\n"
+  "Options:\n"
+  "  -h, --help        Print this usage\n"
+  "  -e, --emit        Write binary records instead of the estimate\n"
+  "  -r, --rng RNG     PRNG, mrg32k3a (default) or mt19937\n"
+  "  -s, --seed SEED   Unsigned int seed value, default 1\n"
+  "  -j, --jobs JOBS   Number of jobs of the run, default 0\n"
+  "  -f, --first FIRST Global index of the first sample, default 0\n"
+  "  -n, --count COUNT Number of samples, default to the end of the run\n"
+  "  -c, --chunk CHUNK Chunk size for records, default 1048576"
+};
+
+/**
+ * Struct for program arguments.
+ */
+struct cli_options {
+  bool print_usage = false;
+  bool emit = false;
+  pdmpmt_rng_type rng_type = PDMPMT_RNG_MRG32K3A;
+  unsigned long seed = 1u;
+  unsigned long n_jobs = 0u;
+  unsigned long long first = 0u;
+  unsigned long long count = std::numeric_limits<unsigned long long>::max();
+  unsigned long long chunk = 1u << 20;
+  unsigned long long n_samples = 0u;
+};
+
+/**
+ * Parse an unsigned integer option value.
+ *
+ * @tparam T Unsigned integral type
+ *
+ * @param value Parsed value
+ * @param arg Option value string
+ * @returns `true` on success, `false` on error
+ */
+template <typename T>
+bool parse_unsigned(T& value, std::string_view arg)
+{
+  std::string str{arg};
+  char* end;
+  auto parsed = std::strtoull(str.c_str(), &end, 10);
+  if (str.empty() || *end || str[0] == '-')
+    return false;
+  if (parsed > std::numeric_limits<T>::max())
+    return false;
+  value = static_cast<T>(parsed);
+  return true;
+}
+
+/**
+ * Parse incoming command-line arguments.
+ *
+ * @param opts Options struct to populate
+ * @param argc Argument count from `main`
+ * @param argv Argument vector from `main`
+ * @returns `true` on success, `false` on error
+ */
+bool parse_args(cli_options& opts, int argc, char* argv[])
+{
+  bool has_n_samples = false;
+  // iterate through arguments
+  for (int i = 1; i < argc; i++) {
+    // string view for convenience
+    std::string_view arg{argv[i]};
+    // help option (break early)
+    if (arg == "-h" || arg == "--help") {
+      opts.print_usage = true;
+      return true;
+    }
+    // emit option
+    else if (arg == "-e" || arg == "--emit")
+      opts.emit = true;
+    // PRNG option
+    else if (arg == "-r" || arg == "--rng") {
+      std::string_view value{(++i < argc) ? argv[i] : ""};
+      if (value == "mrg32k3a")
+        opts.rng_type = PDMPMT_RNG_MRG32K3A;
+      else if (value == "mt19937")
+        opts.rng_type = PDMPMT_RNG_MT19937;
+      else {
+        std::cerr << "Error: " << arg << " requires mrg32k3a or mt19937" <<
+          std::endl;
+        return false;
+      }
+    }
+    // options taking a nonnegative integer value
+    else if (
+      arg == "-s" || arg == "--seed" || arg == "-j" || arg == "--jobs" ||
+      arg == "-f" || arg == "--first" || arg == "-n" || arg == "--count" ||
+      arg == "-c" || arg == "--chunk"
+    ) {
+      std::string_view value{(++i < argc) ? argv[i] : ""};
+      bool parsed;
+      // estimators take unsigned seeds, so larger seeds would alias
+      if (arg == "-s" || arg == "--seed")
+        parsed = parse_unsigned(opts.seed, value) &&
+          opts.seed <= std::numeric_limits<unsigned int>::max();
+      else if (arg == "-j" || arg == "--jobs")
+        parsed = parse_unsigned(opts.n_jobs, value) &&
+          opts.n_jobs <= std::numeric_limits<unsigned int>::max();
+      else if (arg == "-f" || arg == "--first")
+        parsed = parse_unsigned(opts.first, value);
+      else if (arg == "-n" || arg == "--count")
+        parsed = parse_unsigned(opts.count, value);
+      else
+        parsed = parse_unsigned(opts.chunk, value) && opts.chunk;
+      if (!parsed) {
+        std::cerr << "Error: " << arg << " requires a nonnegative integer " <<
+          "in range" << std::endl;
+        return false;
+      }
+    }
+    // total sample count
+    else if (!arg.empty() && arg[0] != '-' && !has_n_samples) {
+      if (!parse_unsigned(opts.n_samples, arg) || !opts.n_samples) {
+        std::cerr << "Error: N_SAMPLES must be a positive integer" <<
+          std::endl;
+        return false;
+      }
+      has_n_samples = true;
+    }
+    // unknown
+    else {
+      std::cerr << "Error: Unknown argument " << arg << ". Try " <<
+        program_name << " --help for usage" << std::endl;
+      return false;
+    }
+  }
+  if (!has_n_samples) {
+    std::cerr << "Error: Missing N_SAMPLES. Try " << program_name <<
+      " --help for usage" << std::endl;
+    return false;
+  }
+  // clamp the count to the end of the run
+  if (opts.first > opts.n_samples) {
+    std::cerr << "Error: FIRST must not exceed N_SAMPLES" << std::endl;
+    return false;
+  }
+  if (opts.count > opts.n_samples - opts.first)
+    opts.count = opts.n_samples - opts.first;
+  // done
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[])
+{
+  cli_options opts;
+  if (!parse_args(opts, argc, argv))
+    return EXIT_FAILURE;
+  if (opts.print_usage) {
+    std::cout << program_usage << std::endl;
+    return EXIT_SUCCESS;
+  }
+  pdmpmt_mcpi_run run{
+    opts.rng_type,
+    opts.seed,
+    static_cast<std::size_t>(opts.n_samples),
+    static_cast<unsigned int>(opts.n_jobs)
+  };
+  auto first = static_cast<std::size_t>(opts.first);
+  auto count = static_cast<std::size_t>(opts.count);
+  if (opts.emit) {
+#if defined(_WIN32)
+    // records are binary so stdout must not translate newlines
+    _setmode(_fileno(stdout), _O_BINARY);
+#endif  // defined(_WIN32)
+    if (
+      pdmpmt_mcpi_emit(
+        &run, first, count, static_cast<std::size_t>(opts.chunk), 1
+      )
+    ) {
+      std::cerr << "Error: Failed to emit records" << std::endl;
+      return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+  }
+  std::size_t n_inside = 0;
+  if (count && pdmpmt_mcpi_count_range(&run, first, count, &n_inside)) {
+    std::cerr << "Error: Failed to count samples" << std::endl;
+    return EXIT_FAILURE;
+  }
+  auto pi_hat = count ? 4 * (static_cast<double>(n_inside) / count) : 0.;
+  std::cout << count << ' ' << n_inside << ' ' <<
+    std::setprecision(17) << pi_hat << std::endl;
+  return EXIT_SUCCESS;
+}
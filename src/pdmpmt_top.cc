@@ -0,0 +1,277 @@
+/**
+ * @file pdmpmt_top.cc
+ * @author Derek Huang
+ * @brief C++ program to display live run counters published to shared memory
+ * @copyright MIT License
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <ios>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "pdmpmt/monitor.h"
+
+namespace {
+
+// program name and usage. the executable is named pdmpmt-top
+const std::string program_name{"pdmpmt-top"};
+const std::string program_usage{
+  "Usage: " + program_name + " [-h] [-b] [-i INTERVAL] [-n COUNT] NAME\n"
+  "\n"
+  "Display live per-worker counters of a run publishing to the named shared\n"
+  "memory segment NAME, attaching read-only.\n"
+  "\n"
+  "Each refresh shows the per-worker progress and sample rate, the imbalance\n"
+  "of the worker rates, and the running estimate of pi with its 95% CI.\n"
+  "Workers whose counters cannot be read consistently, e.g. because the\n"
+  "worker died mid-update, are marked stale and show their last counters.\n"
+  "Exits once all workers have finished or are stale or after COUNT\n"
+  "refreshes.\n"
+  "\n"
+  "Options:\n"
+  "  -h, --help        Print this usage\n"
+  "  -b, --batch       Do not clear the screen between refreshes\n"
+  "  -i, --interval INTERVAL\n"
+  "                    Refresh interval in milliseconds, default 1000\n"
+  "  -n, --count COUNT Number of refreshes, default 0 for no limit"
+};
+
+/**
+ * Struct for program arguments.
+ */
+struct cli_options {
+  bool print_usage = false;
+  bool batch = false;
+  unsigned long interval = 1000u;
+  unsigned long count = 0u;
+  std::string name;
+};
+
+/**
+ * Parse an unsigned integer option value.
+ *
+ * @param value Parsed value
+ * @param arg Option value string
+ * @returns `true` on success, `false` on error
+ */
+bool parse_ulong(unsigned long& value, std::string_view arg)
+{
+  std::string str{arg};
+  char* end;
+  value = std::strtoul(str.c_str(), &end, 10);
+  return !str.empty() && !*end && str[0] != '-';
+}
+
+/**
+ * Parse incoming command-line arguments.
+ *
+ * @param opts Options struct to populate
+ * @param argc Argument count from `main`
+ * @param argv Argument vector from `main`
+ * @returns `true` on success, `false` on error
+ */
+bool parse_args(cli_options& opts, int argc, char* argv[])
+{
+  // iterate through arguments
+  for (int i = 1; i < argc; i++) {
+    // string view for convenience
+    std::string_view arg{argv[i]};
+    // help option (break early)
+    if (arg == "-h" || arg == "--help") {
+      opts.print_usage = true;
+      return true;
+    }
+    // batch option
+    else if (arg == "-b" || arg == "--batch")
+      opts.batch = true;
+    // interval and count options, which take a value
+    else if (
+      arg == "-i" || arg == "--interval" || arg == "-n" || arg == "--count"
+    ) {
+      auto& value = (arg == "-i" || arg == "--interval") ?
+        opts.interval : opts.count;
+      if (++i >= argc || !parse_ulong(value, argv[i])) {
+        std::cerr << "Error: " << arg << " requires a nonnegative integer" <<
+          std::endl;
+        return false;
+      }
+    }
+    // segment name
+    else if (!arg.empty() && arg[0] != '-' && opts.name.empty())
+      opts.name = arg;
+    // unknown
+    else {
+      std::cerr << "Error: Unknown argument " << arg << ". Try " <<
+        program_name << " --help for usage" << std::endl;
+      return false;
+    }
+  }
+  if (opts.name.empty()) {
+    std::cerr << "Error: Missing segment NAME. Try " << program_name <<
+      " --help for usage" << std::endl;
+    return false;
+  }
+  // done
+  return true;
+}
+
+/**
+ * Read a snapshot of the counters of all workers.
+ *
+ * Workers whose counters cannot be read keep their previous counters.
+ *
+ * @param mon Monitor to read from
+ * @param counters Counters of all workers to update
+ * @param stale Flags to update indicating which workers could not be read
+ */
+void read_counters(
+  const pdmpmt_monitor* mon,
+  std::vector<pdmpmt_monitor_counts>& counters,
+  std::vector<bool>& stale)
+{
+  counters.resize(pdmpmt_monitor_n_workers(mon));
+  stale.resize(counters.size());
+  for (unsigned int i = 0; i < counters.size(); i++)
+    stale[i] = !!pdmpmt_monitor_read(mon, i, &counters[i]);
+}
+
+/**
+ * Indicate if all workers have finished their samples or are stale.
+ *
+ * Stale workers are likely dead and would otherwise prevent exiting.
+ *
+ * @param counters Counters of all workers
+ * @param stale Flags indicating which workers could not be read
+ */
+bool finished(
+  const std::vector<pdmpmt_monitor_counts>& counters,
+  const std::vector<bool>& stale)
+{
+  for (unsigned int i = 0; i < counters.size(); i++) {
+    const auto& c = counters[i];
+    if (!stale[i] && (!c.n_target || c.n_done != c.n_target))
+      return false;
+  }
+  return true;
+}
+
+/**
+ * Display a refresh of the worker counters.
+ *
+ * @param out Stream to write to
+ * @param prev Counters of all workers at the previous refresh
+ * @param cur Counters of all workers at the current refresh
+ * @param stale Flags indicating which workers could not be read
+ * @param dt Seconds elapsed between the two refreshes
+ */
+void display(
+  std::ostream& out,
+  const std::vector<pdmpmt_monitor_counts>& prev,
+  const std::vector<pdmpmt_monitor_counts>& cur,
+  const std::vector<bool>& stale,
+  double dt)
+{
+  std::uint64_t n_target = 0;
+  std::uint64_t n_done = 0;
+  std::uint64_t n_inside = 0;
+  double total_rate = 0;
+  double max_rate = 0;
+  unsigned int n_active = 0;
+  out << std::setw(8) << "worker" << std::setw(24) << "done / target" <<
+    std::setw(10) << "progress" << std::setw(14) << "rate (1/s)" << '\n';
+  for (unsigned int i = 0; i < cur.size(); i++) {
+    const auto& c = cur[i];
+    // a new run may have reset the counters since the previous refresh
+    const auto& p = prev[i];
+    auto rate = (c.n_done >= p.n_done) ? (c.n_done - p.n_done) / dt : 0.;
+    auto progress = c.n_target ? 100. * c.n_done / c.n_target : 0.;
+    out << std::setw(8) << i << std::setw(24) <<
+      (std::to_string(c.n_done) + " / " + std::to_string(c.n_target)) <<
+      std::fixed << std::setprecision(1) << std::setw(9) << progress << '%' <<
+      std::scientific << std::setprecision(3) << std::setw(14) << rate <<
+      (stale[i] ? "  stale\n" : "\n");
+    n_target += c.n_target;
+    n_done += c.n_done;
+    n_inside += c.n_inside;
+    // only unfinished workers count towards the imbalance
+    if (c.n_target && c.n_done < c.n_target) {
+      total_rate += rate;
+      max_rate = std::max(max_rate, rate);
+      n_active++;
+    }
+  }
+  out << std::setw(8) << "total" << std::setw(24) <<
+    (std::to_string(n_done) + " / " + std::to_string(n_target)) <<
+    std::fixed << std::setprecision(1) << std::setw(9) <<
+    (n_target ? 100. * n_done / n_target : 0.) << '%' << '\n';
+  // imbalance is how much faster the fastest worker is than the mean
+  out << "imbalance: ";
+  if (n_active && total_rate > 0)
+    out << std::setprecision(1) <<
+      100 * (max_rate * n_active / total_rate - 1) <<
+      "% (max / mean rate of " << n_active << " active workers)\n";
+  else
+    out << "-\n";
+  // running estimate of pi with normal approximation 95% CI
+  out << "pi: ";
+  if (n_done) {
+    auto p = static_cast<double>(n_inside) / n_done;
+    auto half_width = 1.959964 * 4 * std::sqrt(p * (1 - p) / n_done);
+    out << std::setprecision(8) << 4 * p << " +/- " << std::scientific <<
+      std::setprecision(3) << half_width << " (95% CI)\n";
+  }
+  else
+    out << "-\n";
+  out.flush();
+}
+
+}  // namespace
+
+int main(int argc, char* argv[])
+{
+  cli_options opts;
+  if (!parse_args(opts, argc, argv))
+    return EXIT_FAILURE;
+  if (opts.print_usage) {
+    std::cout << program_usage << std::endl;
+    return EXIT_SUCCESS;
+  }
+  // attach read-only
+  auto mon = pdmpmt_monitor_open(opts.name.c_str());
+  if (!mon) {
+    std::cerr << "Error: Cannot attach to segment " << opts.name << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::vector<pdmpmt_monitor_counts> prev;
+  std::vector<bool> stale;
+  read_counters(mon, prev, stale);
+  auto prev_time = std::chrono::steady_clock::now();
+  for (unsigned long n = 0; !opts.count || n < opts.count; n++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds{opts.interval});
+    auto cur = prev;
+    read_counters(mon, cur, stale);
+    auto cur_time = std::chrono::steady_clock::now();
+    std::chrono::duration<double> dt = cur_time - prev_time;
+    // clear screen and move cursor to top left corner
+    if (!opts.batch)
+      std::cout << "\x1b[2J\x1b[H";
+    std::cout << program_name << ": " << opts.name << ", " << cur.size() <<
+      " workers\n";
+    display(std::cout, prev, cur, stale, std::max(dt.count(), 1e-9));
+    if (finished(cur, stale))
+      break;
+    prev = std::move(cur);
+    prev_time = cur_time;
+  }
+  pdmpmt_monitor_close(mon);
+  return EXIT_SUCCESS;
+}
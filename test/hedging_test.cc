@@ -0,0 +1,172 @@
+/**
+ * @file hedging_test.cc
+ * @author Derek Huang
+ * @brief hedging.hh unit tests
+ * @copyright MIT License
+ */
+
+#include "pdmpmt/hedging.hh"
+
+#include <chrono>
+#include <cstddef>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "pdmpmt/worker_pool.hh"
+
+namespace {
+
+/**
+ * Test fixture for the hedged chunk scheduling tests.
+ */
+class HedgingTest : public ::testing::Test {
+protected:
+  // pool size, including the calling thread
+  static constexpr unsigned int n_threads_ = 4u;
+  // number of chunks, each with unit cost
+  static constexpr std::size_t n_chunks_ = 16u;
+  // duration of a normal chunk
+  static constexpr std::chrono::milliseconds chunk_time_{1};
+  // duration of a straggling chunk if it is never cancelled
+  static constexpr std::chrono::milliseconds straggler_time_{2000};
+
+  /**
+   * Return the expected result for a chunk.
+   *
+   * @param i Chunk index
+   */
+  static std::size_t expected(std::size_t i) noexcept
+  {
+    return i * i;
+  }
+
+  /**
+   * Chunk function where the original copy of chunk 0 straggles.
+   *
+   * The straggler sleeps in steps of the normal chunk duration, returning a
+   * wrong result early if it is cancelled.
+   *
+   * @param i Chunk index
+   * @param token Cancellation token
+   */
+  static std::size_t straggle(std::size_t i, const pdmpmt::hedge_token& token)
+  {
+    if (!i && !token.copy()) {
+      for (auto t = chunk_time_; t < straggler_time_; t += chunk_time_) {
+        if (token.cancelled())
+          return 0u;
+        std::this_thread::sleep_for(chunk_time_);
+      }
+    }
+    std::this_thread::sleep_for(chunk_time_);
+    return expected(i);
+  }
+
+  std::vector<std::size_t> costs_ = std::vector<std::size_t>(n_chunks_, 1u);
+};
+
+/**
+ * Test that a straggling chunk is hedged and the hedged copy wins.
+ */
+TEST_F(HedgingTest, StragglerTest)
+{
+  pdmpmt::worker_pool pool{n_threads_};
+  pdmpmt::hedge_stats stats;
+  auto start = std::chrono::steady_clock::now();
+  auto results = pdmpmt::run_hedged<std::size_t>(
+    pool, costs_, straggle, {}, &stats
+  );
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  ASSERT_EQ(n_chunks_, results.size());
+  for (std::size_t i = 0; i < n_chunks_; i++)
+    EXPECT_EQ(expected(i), results[i]);
+  EXPECT_EQ(n_chunks_, stats.n_chunks);
+  EXPECT_LE(1u, stats.n_hedges);
+  EXPECT_EQ(1u, stats.n_wins);
+  // the straggler is cancelled long before it would have finished
+  EXPECT_LT(elapsed, straggler_time_ / 2);
+}
+
+/**
+ * Test that a further copy waits until the latest copy is overdue.
+ *
+ * The first hedged copy is slower than a normal chunk but well within the
+ * slowdown, so no third copy should be started although the original copy is
+ * still straggling.
+ */
+TEST_F(HedgingTest, LatestCopyTest)
+{
+  pdmpmt::worker_pool pool{n_threads_};
+  pdmpmt::hedge_stats stats;
+  auto results = pdmpmt::run_hedged<std::size_t>(
+    pool,
+    costs_,
+    [](std::size_t i, const pdmpmt::hedge_token& token)
+    {
+      if (!i && token.copy()) {
+        std::this_thread::sleep_for(10 * chunk_time_);
+        return expected(i);
+      }
+      return straggle(i, token);
+    },
+    {50., 3u},
+    &stats
+  );
+  for (std::size_t i = 0; i < n_chunks_; i++)
+    EXPECT_EQ(expected(i), results[i]);
+  EXPECT_EQ(1u, stats.n_hedges);
+  EXPECT_EQ(1u, stats.n_wins);
+}
+
+/**
+ * Test that no chunk is hedged when at most one copy is allowed.
+ */
+TEST_F(HedgingTest, NoHedgeTest)
+{
+  pdmpmt::worker_pool pool{n_threads_};
+  pdmpmt::hedge_stats stats;
+  auto results = pdmpmt::run_hedged<std::size_t>(
+    pool,
+    costs_,
+    [](std::size_t i, const pdmpmt::hedge_token& token)
+    {
+      // chunk 0 is slow but still has to finish on its own
+      std::this_thread::sleep_for((i) ? chunk_time_ : 20 * chunk_time_);
+      EXPECT_FALSE(token.cancelled());
+      return expected(i);
+    },
+    {2., 1u},
+    &stats
+  );
+  for (std::size_t i = 0; i < n_chunks_; i++)
+    EXPECT_EQ(expected(i), results[i]);
+  EXPECT_EQ(0u, stats.n_hedges);
+  EXPECT_EQ(0u, stats.n_wins);
+}
+
+/**
+ * Test that an exception thrown by a chunk ends the run and is rethrown.
+ */
+TEST_F(HedgingTest, ExceptionTest)
+{
+  pdmpmt::worker_pool pool{n_threads_};
+  EXPECT_THROW(
+    pdmpmt::run_hedged<std::size_t>(
+      pool,
+      costs_,
+      [](std::size_t i, const pdmpmt::hedge_token&) -> std::size_t
+      {
+        if (i == n_chunks_ / 2)
+          throw std::runtime_error{"chunk failed"};
+        std::this_thread::sleep_for(chunk_time_);
+        return i;
+      }
+    ),
+    std::runtime_error
+  );
+}
+
+}  // namespace
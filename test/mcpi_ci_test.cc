@@ -0,0 +1,266 @@
+/**
+ * @file mcpi_ci_test.cc
+ * @author Derek Huang
+ * @brief mcpi_ci.h unit tests
+ * @copyright MIT License
+ */
+
+#include "pdmpmt/mcpi_ci.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif  // _OPENMP
+
+#include <gtest/gtest.h>
+
+#include "pdmpmt/block.h"
+#include "pdmpmt/mcpi.h"
+
+namespace {
+
+/**
+ * Test fixture for the chunked pi confidence interval tests.
+ *
+ * Draws circle counts for chunks with equal and with unequal sample counts
+ * directly from their binomial distributions to keep the setup fast.
+ */
+class MCPiCITest : public ::testing::Test {
+protected:
+  /**
+   * Ctor.
+   *
+   * Allocates and fills in the per-chunk counts.
+   */
+  MCPiCITest()
+    : circle_counts_{pdmpmt_block_ulong_alloc(n_chunks_)},
+      sample_counts_{pdmpmt_block_ulong_alloc(n_chunks_)},
+      uneven_circle_counts_{pdmpmt_block_ulong_alloc(n_chunks_)},
+      uneven_sample_counts_{pdmpmt_block_ulong_alloc(n_chunks_)}
+  {
+    std::mt19937_64 rng{seed_};
+    for (unsigned int i = 0; i < n_chunks_; i++) {
+      sample_counts_.data[i] = chunk_size_;
+      circle_counts_.data[i] = std::binomial_distribution<unsigned long>{
+        chunk_size_, pi_ / 4
+      }(rng);
+      uneven_sample_counts_.data[i] = chunk_size_ / 2 + (i % 7) * 100;
+      uneven_circle_counts_.data[i] = std::binomial_distribution<unsigned long>{
+        uneven_sample_counts_.data[i], pi_ / 4
+      }(rng);
+    }
+  }
+
+  /**
+   * Dtor.
+   */
+  ~MCPiCITest()
+  {
+    pdmpmt_block_ulong_free(&circle_counts_);
+    pdmpmt_block_ulong_free(&sample_counts_);
+    pdmpmt_block_ulong_free(&uneven_circle_counts_);
+    pdmpmt_block_ulong_free(&uneven_sample_counts_);
+  }
+
+  /**
+   * Return the standard error of the pi estimate under binomial sampling.
+   *
+   * @param n_samples Total number of samples
+   */
+  static double binomial_std_error(double n_samples)
+  {
+    constexpr double p = pi_ / 4;
+    return 4 * std::sqrt(p * (1 - p) / n_samples);
+  }
+
+  static constexpr unsigned int n_chunks_ = 2000u;
+  static constexpr unsigned long chunk_size_ = 1000u;
+  static constexpr unsigned int seed_ = 8888u;
+  static constexpr unsigned int n_resamples_ = 2000u;
+  static constexpr double level_ = 0.99;
+  static constexpr double pi_ = 3.141592653589793;
+  pdmpmt_block_ulong circle_counts_;
+  pdmpmt_block_ulong sample_counts_;
+  pdmpmt_block_ulong uneven_circle_counts_;
+  pdmpmt_block_ulong uneven_sample_counts_;
+};
+
+/**
+ * Test that the bootstrap CI of grouped equal-size chunks is sensible.
+ */
+TEST_F(MCPiCITest, BootstrapTest)
+{
+  pdmpmt_mcpi_ci ci;
+  ASSERT_FALSE(
+    pdmpmt_mcpi_bootstrap_ci(
+      circle_counts_, sample_counts_, n_resamples_, level_, seed_, &ci
+    )
+  );
+  EXPECT_DOUBLE_EQ(
+    pdmpmt_mcpi_gather(circle_counts_, sample_counts_), ci.estimate
+  );
+  EXPECT_LT(ci.lower, pi_);
+  EXPECT_GT(ci.upper, pi_);
+  EXPECT_NEAR(
+    binomial_std_error(n_chunks_ * chunk_size_),
+    ci.std_error,
+    0.1 * ci.std_error
+  );
+}
+
+/**
+ * Test that the bootstrap CI of uneven chunks is sensible.
+ */
+TEST_F(MCPiCITest, BootstrapUnevenTest)
+{
+  pdmpmt_mcpi_ci ci;
+  ASSERT_FALSE(
+    pdmpmt_mcpi_bootstrap_ci(
+      uneven_circle_counts_,
+      uneven_sample_counts_,
+      n_resamples_,
+      level_,
+      seed_,
+      &ci
+    )
+  );
+  EXPECT_LT(ci.lower, pi_);
+  EXPECT_GT(ci.upper, pi_);
+  double n_samples = 0;
+  for (unsigned int i = 0; i < n_chunks_; i++)
+    n_samples += uneven_sample_counts_.data[i];
+  EXPECT_NEAR(binomial_std_error(n_samples), ci.std_error, 0.1 * ci.std_error);
+}
+
+/**
+ * Test that the bootstrap CI does not depend on the thread count.
+ */
+TEST_F(MCPiCITest, BootstrapReproducibleTest)
+{
+  pdmpmt_mcpi_ci ci_1, ci_2;
+  ASSERT_FALSE(
+    pdmpmt_mcpi_bootstrap_ci(
+      circle_counts_, sample_counts_, n_resamples_, level_, seed_, &ci_1
+    )
+  );
+#ifdef _OPENMP
+  // number of threads the other tests use is whatever OpenMP chose
+  auto n_threads = omp_get_max_threads();
+  omp_set_num_threads(n_threads + 2);
+#endif  // _OPENMP
+  ASSERT_FALSE(
+    pdmpmt_mcpi_bootstrap_ci(
+      circle_counts_, sample_counts_, n_resamples_, level_, seed_, &ci_2
+    )
+  );
+#ifdef _OPENMP
+  omp_set_num_threads(n_threads);
+#endif  // _OPENMP
+  EXPECT_EQ(ci_1.lower, ci_2.lower);
+  EXPECT_EQ(ci_1.upper, ci_2.upper);
+  EXPECT_EQ(ci_1.std_error, ci_2.std_error);
+}
+
+/**
+ * Test that the bootstrap CI of a `pdmpmt_generate_sample_counts` split works.
+ *
+ * The sample counts of such a split differ by at most one, so chunks are
+ * still grouped by their pairs of counts.
+ */
+TEST_F(MCPiCITest, BootstrapSplitTest)
+{
+  auto n_samples = n_chunks_ * chunk_size_ + n_chunks_ / 2;
+  auto sample_counts = pdmpmt_generate_sample_counts(n_samples, n_chunks_);
+  ASSERT_TRUE(sample_counts.data) << "sample count allocation failed";
+  auto circle_counts = pdmpmt_block_ulong_alloc(n_chunks_);
+  std::mt19937_64 rng{seed_};
+  for (unsigned int i = 0; i < n_chunks_; i++)
+    circle_counts.data[i] = std::binomial_distribution<unsigned long>{
+      sample_counts.data[i], pi_ / 4
+    }(rng);
+  pdmpmt_mcpi_ci ci;
+  ASSERT_FALSE(
+    pdmpmt_mcpi_bootstrap_ci(
+      circle_counts, sample_counts, n_resamples_, level_, seed_, &ci
+    )
+  );
+  EXPECT_DOUBLE_EQ(
+    pdmpmt_mcpi_gather(circle_counts, sample_counts), ci.estimate
+  );
+  EXPECT_LT(ci.lower, pi_);
+  EXPECT_GT(ci.upper, pi_);
+  EXPECT_NEAR(
+    binomial_std_error(static_cast<double>(n_samples)),
+    ci.std_error,
+    0.1 * ci.std_error
+  );
+  pdmpmt_block_ulong_free(&circle_counts);
+  pdmpmt_block_ulong_free(&sample_counts);
+}
+
+/**
+ * Test that the batch means CI is sensible for both chunk layouts.
+ */
+TEST_F(MCPiCITest, BatchMeansTest)
+{
+  constexpr unsigned int n_batches = 40u;
+  pdmpmt_mcpi_ci ci;
+  ASSERT_FALSE(
+    pdmpmt_mcpi_batch_means_ci(
+      circle_counts_, sample_counts_, n_batches, level_, &ci
+    )
+  );
+  EXPECT_DOUBLE_EQ(
+    pdmpmt_mcpi_gather(circle_counts_, sample_counts_), ci.estimate
+  );
+  EXPECT_LT(ci.lower, pi_);
+  EXPECT_GT(ci.upper, pi_);
+  // with 39 degrees of freedom the standard error is only good to ~25%
+  EXPECT_NEAR(
+    binomial_std_error(n_chunks_ * chunk_size_),
+    ci.std_error,
+    0.25 * ci.std_error
+  );
+  ASSERT_FALSE(
+    pdmpmt_mcpi_batch_means_ci(
+      uneven_circle_counts_, uneven_sample_counts_, n_batches, level_, &ci
+    )
+  );
+  EXPECT_LT(ci.lower, pi_);
+  EXPECT_GT(ci.upper, pi_);
+}
+
+/**
+ * Test that the batch means CI does not depend on the thread count.
+ */
+TEST_F(MCPiCITest, BatchMeansReproducibleTest)
+{
+  constexpr unsigned int n_batches = 1000u;
+  pdmpmt_mcpi_ci ci_1, ci_2;
+  ASSERT_FALSE(
+    pdmpmt_mcpi_batch_means_ci(
+      uneven_circle_counts_, uneven_sample_counts_, n_batches, level_, &ci_1
+    )
+  );
+#ifdef _OPENMP
+  auto n_threads = omp_get_max_threads();
+  omp_set_num_threads(n_threads + 3);
+#endif  // _OPENMP
+  ASSERT_FALSE(
+    pdmpmt_mcpi_batch_means_ci(
+      uneven_circle_counts_, uneven_sample_counts_, n_batches, level_, &ci_2
+    )
+  );
+#ifdef _OPENMP
+  omp_set_num_threads(n_threads);
+#endif  // _OPENMP
+  EXPECT_EQ(ci_1.std_error, ci_2.std_error);
+  EXPECT_EQ(ci_1.lower, ci_2.lower);
+  EXPECT_EQ(ci_1.upper, ci_2.upper);
+}
+
+}  // namespace
@@ -0,0 +1,241 @@
+/**
+ * @file mcpi_record_test.cc
+ * @author Derek Huang
+ * @brief mcpi_record.h and mcpi_merge.hh unit tests
+ * @copyright MIT License
+ */
+
+#include "pdmpmt/mcpi_merge.hh"
+#include "pdmpmt/mcpi_record.h"
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "pdmpmt/mcpi.h"
+
+namespace {
+
+/**
+ * Test fixture for the partial count record tests.
+ */
+class MCPiRecordTest : public ::testing::Test {
+protected:
+  // run layout used for the emit tests
+  static constexpr pdmpmt_mcpi_run run_{
+    PDMPMT_RNG_MRG32K3A, 8888u, 100003u, 4u
+  };
+  // record used for the codec tests
+  static constexpr pdmpmt_mcpi_record rec_{
+    UINT64_C(0x0123456789abcdef), 1000u, 500u, 393u
+  };
+
+  /**
+   * Return a record for a range of the run with the given run identifier.
+   *
+   * @param run_id Run identifier
+   * @param first Global index of the first sample
+   * @param n_samples Number of samples
+   */
+  static auto make_record(
+    std::uint64_t run_id, std::uint64_t first, std::uint64_t n_samples)
+  {
+    return pdmpmt_mcpi_record{run_id, first, n_samples, n_samples / 2};
+  }
+};
+
+/**
+ * Test that records decode to what was encoded.
+ */
+TEST_F(MCPiRecordTest, CodecTest)
+{
+  unsigned char buf[PDMPMT_MCPI_RECORD_SIZE];
+  pdmpmt_mcpi_record_encode(&rec_, buf);
+  // little-endian length prefix
+  EXPECT_EQ(PDMPMT_MCPI_RECORD_PAYLOAD_SIZE, buf[0]);
+  EXPECT_EQ(0u, buf[1] | buf[2] | buf[3]);
+  pdmpmt_mcpi_record rec;
+  std::size_t n_read;
+  ASSERT_EQ(1, pdmpmt_mcpi_record_decode(buf, sizeof buf, &rec, &n_read));
+  EXPECT_EQ(sizeof buf, n_read);
+  EXPECT_EQ(rec_.run_id, rec.run_id);
+  EXPECT_EQ(rec_.first, rec.first);
+  EXPECT_EQ(rec_.n_samples, rec.n_samples);
+  EXPECT_EQ(rec_.n_inside, rec.n_inside);
+  // incomplete records need more bytes
+  EXPECT_EQ(0, pdmpmt_mcpi_record_decode(buf, 2u, &rec, &n_read));
+  EXPECT_EQ(0, pdmpmt_mcpi_record_decode(buf, sizeof buf - 1, &rec, &n_read));
+  // lengths shorter than the known payload are malformed
+  buf[0] = 8u;
+  EXPECT_EQ(-1, pdmpmt_mcpi_record_decode(buf, sizeof buf, &rec, &n_read));
+}
+
+/**
+ * Test that run identifiers hash the seed truncated to unsigned.
+ *
+ * The estimators only use the truncated seed, so seeds differing above the
+ * low `unsigned` bits give the same samples and must give the same run.
+ */
+TEST_F(MCPiRecordTest, RunIdTest)
+{
+  auto run = run_;
+  auto run_id = pdmpmt_mcpi_run_id(&run);
+  run.seed++;
+  EXPECT_NE(run_id, pdmpmt_mcpi_run_id(&run));
+  if constexpr (sizeof(unsigned long) > sizeof(unsigned)) {
+    run.seed = run_.seed + (1ul << (8 * sizeof(unsigned)));
+    EXPECT_EQ(run_id, pdmpmt_mcpi_run_id(&run));
+  }
+}
+
+/**
+ * Test that payload bytes appended by a newer version are skipped.
+ */
+TEST_F(MCPiRecordTest, ExtendedPayloadTest)
+{
+  std::vector<unsigned char> buf(PDMPMT_MCPI_RECORD_SIZE + 8u, 0xffu);
+  pdmpmt_mcpi_record_encode(&rec_, buf.data());
+  buf[0] = PDMPMT_MCPI_RECORD_PAYLOAD_SIZE + 8u;
+  pdmpmt_mcpi_record rec;
+  std::size_t n_read;
+  ASSERT_EQ(
+    1, pdmpmt_mcpi_record_decode(buf.data(), buf.size(), &rec, &n_read)
+  );
+  EXPECT_EQ(buf.size(), n_read);
+  EXPECT_EQ(rec_.n_inside, rec.n_inside);
+}
+
+/**
+ * Test that records fed a byte at a time are all decoded.
+ */
+TEST_F(MCPiRecordTest, ReaderTest)
+{
+  constexpr unsigned int n_records = 3u;
+  std::vector<unsigned char> buf(n_records * PDMPMT_MCPI_RECORD_SIZE);
+  for (unsigned int i = 0; i < n_records; i++) {
+    auto rec = make_record(1u, 100u * i, 100u);
+    pdmpmt_mcpi_record_encode(&rec, buf.data() + i * PDMPMT_MCPI_RECORD_SIZE);
+  }
+  pdmpmt::mcpi_record_reader reader;
+  std::vector<pdmpmt_mcpi_record> recs;
+  for (auto byte : buf)
+    ASSERT_TRUE(
+      reader.feed(&byte, 1u, [&recs](const auto& rec) { recs.push_back(rec); })
+    );
+  EXPECT_EQ(0u, reader.n_pending());
+  ASSERT_EQ(n_records, recs.size());
+  for (unsigned int i = 0; i < n_records; i++)
+    EXPECT_EQ(100u * i, recs[i].first);
+}
+
+/**
+ * Test that records covered by accepted ranges of their run are dropped.
+ */
+TEST_F(MCPiRecordTest, MergerTest)
+{
+  pdmpmt::mcpi_merger merger;
+  EXPECT_TRUE(merger.add(make_record(1u, 100u, 100u)));
+  // exact duplicate, partial overlaps on either side, and containment
+  EXPECT_FALSE(merger.add(make_record(1u, 100u, 100u)));
+  EXPECT_FALSE(merger.add(make_record(1u, 50u, 51u)));
+  EXPECT_FALSE(merger.add(make_record(1u, 199u, 10u)));
+  EXPECT_FALSE(merger.add(make_record(1u, 0u, 1000u)));
+  // adjacent ranges, an empty range, and the same range of another run
+  EXPECT_TRUE(merger.add(make_record(1u, 0u, 100u)));
+  EXPECT_TRUE(merger.add(make_record(1u, 200u, 100u)));
+  EXPECT_FALSE(merger.add(make_record(1u, 400u, 0u)));
+  EXPECT_TRUE(merger.add(make_record(2u, 100u, 100u)));
+  EXPECT_EQ(9u, merger.n_records());
+  EXPECT_EQ(5u, merger.n_dropped());
+  // without a run layout, the partial overlaps are conflicts
+  EXPECT_EQ(3u, merger.n_conflicts());
+  EXPECT_EQ(0u, merger.n_clipped());
+  EXPECT_EQ(2u, merger.n_runs());
+  EXPECT_EQ(400u, merger.n_samples());
+  EXPECT_EQ(200u, merger.n_inside());
+  EXPECT_DOUBLE_EQ(2., merger.estimate());
+}
+
+/**
+ * Test that overlapping emitted ranges merge to the count of their union.
+ *
+ * The first range starts off a chunk boundary, but the chunks the ranges
+ * share are identical since chunks are aligned to multiples of the chunk size.
+ */
+TEST_F(MCPiRecordTest, EmitTest)
+{
+  constexpr std::size_t chunk_size = 10000u;
+  auto file = std::tmpfile();
+  ASSERT_TRUE(file);
+  auto fd = fileno(file);
+  ASSERT_EQ(0, pdmpmt_mcpi_emit(&run_, 1234u, 58766u, chunk_size, fd));
+  ASSERT_EQ(0, pdmpmt_mcpi_emit(&run_, 40000u, 50000u, chunk_size, fd));
+  // out of range
+  EXPECT_EQ(-1, pdmpmt_mcpi_emit(&run_, 100000u, 4u, chunk_size, fd));
+  std::rewind(file);
+  std::vector<unsigned char> buf(1u << 16);
+  auto size = std::fread(buf.data(), 1u, buf.size(), file);
+  std::fclose(file);
+  pdmpmt::mcpi_merger merger;
+  pdmpmt::mcpi_record_reader reader;
+  ASSERT_TRUE(
+    reader.feed(
+      buf.data(), size, [&merger](const auto& rec) { merger.add(rec); }
+    )
+  );
+  EXPECT_EQ(0u, reader.n_pending());
+  // union is [1234, 90000)
+  std::size_t n_inside;
+  ASSERT_EQ(0, pdmpmt_mcpi_count_range(&run_, 1234u, 88766u, &n_inside));
+  EXPECT_EQ(88766u, merger.n_samples());
+  EXPECT_EQ(n_inside, merger.n_inside());
+  EXPECT_EQ(1u, merger.n_runs());
+}
+
+/**
+ * Test that records emitted with different chunk sizes are clipped.
+ *
+ * The chunks of the two ranges do not line up, so records partially overlap.
+ * Given the run layout, the merger recounts the uncovered parts and gets the
+ * count of the whole run, while without it, the partial overlaps conflict.
+ */
+TEST_F(MCPiRecordTest, ClipTest)
+{
+  auto file = std::tmpfile();
+  ASSERT_TRUE(file);
+  auto fd = fileno(file);
+  ASSERT_EQ(0, pdmpmt_mcpi_emit(&run_, 0u, 61234u, 7000u, fd));
+  ASSERT_EQ(0, pdmpmt_mcpi_emit(&run_, 35000u, 65003u, 10000u, fd));
+  std::rewind(file);
+  std::vector<unsigned char> buf(1u << 16);
+  auto size = std::fread(buf.data(), 1u, buf.size(), file);
+  std::fclose(file);
+  pdmpmt::mcpi_merger merger;
+  merger.add_run(run_);
+  pdmpmt::mcpi_merger strict_merger;
+  pdmpmt::mcpi_record_reader reader;
+  ASSERT_TRUE(
+    reader.feed(
+      buf.data(),
+      size,
+      [&](const auto& rec)
+      {
+        merger.add(rec);
+        strict_merger.add(rec);
+      }
+    )
+  );
+  std::size_t n_inside;
+  ASSERT_EQ(0, pdmpmt_mcpi_count_range(&run_, 0u, 100003u, &n_inside));
+  EXPECT_EQ(100003u, merger.n_samples());
+  EXPECT_EQ(n_inside, merger.n_inside());
+  EXPECT_EQ(0u, merger.n_conflicts());
+  EXPECT_LT(0u, merger.n_clipped());
+  EXPECT_LT(0u, strict_merger.n_conflicts());
+  EXPECT_GT(100003u, strict_merger.n_samples());
+}
+
+}  // namespace
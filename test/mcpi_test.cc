@@ -9,25 +9,23 @@
 #include "pdmpmt/mcpi.hh"
 
 #include <cmath>
+#include <cstddef>
 #include <cstdint>
+#include <random>
 #include <string>
 
 #include <gtest/gtest.h>
 
 #include "pdmpmt/common.h"
 #include "pdmpmt/features.h"
+#include "pdmpmt/mcpi_pool.hh"
+#include "testing.hh"
 
 // can use <numbers> for pi
 #if PDMPMT_HAS_CC20
 #include <numbers>
 #endif  // !PDMPMT_HAS_CC20
 
-/**
- * Macro for test skipping when compiler does not implement OpenMP.
- */
-#define PDMPMT_NO_OMP_GTEST_SKIP() \
-  GTEST_SKIP() << "C++ compiler doesn't implement OpenMP"
-
 namespace {
 
 /**
@@ -83,6 +81,120 @@ TEST_F(MCPiTestC, SerialTestMT19937)
   );
 }
 
+/**
+ * Test that C coarse-then-fine Monte Carlo pi estimation works with MRG32k3a.
+ *
+ * Also checks that far fewer than the 64 bits per sample used by the direct
+ * sampling method are drawn, including the bits lost to rejection.
+ */
+TEST_F(MCPiTestC, CoarseFineTestMRG32k3a)
+{
+  std::size_t n_bits;
+  auto n_inside = pdmpmt_rng_unit_circle_samples_cf(
+    n_samples_, PDMPMT_RNG_MRG32K3A, seed_, &n_bits
+  );
+  EXPECT_NEAR(pi_, 4. * n_inside / n_samples_, pi_tol_);
+  EXPECT_LT(n_bits, 24 * n_samples_);
+}
+
+/**
+ * Test that C coarse-then-fine Monte Carlo pi estimation works with MT19937.
+ */
+TEST_F(MCPiTestC, CoarseFineTestMT19937)
+{
+  std::size_t n_bits;
+  auto n_inside = pdmpmt_rng_unit_circle_samples_cf(
+    n_samples_, PDMPMT_RNG_MT19937, seed_, &n_bits
+  );
+  EXPECT_NEAR(pi_, 4. * n_inside / n_samples_, pi_tol_);
+  EXPECT_LT(n_bits, 18 * n_samples_);
+}
+
+/**
+ * Check that indexed access reproduces the samples of the C estimators.
+ *
+ * @param rng_type PRNG type
+ * @param seed Seed value for the run
+ * @param n_samples Number of samples in the run
+ * @param n_jobs Number of jobs in the run
+ */
+void check_random_access(
+  pdmpmt_rng_type rng_type,
+  unsigned int seed,
+  std::size_t n_samples,
+  unsigned int n_jobs)
+{
+  pdmpmt_mcpi_run run{rng_type, seed, n_samples, n_jobs};
+  // each job's count matches the count drawn from its seed from the start
+  auto seeds = pdmpmt_rng_generate_seeds(n_jobs, rng_type, seed);
+  std::size_t total = 0;
+  for (unsigned int i = 0; i < n_jobs; i++) {
+    std::size_t first, n, n_inside;
+    ASSERT_EQ(0, pdmpmt_mcpi_job_range(&run, i, &first, &n));
+    ASSERT_EQ(0, pdmpmt_mcpi_count_range(&run, first, n, &n_inside));
+    EXPECT_EQ(
+      pdmpmt_rng_unit_circle_samples(
+        n, rng_type, static_cast<unsigned>(seeds.data[i])
+      ),
+      n_inside
+    );
+    total += n_inside;
+  }
+  pdmpmt_block_ulong_free(&seeds);
+  // a range spanning all the jobs gives the total count
+  std::size_t n_inside;
+  ASSERT_EQ(0, pdmpmt_mcpi_count_range(&run, 0, n_samples, &n_inside));
+  EXPECT_EQ(total, n_inside);
+#ifdef _OPENMP
+  EXPECT_EQ(
+    pdmpmt_rng_smcpi_ompm(n_samples, rng_type, n_jobs, seed),
+    4 * (static_cast<double>(total) / n_samples)
+  );
+#endif  // _OPENMP
+  // single samples around the start of job 1 agree with the range count
+  std::size_t first, n;
+  ASSERT_EQ(0, pdmpmt_mcpi_job_range(&run, 1u, &first, &n));
+  std::size_t n_points_inside = 0;
+  for (auto i = first - 2; i < first + 3; i++) {
+    pdmpmt_mcpi_point point;
+    ASSERT_EQ(0, pdmpmt_mcpi_sample_at(&run, i, &point));
+    EXPECT_EQ(point.x * point.x + point.y * point.y <= 1, !!point.inside);
+    n_points_inside += !!point.inside;
+  }
+  ASSERT_EQ(0, pdmpmt_mcpi_count_range(&run, first - 2, 5u, &n_inside));
+  EXPECT_EQ(n_inside, n_points_inside);
+  // out of range accesses are rejected
+  pdmpmt_mcpi_point point;
+  EXPECT_EQ(-1, pdmpmt_mcpi_sample_at(&run, n_samples, &point));
+  EXPECT_EQ(-1, pdmpmt_mcpi_count_range(&run, n_samples - 1, 2u, &n_inside));
+  EXPECT_EQ(-1, pdmpmt_mcpi_job_range(&run, n_jobs, &first, &n));
+  // the serial run is the single stream drawn from the seed
+  run.n_jobs = PDMPMT_MCPI_SERIAL_RUN;
+  ASSERT_EQ(0, pdmpmt_mcpi_count_range(&run, 0, n_samples, &n_inside));
+  EXPECT_EQ(
+    pdmpmt_rng_unit_circle_samples(n_samples, rng_type, seed), n_inside
+  );
+}
+
+/**
+ * Test that C indexed sample access reproduces MRG32k3a runs.
+ *
+ * The sample count is not a multiple of the job count so that job sample
+ * counts differ.
+ */
+TEST_F(MCPiTestC, RandomAccessTestMRG32k3a)
+{
+  check_random_access(PDMPMT_RNG_MRG32K3A, seed_, n_samples_ + 3, n_jobs_);
+}
+
+/**
+ * Test that C indexed sample access reproduces MT19937 runs.
+ */
+TEST_F(MCPiTestC, RandomAccessTestMT19937)
+{
+  check_random_access(PDMPMT_RNG_MT19937, seed_, n_samples_ + 3, n_jobs_);
+}
+
 /**
  * Test that C OpenMP estimation of pi using Monte Carlo works as expected.
  *
@@ -105,6 +217,50 @@ TEST_F(MCPiTestCC, SerialTest)
   EXPECT_NEAR(pi_, pdmpmt::mcpi(n_samples_, seed_), pi_tol_);
 }
 
+/**
+ * Test that C++ coarse-then-fine estimation of pi works as expected.
+ */
+TEST_F(MCPiTestCC, CoarseFineTest)
+{
+  EXPECT_NEAR(pi_, pdmpmt::mcpi_cf(n_samples_, seed_), pi_tol_);
+  std::size_t n_bits;
+  pdmpmt::detail::unit_circle_samples_cf(
+    n_samples_, std::mt19937_64{seed_}, &n_bits
+  );
+  EXPECT_LT(n_bits, 18 * n_samples_);
+}
+
+/**
+ * Test that the cell classification table brackets the unit circle.
+ *
+ * The inside cells must cover less and the non-outside cells more than the
+ * pi / 4 area of the quadrant, and each row must be inside-then-boundary.
+ * The hand-written C tables must also match the computed C++ tables.
+ */
+TEST_F(MCPiTestCC, CellTableTest)
+{
+  using pdmpmt::detail::mcpi_cells;
+  using pdmpmt::detail::mcpi_n_cells;
+  double n_inner = 0;
+  double n_outer = 0;
+  for (unsigned a = 0; a < mcpi_n_cells; a++) {
+    ASSERT_LE(mcpi_cells.inner[a], mcpi_cells.outer[a]);
+    n_inner += mcpi_cells.inner[a];
+    n_outer += mcpi_cells.outer[a];
+  }
+  constexpr double n_cells = mcpi_n_cells * mcpi_n_cells;
+  EXPECT_LT(4 * n_inner / n_cells, pi_);
+  EXPECT_GT(4 * n_outer / n_cells, pi_);
+  // the C tables are written out separately and must match entry by entry
+  const std::uint16_t* inner;
+  const std::uint16_t* outer;
+  ASSERT_EQ(mcpi_n_cells, pdmpmt_mcpi_cell_tables(&inner, &outer));
+  for (unsigned a = 0; a < mcpi_n_cells; a++) {
+    EXPECT_EQ(mcpi_cells.inner[a], inner[a]) << "row " << a;
+    EXPECT_EQ(mcpi_cells.outer[a], outer[a]) << "row " << a;
+  }
+}
+
 /**
  * Test that C++ async estimation of pi using Monte Carlo works as expected.
  */
@@ -113,6 +269,38 @@ TEST_F(MCPiTestCC, AsyncTest)
   EXPECT_NEAR(pi_, pdmpmt::mcpi_async(n_samples_, seed_, n_jobs_), pi_tol_);
 }
 
+/**
+ * Test that C++ worker pool estimation of pi using Monte Carlo works.
+ */
+TEST_F(MCPiTestCC, PoolTest)
+{
+  pdmpmt::worker_pool pool{n_jobs_};
+  EXPECT_NEAR(pi_, pdmpmt::mcpi_pool(n_samples_, seed_, pool), pi_tol_);
+  // same seed and pool size gives the same split, so the same estimate
+  EXPECT_EQ(
+    pdmpmt::mcpi_pool(n_samples_, seed_, pool),
+    pdmpmt::mcpi_pool(n_samples_, seed_, pool)
+  );
+}
+
+/**
+ * Test that C++ hedged chunk estimation of pi using Monte Carlo works.
+ */
+TEST_F(MCPiTestCC, HedgedTest)
+{
+  constexpr auto n_chunks = 4 * n_jobs_;
+  pdmpmt::worker_pool pool{n_jobs_};
+  // zero slowdown hedges every chunk still running at the end of the run
+  auto pi_hat = pdmpmt::mcpi_hedged(n_samples_, seed_, pool, n_chunks, {0.});
+  EXPECT_NEAR(pi_, pi_hat, pi_tol_);
+  // chunks are fixed by their seeds, so neither hedging nor the pool size
+  // changes the estimate. a single worker is never idle so never hedges
+  pdmpmt::worker_pool serial_pool{1u};
+  EXPECT_EQ(
+    pi_hat, pdmpmt::mcpi_hedged(n_samples_, seed_, serial_pool, n_chunks)
+  );
+}
+
 /**
  * Test that C++ OpenMP estimation of pi using Monte Carlo works as expected.
  *
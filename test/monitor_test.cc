@@ -0,0 +1,165 @@
+/**
+ * @file monitor_test.cc
+ * @author Derek Huang
+ * @brief monitor.h unit tests
+ * @copyright MIT License
+ */
+
+#include "pdmpmt/monitor.h"
+
+#include <cstdint>
+#include <cstring>
+
+#include <gtest/gtest.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif  // _WIN32
+
+#include "pdmpmt/mcpi.h"
+
+namespace {
+
+/**
+ * Test fixture for the shared memory monitor tests.
+ */
+class MonitorTest : public ::testing::Test {
+protected:
+  /**
+   * Clean up the monitors.
+   *
+   * @note Closing `NULL` monitors is a no-op.
+   */
+  ~MonitorTest()
+  {
+    pdmpmt_monitor_close(reader_);
+    pdmpmt_monitor_close(writer_);
+  }
+
+  // number of worker slots
+  static constexpr unsigned int n_workers_ = 4u;
+  pdmpmt_monitor* writer_{};
+  pdmpmt_monitor* reader_{};
+};
+
+/**
+ * Test that published counters are seen by a read-only attachment.
+ */
+TEST_F(MonitorTest, PublishReadTest)
+{
+  writer_ = pdmpmt_monitor_create("pdmpmt_test_publish_read", n_workers_);
+  ASSERT_TRUE(writer_) << "monitor creation failed";
+  reader_ = pdmpmt_monitor_open("pdmpmt_test_publish_read");
+  ASSERT_TRUE(reader_) << "monitor attachment failed";
+  EXPECT_EQ(n_workers_, pdmpmt_monitor_n_workers(reader_));
+  // publish distinct counters per worker, ignoring out of range workers
+  for (unsigned int i = 0; i < n_workers_ + 1; i++) {
+    pdmpmt_monitor_counts counts{1000u * i, 100u * i, 10u * i};
+    pdmpmt_monitor_publish(writer_, i, &counts);
+  }
+  for (unsigned int i = 0; i < n_workers_; i++) {
+    pdmpmt_monitor_counts counts;
+    ASSERT_EQ(0, pdmpmt_monitor_read(reader_, i, &counts));
+    EXPECT_EQ(1000u * i, counts.n_target);
+    EXPECT_EQ(100u * i, counts.n_done);
+    EXPECT_EQ(10u * i, counts.n_inside);
+  }
+}
+
+/**
+ * Test that attaching to a missing segment fails.
+ */
+TEST_F(MonitorTest, OpenMissingTest)
+{
+  EXPECT_FALSE(pdmpmt_monitor_open("pdmpmt_test_missing"));
+}
+
+/**
+ * Test that a slot left mid-update by a dead writer is reported as torn.
+ *
+ * The writer is simulated by making the sequence number of the first slot,
+ * which follows the 64-byte segment header, odd through a second mapping.
+ * This test is skipped on Windows.
+ */
+TEST_F(MonitorTest, TornReadTest)
+{
+#ifndef _WIN32
+  writer_ = pdmpmt_monitor_create("pdmpmt_test_torn_read", n_workers_);
+  ASSERT_TRUE(writer_) << "monitor creation failed";
+  pdmpmt_monitor_counts counts{1000u, 100u, 10u};
+  pdmpmt_monitor_publish(writer_, 0, &counts);
+  auto fd = shm_open("/pdmpmt_test_torn_read", O_RDWR, 0);
+  ASSERT_GE(fd, 0) << "shm_open failed";
+  constexpr auto size = 2 * 64u;
+  auto addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  ASSERT_NE(MAP_FAILED, addr) << "mmap failed";
+  std::uint64_t seq;
+  std::memcpy(&seq, static_cast<char*>(addr) + 64, sizeof seq);
+  seq++;
+  std::memcpy(static_cast<char*>(addr) + 64, &seq, sizeof seq);
+  munmap(addr, size);
+  // read must fail without touching the counters
+  pdmpmt_monitor_counts read_counts{1u, 2u, 3u};
+  EXPECT_EQ(-1, pdmpmt_monitor_read(writer_, 0, &read_counts));
+  EXPECT_EQ(1u, read_counts.n_target);
+  EXPECT_EQ(2u, read_counts.n_done);
+  EXPECT_EQ(3u, read_counts.n_inside);
+  // other slots are unaffected
+  EXPECT_EQ(0, pdmpmt_monitor_read(writer_, 1, &read_counts));
+#else
+  GTEST_SKIP() << "Test uses POSIX shared memory";
+#endif  // _WIN32
+}
+
+/**
+ * Test that closing a monitor uninstalls it only if it is installed.
+ */
+TEST_F(MonitorTest, CloseUninstallTest)
+{
+  writer_ = pdmpmt_monitor_create("pdmpmt_test_close_uninstall", n_workers_);
+  ASSERT_TRUE(writer_) << "monitor creation failed";
+  auto other = pdmpmt_monitor_create("pdmpmt_test_close_other", n_workers_);
+  ASSERT_TRUE(other) << "monitor creation failed";
+  pdmpmt_monitor_install(writer_);
+  pdmpmt_monitor_close(other);
+  EXPECT_EQ(writer_, pdmpmt_monitor_installed());
+  pdmpmt_monitor_close(writer_);
+  writer_ = nullptr;
+  EXPECT_FALSE(pdmpmt_monitor_installed());
+}
+
+/**
+ * Test that the OpenMP estimator publishes final counts for each job.
+ *
+ * If the compiler does not support OpenMP, this test is skipped.
+ */
+TEST_F(MonitorTest, OpenMPPublishTest)
+{
+#ifdef _OPENMP
+  writer_ = pdmpmt_monitor_create("pdmpmt_test_omp_publish", n_workers_);
+  ASSERT_TRUE(writer_) << "monitor creation failed";
+  pdmpmt_monitor_install(writer_);
+  constexpr std::size_t n_samples = 1000000;
+  auto pi_hat = pdmpmt_mt32_smcpi_ompm(n_samples, n_workers_, 8888);
+  pdmpmt_monitor_install(nullptr);
+  // totals must add up and give the same estimate
+  std::uint64_t n_done = 0;
+  std::uint64_t n_inside = 0;
+  for (unsigned int i = 0; i < n_workers_; i++) {
+    pdmpmt_monitor_counts counts;
+    ASSERT_EQ(0, pdmpmt_monitor_read(writer_, i, &counts));
+    EXPECT_EQ(counts.n_target, counts.n_done);
+    n_done += counts.n_done;
+    n_inside += counts.n_inside;
+  }
+  EXPECT_EQ(n_samples, n_done);
+  EXPECT_DOUBLE_EQ(pi_hat, 4 * (static_cast<double>(n_inside) / n_done));
+#else
+  GTEST_SKIP() << "C++ compiler doesn't implement OpenMP";
+#endif  // _OPENMP
+}
+
+}  // namespace
@@ -0,0 +1,170 @@
+/**
+ * @file reduce_test.cc
+ * @author Derek Huang
+ * @brief reduce.hh unit tests
+ * @copyright MIT License
+ */
+
+#include "pdmpmt/reduce.hh"
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "pdmpmt/worker_pool.hh"
+#include "testing.hh"
+
+namespace {
+
+/**
+ * Test fixture for the reproducible reduction tests.
+ */
+class ReduceTest : public ::testing::Test {
+protected:
+  // number of chunks of the Monte Carlo integral
+  static constexpr std::size_t n_chunks_ = 97u;
+  // base number of samples per chunk. partial() adds up to 600 more samples
+  // depending on the chunk index so that chunks are uneven
+  static constexpr std::size_t chunk_size_ = 1000u;
+  // PRNG seed
+  static constexpr std::uint_fast64_t seed_ = 8888u;
+
+  /**
+   * Return a chunk partial of the Monte Carlo integral of exp over [0, 1].
+   *
+   * The partial only depends on the chunk index, as each chunk is seeded with
+   * its own PRNG.
+   *
+   * @tparam T Partial type
+   *
+   * @param chunk Chunk index
+   */
+  template <typename T>
+  static T partial(std::size_t chunk)
+  {
+    std::mt19937_64 rng{seed_ + chunk};
+    std::uniform_real_distribution u{0., 1.};
+    T sum{};
+    for (std::size_t i = 0; i < chunk_size_ + chunk % 7u * 100u; i++)
+      sum += std::exp(u(rng));
+    return sum;
+  }
+};
+
+/**
+ * Test that compensated summation recovers low-order bits.
+ */
+TEST_F(ReduceTest, CompensatedTest)
+{
+  std::vector<double> values{1e16, 1., -1e16, 1.};
+  // the first 1 is lost to rounding by a sequential sum
+  EXPECT_EQ(1., std::accumulate(values.begin(), values.end(), 0.));
+  pdmpmt::compensated<double> sum;
+  for (auto value : values)
+    sum += value;
+  EXPECT_EQ(2., sum.value());
+  // merging compensated partials keeps both errors
+  pdmpmt::compensated<double> a{1e16}, b{-1e16};
+  a += 1.;
+  b += 1.;
+  EXPECT_EQ(2., (a + b).value());
+}
+
+/**
+ * Test that pairwise summation is more accurate than a sequential sum.
+ */
+TEST_F(ReduceTest, PairwiseSumTest)
+{
+  std::vector<double> values(1000003u, 0.1);
+  long double exact = 0.1L * static_cast<long double>(values.size());
+  auto naive = std::accumulate(values.begin(), values.end(), 0.);
+  auto pairwise = pdmpmt::pairwise_sum(values.begin(), values.end());
+  EXPECT_LT(
+    std::abs(static_cast<long double>(pairwise) - exact),
+    std::abs(static_cast<long double>(naive) - exact)
+  );
+  EXPECT_NEAR(static_cast<double>(exact), pairwise, 1e-8);
+  // short ranges are summed sequentially
+  EXPECT_EQ(0., pdmpmt::pairwise_sum(values.begin(), values.begin()));
+  EXPECT_EQ(
+    0.1 + 0.1 + 0.1, pdmpmt::pairwise_sum(values.data(), values.data() + 3)
+  );
+}
+
+/**
+ * Test that the reduction tree only depends on the number of partials.
+ */
+TEST_F(ReduceTest, TreeReduceTest)
+{
+  std::vector<double> values{0.1, 0.7, 1e-17, 3.3, -2.9};
+  auto [a, b, c, d, e] = std::array{0.1, 0.7, 1e-17, 3.3, -2.9};
+  EXPECT_EQ(
+    (a + b) + (c + (d + e)), pdmpmt::tree_reduce(values.begin(), values.end())
+  );
+  EXPECT_EQ(0., pdmpmt::tree_reduce(values.begin(), values.begin()));
+}
+
+/**
+ * Test that every backend gives bitwise-identical results.
+ *
+ * Pools of different sizes claim chunks in different orders, and OpenMP
+ * teams of different sizes schedule them dynamically, but each reduces the
+ * same chunk partials with the same tree.
+ */
+TEST_F(ReduceTest, ReproducibleTest)
+{
+  auto expected =
+    pdmpmt::reproducible_reduce<double>(n_chunks_, partial<double>);
+  auto expected_c = pdmpmt::reproducible_reduce<pdmpmt::compensated<double>>(
+    n_chunks_, partial<pdmpmt::compensated<double>>
+  );
+  // sanity check against the integral e - 1
+  double n_samples = 0.;
+  for (std::size_t i = 0; i < n_chunks_; i++)
+    n_samples += static_cast<double>(chunk_size_ + i % 7u * 100u);
+  EXPECT_NEAR(std::exp(1.) - 1., expected / n_samples, 1e-2);
+  EXPECT_NEAR(expected, expected_c.value(), 1e-9 * expected);
+  for (unsigned int n_threads = 1u; n_threads <= 5u; n_threads++) {
+    pdmpmt::worker_pool pool{n_threads};
+    EXPECT_EQ(
+      expected,
+      pdmpmt::reproducible_reduce<double>(pool, n_chunks_, partial<double>)
+    ) << "pool size " << n_threads;
+    EXPECT_EQ(
+      expected_c.value(),
+      pdmpmt::reproducible_reduce<pdmpmt::compensated<double>>(
+        pool, n_chunks_, partial<pdmpmt::compensated<double>>
+      ).value()
+    ) << "pool size " << n_threads;
+  }
+}
+
+/**
+ * Test that OpenMP teams of any size give bitwise-identical results.
+ *
+ * If the compiler does not support OpenMP, this test is skipped.
+ */
+TEST_F(ReduceTest, OpenMPTest)
+{
+#ifdef _OPENMP
+  auto expected =
+    pdmpmt::reproducible_reduce<double>(n_chunks_, partial<double>);
+  for (unsigned int n_threads = 1u; n_threads <= 5u; n_threads++)
+    EXPECT_EQ(
+      expected,
+      pdmpmt::reproducible_reduce_omp<double>(
+        n_chunks_, partial<double>, n_threads
+      )
+    ) << "team size " << n_threads;
+#else
+  PDMPMT_NO_OMP_GTEST_SKIP();
+#endif  // !_OPENMP
+}
+
+}  // namespace
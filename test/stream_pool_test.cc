@@ -0,0 +1,225 @@
+/**
+ * @file stream_pool_test.cc
+ * @author Derek Huang
+ * @brief stream_pool.h unit tests
+ * @copyright MIT License
+ */
+
+#include "pdmpmt/stream_pool.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <set>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "pdmpmt/mcpi.h"
+
+namespace {
+
+/**
+ * Test fixture for the stream pool tests.
+ */
+class StreamPoolTest : public ::testing::Test {
+protected:
+  /**
+   * Clean up the pool.
+   *
+   * @note Destroying a `NULL` pool is a no-op.
+   */
+  ~StreamPoolTest()
+  {
+    pdmpmt_stream_pool_destroy(pool_);
+  }
+
+  /**
+   * Wait until all slots of a pool are ready.
+   *
+   * @param pool Pool to wait on
+   * @returns `true` if the pool was refilled in time, `false` otherwise
+   */
+  static bool wait_ready(const pdmpmt_stream_pool* pool)
+  {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{10};
+    auto capacity = pdmpmt_stream_pool_capacity(pool);
+    while (pdmpmt_stream_pool_n_ready(pool) < capacity) {
+      if (std::chrono::steady_clock::now() > deadline)
+        return false;
+      std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+    return true;
+  }
+
+  // number of cached streams
+  static constexpr unsigned int capacity_ = 4u;
+  // PRNG seed
+  static constexpr unsigned long seed_ = 8888u;
+  pdmpmt_stream_pool* pool_{};
+};
+
+/**
+ * Test that the refill thread prepares every slot and refills returned ones.
+ */
+TEST_F(StreamPoolTest, RefillTest)
+{
+  pool_ = pdmpmt_stream_pool_create(PDMPMT_RNG_MRG32K3A, seed_, capacity_);
+  ASSERT_TRUE(pool_) << "pool creation failed";
+  ASSERT_TRUE(wait_ready(pool_)) << "pool not filled";
+  std::vector<pdmpmt_stream_lease*> leases;
+  for (unsigned int i = 0; i < capacity_; i++) {
+    leases.push_back(pdmpmt_stream_pool_lease(pool_));
+    ASSERT_TRUE(leases.back());
+  }
+  EXPECT_EQ(0u, pdmpmt_stream_pool_n_ready(pool_));
+  // slots hold the first streams, each leased at its first substream
+  std::set<std::uint64_t> streams;
+  for (auto lease : leases) {
+    std::uint64_t stream, substream;
+    pdmpmt_stream_lease_position(lease, &stream, &substream);
+    EXPECT_LT(stream, capacity_);
+    EXPECT_EQ(0u, substream);
+    streams.insert(stream);
+    pdmpmt_stream_pool_return(pool_, lease);
+  }
+  EXPECT_EQ(capacity_, streams.size());
+  ASSERT_TRUE(wait_ready(pool_)) << "pool not refilled";
+}
+
+/**
+ * Test that leases past the capacity are uncached streams past the slots.
+ */
+TEST_F(StreamPoolTest, UncachedTest)
+{
+  pool_ = pdmpmt_stream_pool_create(PDMPMT_RNG_MRG32K3A, seed_, 1u);
+  ASSERT_TRUE(pool_) << "pool creation failed";
+  ASSERT_TRUE(wait_ready(pool_)) << "pool not filled";
+  auto cached = pdmpmt_stream_pool_lease(pool_);
+  auto uncached = pdmpmt_stream_pool_lease(pool_);
+  ASSERT_TRUE(cached && uncached);
+  std::uint64_t stream, substream;
+  pdmpmt_stream_lease_position(cached, &stream, &substream);
+  EXPECT_EQ(0u, stream);
+  pdmpmt_stream_lease_position(uncached, &stream, &substream);
+  EXPECT_EQ(1u, stream);
+  EXPECT_EQ(0u, substream);
+  pdmpmt_stream_pool_return(pool_, uncached);
+  pdmpmt_stream_pool_return(pool_, cached);
+}
+
+/**
+ * Test that leases are reproducible from their position in the hierarchy.
+ *
+ * With a single slot, successive leases are successive substreams of stream
+ * 0, so a second pool with the same seed draws the same values. Each lease
+ * waits for the refill since a lease made while the only slot is being
+ * refilled gets an uncached stream instead.
+ */
+TEST_F(StreamPoolTest, ReproducibleTest)
+{
+  constexpr std::size_t n_draws = 16u;
+  // draws of substreams 0 and 1 from a pool
+  auto draw = [](pdmpmt_stream_pool* pool)
+  {
+    std::vector<double> values(2 * n_draws);
+    for (unsigned int i = 0; i < 2u; i++) {
+      EXPECT_TRUE(wait_ready(pool)) << "pool not refilled";
+      auto lease = pdmpmt_stream_pool_lease(pool);
+      EXPECT_TRUE(lease);
+      if (!lease)
+        return values;
+      std::uint64_t stream, substream;
+      pdmpmt_stream_lease_position(lease, &stream, &substream);
+      EXPECT_EQ(0u, stream);
+      EXPECT_EQ(i, substream);
+      pdmpmt_stream_lease_uniform(lease, values.data() + i * n_draws, n_draws);
+      pdmpmt_stream_pool_return(pool, lease);
+    }
+    return values;
+  };
+  pool_ = pdmpmt_stream_pool_create(PDMPMT_RNG_MT19937, seed_, 1u);
+  ASSERT_TRUE(pool_) << "pool creation failed";
+  auto values = draw(pool_);
+  auto other = pdmpmt_stream_pool_create(PDMPMT_RNG_MT19937, seed_, 1u);
+  ASSERT_TRUE(other) << "pool creation failed";
+  EXPECT_EQ(values, draw(other));
+  pdmpmt_stream_pool_destroy(other);
+  // substreams are disjoint and the values are in (0, 1)
+  for (std::size_t i = 0; i < n_draws; i++) {
+    EXPECT_NE(values[i], values[n_draws + i]);
+    EXPECT_GT(values[i], 0.);
+    EXPECT_LT(values[i], 1.);
+  }
+}
+
+/**
+ * Test that concurrent lessees never get the same substream.
+ */
+TEST_F(StreamPoolTest, ConcurrentTest)
+{
+  constexpr unsigned int n_threads = 8u;
+  constexpr unsigned int n_leases = 200u;
+  pool_ = pdmpmt_stream_pool_create(PDMPMT_RNG_MRG32K3A, seed_, capacity_);
+  ASSERT_TRUE(pool_) << "pool creation failed";
+  using position = std::pair<std::uint64_t, std::uint64_t>;
+  std::vector<std::vector<position>> positions(n_threads);
+  std::vector<std::thread> threads;
+  for (unsigned int i = 0; i < n_threads; i++)
+    threads.emplace_back(
+      [this, &positions, i]
+      {
+        for (unsigned int j = 0; j < n_leases; j++) {
+          auto lease = pdmpmt_stream_pool_lease(pool_);
+          if (!lease)
+            return;
+          position pos;
+          pdmpmt_stream_lease_position(lease, &pos.first, &pos.second);
+          pdmpmt_stream_lease_unit_circle_samples(16u, lease);
+          pdmpmt_stream_pool_return(pool_, lease);
+          positions[i].push_back(pos);
+        }
+      }
+    );
+  for (auto& thread : threads)
+    thread.join();
+  std::set<position> unique;
+  for (const auto& thread_positions : positions) {
+    EXPECT_EQ(n_leases, thread_positions.size());
+    unique.insert(thread_positions.begin(), thread_positions.end());
+  }
+  EXPECT_EQ(n_threads * n_leases, unique.size());
+}
+
+/**
+ * Test that the pooled estimator uses the installed pool given `NULL`.
+ *
+ * Without a pool to lease from or with no samples, the estimate is NaN.
+ */
+TEST_F(StreamPoolTest, MCPiTest)
+{
+  pool_ = pdmpmt_stream_pool_create(PDMPMT_RNG_MRG32K3A, seed_, capacity_);
+  ASSERT_TRUE(pool_) << "pool creation failed";
+  pdmpmt_stream_pool_install(pool_);
+  ASSERT_EQ(pool_, pdmpmt_stream_pool_installed());
+  EXPECT_NEAR(
+    4 * std::atan(1), pdmpmt_stream_pool_mcpi(1000000u, nullptr), 1e-2
+  );
+  EXPECT_TRUE(std::isnan(pdmpmt_stream_pool_mcpi(0u, nullptr)));
+  // destroying another pool leaves the installed pool alone
+  auto other = pdmpmt_stream_pool_create(PDMPMT_RNG_MRG32K3A, seed_, 1u);
+  ASSERT_TRUE(other) << "pool creation failed";
+  pdmpmt_stream_pool_destroy(other);
+  EXPECT_EQ(pool_, pdmpmt_stream_pool_installed());
+  // destroying the installed pool uninstalls it
+  pdmpmt_stream_pool_destroy(pool_);
+  pool_ = nullptr;
+  EXPECT_FALSE(pdmpmt_stream_pool_installed());
+  // without an installed pool there is nothing to lease from
+  EXPECT_TRUE(std::isnan(pdmpmt_stream_pool_mcpi(1000u, nullptr)));
+}
+
+}  // namespace
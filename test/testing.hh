@@ -0,0 +1,19 @@
+/**
+ * @file testing.hh
+ * @author Derek Huang
+ * @brief C++ header for helpers shared by the unit tests
+ * @copyright MIT License
+ */
+
+#ifndef PDMPMT_TEST_TESTING_HH_
+#define PDMPMT_TEST_TESTING_HH_
+
+#include <gtest/gtest.h>
+
+/**
+ * Macro for test skipping when compiler does not implement OpenMP.
+ */
+#define PDMPMT_NO_OMP_GTEST_SKIP() \
+  GTEST_SKIP() << "C++ compiler doesn't implement OpenMP"
+
+#endif  // PDMPMT_TEST_TESTING_HH_
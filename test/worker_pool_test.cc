@@ -0,0 +1,130 @@
+/**
+ * @file worker_pool_test.cc
+ * @author Derek Huang
+ * @brief worker_pool.hh unit tests
+ * @copyright MIT License
+ */
+
+#include "pdmpmt/worker_pool.hh"
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+/**
+ * Test fixture for the worker pool tests.
+ */
+class WorkerPoolTest : public ::testing::Test {
+protected:
+  // pool size, including the calling thread
+  static constexpr unsigned int n_threads_ = 4u;
+  // number of tasks to run in the repeated run tests
+  static constexpr unsigned int n_runs_ = 100u;
+};
+
+/**
+ * Test that each worker index is run exactly once per task.
+ */
+TEST_F(WorkerPoolTest, RunTest)
+{
+  pdmpmt::worker_pool pool{n_threads_};
+  ASSERT_EQ(n_threads_, pool.size());
+  std::vector<unsigned int> counts(n_threads_);
+  for (unsigned int i = 0; i < n_runs_; i++)
+    pool.run([&counts](unsigned int index) { counts[index]++; });
+  for (auto count : counts)
+    EXPECT_EQ(n_runs_, count);
+}
+
+/**
+ * Test that idle workers park and are woken when the spin window is zero.
+ */
+TEST_F(WorkerPoolTest, ParkTest)
+{
+  pdmpmt::worker_pool pool{n_threads_, {std::chrono::nanoseconds{0}}};
+  std::atomic<unsigned int> count{};
+  for (unsigned int i = 0; i < n_runs_; i++) {
+    // give the workers time to park
+    std::this_thread::sleep_for(std::chrono::microseconds{200});
+    pool.run([&count](unsigned int) { count++; });
+  }
+  EXPECT_EQ(n_runs_ * n_threads_, count);
+  auto stats = pool.wake_statistics();
+  EXPECT_EQ(n_runs_ * (n_threads_ - 1u), stats.n_wakes());
+  EXPECT_LT(0u, stats.n_park_wakes);
+  EXPECT_LE(stats.quantile_ns(0.5), stats.quantile_ns(0.99));
+  EXPECT_LE(stats.quantile_ns(0.99), stats.max_ns);
+}
+
+/**
+ * Test that workers in hot standby never park.
+ */
+TEST_F(WorkerPoolTest, HotStandbyTest)
+{
+  pdmpmt::worker_pool pool{n_threads_, {std::chrono::nanoseconds{0}, 1u}};
+  EXPECT_EQ(1u, pool.hot_standby());
+  pool.hot_standby(n_threads_ - 1u);
+  // let the non-hot workers park at least once before being woken as hot
+  std::this_thread::sleep_for(std::chrono::microseconds{200});
+  pool.run([](unsigned int) {});
+  pool.reset_wake_statistics();
+  for (unsigned int i = 0; i < n_runs_; i++) {
+    std::this_thread::sleep_for(std::chrono::microseconds{200});
+    pool.run([](unsigned int) {});
+  }
+  auto stats = pool.wake_statistics();
+  EXPECT_EQ(n_runs_ * (n_threads_ - 1u), stats.n_spin_wakes);
+  EXPECT_EQ(0u, stats.n_park_wakes);
+}
+
+/**
+ * Test that the calling thread parks while waiting for a slow worker.
+ *
+ * The caller is never kept in hot standby, even when every worker is.
+ */
+TEST_F(WorkerPoolTest, CallerParkTest)
+{
+  pdmpmt::worker_pool pool{n_threads_, {std::chrono::nanoseconds{0}}};
+  pool.hot_standby(n_threads_);
+  for (unsigned int i = 0; i < 3u; i++)
+    pool.run(
+      [](unsigned int index)
+      {
+        if (index == n_threads_ - 1u)
+          std::this_thread::sleep_for(std::chrono::milliseconds{20});
+      }
+    );
+  EXPECT_EQ(3u, pool.wake_statistics().n_caller_parks);
+  pool.reset_wake_statistics();
+  EXPECT_EQ(0u, pool.wake_statistics().n_caller_parks);
+}
+
+/**
+ * Test that exceptions thrown by tasks are rethrown by `run`.
+ */
+TEST_F(WorkerPoolTest, ExceptionTest)
+{
+  pdmpmt::worker_pool pool{n_threads_};
+  EXPECT_THROW(
+    pool.run(
+      [](unsigned int index)
+      {
+        if (index == n_threads_ - 1u)
+          throw std::runtime_error{"worker failed"};
+      }
+    ),
+    std::runtime_error
+  );
+  // pool is still usable afterwards
+  std::atomic<unsigned int> count{};
+  pool.run([&count](unsigned int) { count++; });
+  EXPECT_EQ(n_threads_, count);
+}
+
+}  // namespace
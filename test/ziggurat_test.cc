@@ -0,0 +1,300 @@
+/**
+ * @file ziggurat_test.cc
+ * @author Derek Huang
+ * @brief ziggurat.h and ziggurat.hh unit tests
+ * @copyright MIT License
+ */
+
+#include "pdmpmt/ziggurat.h"
+#include "pdmpmt/ziggurat.hh"
+
+#include <cmath>
+#include <cstddef>
+#include <ios>
+#include <random>
+#include <sstream>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "pdmpmt/mcpi.h"
+
+namespace {
+
+/**
+ * Number of samples drawn per test.
+ */
+constexpr std::size_t n_samples = 1000000u;
+
+/**
+ * Seed value used for all the PRNGs.
+ */
+constexpr unsigned int seed = 8888u;
+
+/**
+ * Standard normal CDF.
+ *
+ * @param x Input value
+ */
+double normal_cdf(double x)
+{
+  return std::erfc(-x / std::sqrt(2.)) / 2;
+}
+
+/**
+ * Check the first two moments of samples against their expected values.
+ *
+ * With 1e6 samples the standard error of the mean is 1e-3 times the standard
+ * deviation, so the tolerances are about 5 standard errors.
+ *
+ * @param xs Samples
+ * @param mean Expected mean
+ * @param var Expected variance
+ */
+void check_moments(const std::vector<double>& xs, double mean, double var)
+{
+  double sum = 0.;
+  for (auto x : xs)
+    sum += x;
+  auto x_bar = sum / xs.size();
+  double ss = 0.;
+  for (auto x : xs)
+    ss += (x - x_bar) * (x - x_bar);
+  auto s2 = ss / (xs.size() - 1);
+  EXPECT_NEAR(mean, x_bar, 5e-3 * std::sqrt(var));
+  EXPECT_NEAR(var, s2, 1e-2 * var);
+}
+
+/**
+ * Check standard normal samples against the normal CDF and tail mass.
+ *
+ * The tail beyond the Ziggurat base layer has probability ~2.6e-4 and goes
+ * through the slow path, so its fraction checks the tail sampler.
+ *
+ * @param xs Samples
+ */
+void check_normal_shape(const std::vector<double>& xs)
+{
+  constexpr auto r = pdmpmt::detail::normal_ziggurat_r;
+  std::size_t n_below = 0;
+  std::size_t n_tail = 0;
+  for (auto x : xs) {
+    n_below += (x < 1.);
+    n_tail += (std::abs(x) > r);
+  }
+  auto n = static_cast<double>(xs.size());
+  EXPECT_NEAR(normal_cdf(1.), n_below / n, 2e-3);
+  auto p_tail = 2 * normal_cdf(-r);
+  EXPECT_NEAR(p_tail, n_tail / n, 5 * std::sqrt(p_tail / n));
+}
+
+/**
+ * Check that Ziggurat tables are consistent with their density.
+ *
+ * @tparam F Callable with signature `double(double)` for the density
+ *
+ * @param table Ziggurat tables
+ * @param n_bits Number of magnitude bits
+ * @param f Unnormalized density
+ */
+template <typename F>
+void check_table(
+  const pdmpmt_ziggurat_table& table, unsigned int n_bits, F f)
+{
+  auto m = std::ldexp(1., static_cast<int>(n_bits));
+  EXPECT_EQ(0u, table.k[1]);
+  EXPECT_EQ(1., table.f[0]);
+  for (std::size_t i = 1; i < PDMPMT_ZIGGURAT_N_LAYERS; i++) {
+    auto x = table.w[i] * m;
+    EXPECT_NEAR(f(x), table.f[i], 1e-12 * f(x)) << "layer " << i;
+    if (i < 2u)
+      continue;
+    auto k = m * table.w[i - 1] / table.w[i];
+    EXPECT_NEAR(k, static_cast<double>(table.k[i]), 4.) << "layer " << i;
+  }
+}
+
+/**
+ * Test that the Ziggurat tables match their densities.
+ */
+TEST(ZigguratTableTest, DensityTest)
+{
+  constexpr auto r = pdmpmt::detail::normal_ziggurat_r;
+  const auto& normal = *pdmpmt_ziggurat_normal_table();
+  EXPECT_EQ(&normal, &pdmpmt::detail::normal_ziggurat_table());
+  EXPECT_EQ(r, normal.w[PDMPMT_ZIGGURAT_N_LAYERS - 1] * std::ldexp(1., 52));
+  check_table(normal, 52u, [](double x) { return std::exp(-.5 * x * x); });
+  check_table(
+    *pdmpmt_ziggurat_exponential_table(),
+    53u,
+    [](double x) { return std::exp(-x); }
+  );
+}
+
+/**
+ * Test fixture for the C fill functions, parametrized over PRNG type.
+ */
+class ZigguratTest : public ::testing::TestWithParam<pdmpmt_rng_type> {};
+
+/**
+ * Test that normal samples have the right moments and shape.
+ */
+TEST_P(ZigguratTest, NormalFillTest)
+{
+  std::vector<double> xs(n_samples);
+  pdmpmt_rng_normal_fill(xs.data(), xs.size(), GetParam(), seed);
+  check_moments(xs, 0., 1.);
+  check_normal_shape(xs);
+}
+
+/**
+ * Test that exponential samples have the right moments and tail.
+ */
+TEST_P(ZigguratTest, ExponentialFillTest)
+{
+  std::vector<double> xs(n_samples);
+  pdmpmt_rng_exponential_fill(xs.data(), xs.size(), GetParam(), seed);
+  check_moments(xs, 1., 1.);
+  std::size_t n_tail = 0;
+  for (auto x : xs) {
+    ASSERT_GE(x, 0.);
+    n_tail += (x > 3.);
+  }
+  auto p_tail = std::exp(-3.);
+  EXPECT_NEAR(p_tail, n_tail / static_cast<double>(n_samples), 2e-3);
+}
+
+/**
+ * Test that the fill functions are deterministic given a seed.
+ *
+ * The length is not a multiple of the block size to cover a partial block.
+ */
+TEST_P(ZigguratTest, ReproducibleTest)
+{
+  constexpr std::size_t n = 1000u;
+  std::vector<double> xs(n), ys(n);
+  pdmpmt_rng_normal_fill(xs.data(), n, GetParam(), seed);
+  pdmpmt_rng_normal_fill(ys.data(), n, GetParam(), seed);
+  EXPECT_EQ(xs, ys);
+  pdmpmt_rng_exponential_fill(xs.data(), n, GetParam(), seed);
+  pdmpmt_rng_exponential_fill(ys.data(), n, GetParam(), seed);
+  EXPECT_EQ(xs, ys);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+  RngTypes,
+  ZigguratTest,
+  ::testing::Values(PDMPMT_RNG_MRG32K3A, PDMPMT_RNG_MT19937)
+);
+
+/**
+ * Test that scalar C++ normal samples have the right moments and shape.
+ */
+TEST(ZigguratTestCC, NormalScalarTest)
+{
+  std::mt19937 rng{seed};
+  pdmpmt::normal_ziggurat<> dist;
+  std::vector<double> xs(n_samples);
+  for (auto& x : xs)
+    x = dist(rng);
+  check_moments(xs, 0., 1.);
+  check_normal_shape(xs);
+}
+
+/**
+ * Test that bulk C++ normal samples are shifted and scaled.
+ */
+TEST(ZigguratTestCC, NormalFillTest)
+{
+  std::mt19937_64 rng{seed};
+  pdmpmt::normal_ziggurat<> dist{2., 3.};
+  std::vector<double> xs(n_samples);
+  EXPECT_EQ(xs.end(), dist.fill(rng, xs.begin(), xs.size()));
+  check_moments(xs, 2., 9.);
+}
+
+/**
+ * Test that scalar and bulk C++ exponential samples are scaled.
+ */
+TEST(ZigguratTestCC, ExponentialTest)
+{
+  std::mt19937_64 rng{seed};
+  pdmpmt::exponential_ziggurat<> dist{4.};
+  std::vector<double> xs(n_samples);
+  dist.fill(rng, xs.begin(), xs.size());
+  check_moments(xs, 0.25, 0.0625);
+  for (auto& x : xs)
+    x = dist(rng);
+  check_moments(xs, 0.25, 0.0625);
+}
+
+/**
+ * Test that the distribution parameters can be read, set, and compared.
+ *
+ * Drawing with explicit parameters gives the same value as drawing from a
+ * distribution holding those parameters.
+ */
+TEST(ZigguratTestCC, ParamTest)
+{
+  pdmpmt::normal_ziggurat<> normal{2., 3.};
+  EXPECT_EQ(2., normal.param().mean());
+  EXPECT_EQ(3., normal.param().stddev());
+  pdmpmt::normal_ziggurat<> other{normal.param()};
+  EXPECT_EQ(normal, other);
+  other.param(decltype(other)::param_type{});
+  EXPECT_NE(normal, other);
+  EXPECT_EQ(pdmpmt::normal_ziggurat<>{}, other);
+  std::mt19937_64 rng_a{seed}, rng_b{seed};
+  EXPECT_EQ(normal(rng_a), other(rng_b, normal.param()));
+  pdmpmt::exponential_ziggurat<> exponential{4.};
+  EXPECT_EQ(4., exponential.param().lambda());
+  pdmpmt::exponential_ziggurat<> other_exp;
+  EXPECT_NE(exponential, other_exp);
+  other_exp.param(exponential.param());
+  EXPECT_EQ(exponential, other_exp);
+  EXPECT_EQ(
+    exponential(rng_a),
+    pdmpmt::exponential_ziggurat<>{}(rng_b, exponential.param())
+  );
+}
+
+/**
+ * Test that the distributions and parameters round-trip through streams.
+ *
+ * Parameters that are not exactly representable in decimal must be restored
+ * exactly, and the formatting of the streams must be left unchanged.
+ */
+TEST(ZigguratTestCC, StreamTest)
+{
+  pdmpmt::normal_ziggurat<> normal{0.1, 1. / 3};
+  pdmpmt::exponential_ziggurat<> exponential{2. / 3};
+  std::stringstream ss;
+  ss << std::hex << std::fixed;
+  ss.precision(2);
+  ss << normal << ' ' << exponential << ' ' << normal.param() << ' ' <<
+    exponential.param();
+  EXPECT_EQ(std::ios_base::hex, ss.flags() & std::ios_base::basefield);
+  EXPECT_EQ(std::ios_base::fixed, ss.flags() & std::ios_base::floatfield);
+  EXPECT_EQ(2, ss.precision());
+  pdmpmt::normal_ziggurat<> normal_in;
+  pdmpmt::exponential_ziggurat<> exponential_in;
+  decltype(normal_in)::param_type normal_param;
+  decltype(exponential_in)::param_type exponential_param;
+  ASSERT_TRUE(
+    ss >> normal_in >> exponential_in >> normal_param >> exponential_param
+  );
+  EXPECT_EQ(normal, normal_in);
+  EXPECT_EQ(exponential, exponential_in);
+  EXPECT_EQ(normal.param(), normal_param);
+  EXPECT_EQ(exponential.param(), exponential_param);
+  EXPECT_EQ(std::ios_base::hex, ss.flags() & std::ios_base::basefield);
+  // equal distributions produce the same sequence of values
+  std::mt19937_64 rng_a{seed}, rng_b{seed};
+  EXPECT_EQ(normal(rng_a), normal_in(rng_b));
+  // failed reads leave the parameters unchanged
+  std::istringstream bad{"not a number"};
+  EXPECT_FALSE(bad >> normal_in);
+  EXPECT_EQ(normal, normal_in);
+}
+
+}  // namespace
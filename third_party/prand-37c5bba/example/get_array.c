@@ -0,0 +1,77 @@
+/*******************************************************************************
+* get_array.c: this file is an example for the usage of the prand library.
+ 
+* prand: C library for generating random numbers with multiple streams.
+
+* Github repository:
+        https://github.com/cheng-zhao/prand
+
+* Copyright (c) 2020 Cheng Zhao <zhaocheng03@gmail.com>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+*******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include "prand.h"
+
+#define SEED            1
+/* spans several regenerations of the Mersenne Twister state */
+#define NUM_SAMPLE      2000
+
+/* Check that bulk filling matches repeated single draws, with odd lengths. */
+static int run(const prand_rng_enum type, const char *name) {
+  int err = 0;
+  prand_t *a = prand_init(type, SEED, 1, 0, &err);
+  if (PRAND_IS_ERROR(err)) {
+    printf("Error: %s\n", prand_errmsg(err));
+    return err;
+  }
+  prand_t *b = prand_init(type, SEED, 1, 0, &err);
+  if (PRAND_IS_ERROR(err)) {
+    printf("Error: %s\n", prand_errmsg(err));
+    prand_destroy(a);
+    return err;
+  }
+  uint64_t x[NUM_SAMPLE];
+  int fail = 0;
+  for (size_t i = 0, len = 1; i < NUM_SAMPLE; i += len, len += 37) {
+    if (len > NUM_SAMPLE - i) len = NUM_SAMPLE - i;
+    b->get_array(b->state, x + i, len);
+  }
+  for (size_t i = 0; i < NUM_SAMPLE; i++) {
+    if (a->get(a->state) != x[i]) {
+      printf("Error: %s bulk fill differs at %zu\n", name, i);
+      fail = 1;
+      break;
+    }
+  }
+  if (!fail) printf("%s bulk fill matches\n", name);
+  prand_destroy(a);
+  prand_destroy(b);
+  return fail;
+}
+
+int main(void) {
+  if (run(PRAND_RNG_MRG32K3A, "MRG32k3a")) return EXIT_FAILURE;
+  if (run(PRAND_RNG_MT19937, "MT19937")) return EXIT_FAILURE;
+  return EXIT_SUCCESS;
+}
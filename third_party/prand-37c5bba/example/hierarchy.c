@@ -0,0 +1,144 @@
+/*******************************************************************************
+* hierarchy.c: this file is an example for the usage of the prand library.
+ 
+* prand: C library for generating random numbers with multiple streams.
+
+* Github repository:
+        https://github.com/cheng-zhao/prand
+
+* Copyright (c) 2020 Cheng Zhao <zhaocheng03@gmail.com>
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+*******************************************************************************/
+
+#include <stdio.h>
+#include <inttypes.h>
+#include "prand.h"
+
+#define SEED            1
+#define NUM_SAMPLE      10
+
+#define CHECK_ERROR(err)                        \
+  if (PRAND_IS_ERROR(err)) {                   \
+    printf("Error: %s\n", prand_errmsg(err));  \
+    return err;                                 \
+  }
+
+#define CHECK_SAME(x, y, msg)                   \
+  if ((x) != (y)) {                             \
+    printf("Error: %s\n", msg);                 \
+    return 1;                                   \
+  }
+
+/* Check that the first numbers of two nodes are identical. */
+static int same_start(prand_stream_t *a, prand_stream_t *b) {
+  for (int i = 0; i < NUM_SAMPLE; i++)
+    if (a->rng->get(a->rng->state) != b->rng->get(b->rng->state)) return 0;
+  prand_stream_reset_substream(a);
+  prand_stream_reset_substream(b);
+  return 1;
+}
+
+static int run(const prand_rng_enum type, const char *name) {
+  int err = 0;
+  prand_stream_t *root, *stream, *sub, *chunk, *chunk2;
+  printf("-> %s:\n", name);
+
+  root = prand_stream_init(type, SEED, &err);
+  CHECK_ERROR(err);
+
+  /* chunk 5 of substream 0 of stream 0, addressed directly from the root */
+  chunk = prand_stream_split(root, 3, 5, &err);
+  CHECK_ERROR(err);
+  stream = prand_stream_split(root, 1, 0, &err);
+  CHECK_ERROR(err);
+  sub = prand_stream_split(stream, 2, 0, &err);
+  CHECK_ERROR(err);
+  chunk2 = prand_stream_split(sub, 3, 5, &err);
+  CHECK_ERROR(err);
+  CHECK_SAME(same_start(chunk, chunk2), 1, "direct and nested splits differ");
+  printf("direct and nested splits agree\n");
+  prand_stream_destroy(chunk2);
+
+  /* walking the substreams of a node reaches the same chunk */
+  for (int i = 0; i < 5; i++) {
+    prand_stream_next_substream(sub, &err);
+    CHECK_ERROR(err);
+  }
+  CHECK_SAME(same_start(sub, chunk), 1, "next_substream and split differ");
+  printf("next_substream agrees with split\n");
+
+  /* the hierarchy agrees with the flat jump-ahead interface */
+  prand_t *rng = prand_init(type, SEED, 0, 0, &err);
+  CHECK_ERROR(err);
+  rng->jump(rng->state, (uint64_t) 5 << PRAND_STREAM_STEP_B2_2, &err);
+  CHECK_ERROR(err);
+  for (int i = 0; i < NUM_SAMPLE; i++)
+    CHECK_SAME(rng->get(rng->state), chunk->rng->get(chunk->rng->state),
+        "split and jump differ");
+  printf("split agrees with jump\n");
+
+  /* resetting the substream replays the same numbers */
+  prand_stream_reset_substream(chunk);
+  rng->reset(rng->state, SEED, (uint64_t) 5 << PRAND_STREAM_STEP_B2_2, &err);
+  CHECK_ERROR(err);
+  for (int i = 0; i < NUM_SAMPLE; i++)
+    CHECK_SAME(rng->get(rng->state), chunk->rng->get(chunk->rng->state),
+        "reset_substream does not replay the substream");
+  printf("reset_substream replays the substream\n");
+  prand_destroy(rng);
+  prand_stream_destroy(chunk);
+  prand_stream_destroy(sub);
+
+  /* strides beyond the maximum jump-ahead step */
+  chunk = prand_stream_split(root, 2,
+      (uint64_t) 1 << (PRAND_STREAM_STEP_B2_0 - PRAND_STREAM_STEP_B2_1), &err);
+  CHECK_ERROR(err);
+  prand_stream_next_substream(root, &err);
+  CHECK_ERROR(err);
+  CHECK_SAME(same_start(root, chunk), 1, "long strides differ");
+  printf("long strides agree\n");
+  prand_stream_destroy(chunk);
+
+  /* nodes must not overlap with siblings of their parent */
+  chunk = prand_stream_split(stream, 2,
+      (uint64_t) 1 << (PRAND_STREAM_STEP_B2_0 - PRAND_STREAM_STEP_B2_1), &err);
+  CHECK_SAME(err, PRAND_ERR_STEP, "overlapping split is not detected");
+  chunk = prand_stream_split(stream, 1, 0, &err);
+  CHECK_SAME(err, PRAND_ERR_LEVEL, "invalid level is not detected");
+  printf("invalid splits are detected\n");
+
+  /* a stale error from an earlier call does not block the next substream */
+  prand_stream_next_substream(stream, &err);
+  CHECK_ERROR(err);
+  CHECK_SAME(stream->sub_index, 1, "stale error blocks next_substream");
+  printf("next_substream ignores stale errors\n");
+
+  prand_stream_destroy(stream);
+  prand_stream_destroy(root);
+  return 0;
+}
+
+int main(void) {
+  int err;
+  if ((err = run(PRAND_RNG_MRG32K3A, "MRG32k3a"))) return err;
+  if ((err = run(PRAND_RNG_MT19937, "MT19937"))) return err;
+  return 0;
+}
@@ -31,6 +31,7 @@
 #ifndef __PRAND_H__
 #define __PRAND_H__
 
+#include <stddef.h>
 #include <stdint.h>
 
 /*============================================================================*\
@@ -49,6 +50,7 @@ typedef enum {
 #define PRAND_ERR_MEMORY_JUMP           (-2)
 #define PRAND_ERR_STEP                  (-3)
 #define PRAND_ERR_UNDEF_RNG             (-4)
+#define PRAND_ERR_LEVEL                 (-5)
 #define PRAND_WARN_SEED                 1
 
 #define PRAND_IS_ERROR(err)             ((err) < 0)
@@ -69,6 +71,8 @@ typedef struct prand_struct {
   uint64_t (*get) (void *);
   double (*get_double) (void *);
   double (*get_double_pos) (void *);
+  /* function pointer for filling an array with random integers */
+  void (*get_array) (void *, uint64_t *, const size_t);
   /* function pointers for reseting states with seed and skipping steps */
   void (*reset) (void *, const uint64_t, const uint64_t, int *);
   void (*reset_all) (struct prand_struct *, const uint64_t, const uint64_t,
@@ -76,8 +80,33 @@ typedef struct prand_struct {
   /* function pointers for jumping ahead */
   void (*jump) (void *, const uint64_t, int *);
   void (*jump_all) (struct prand_struct *, const uint64_t, int *);
+  /* sizes of a single state and of a jump-ahead operator (in bytes) */
+  size_t state_size;
+  size_t jump_size;
+  /* function pointers for jumping ahead 2^n steps and powers of it */
+  void (*jump_init) (void *, const int, int *);
+  void (*jump_pow) (void *, const void *, const uint64_t, int *);
 } prand_t;
 
+
+/*============================================================================*\
+                   Hierarchy of streams, substreams and chunks
+\*============================================================================*/
+
+#define PRAND_STREAM_NLEVEL     3       /* depth of the stream hierarchy */
+#define PRAND_STREAM_STEP_B2_0  127     /* distance between streams (log2) */
+#define PRAND_STREAM_STEP_B2_1  76      /* distance between substreams (log2) */
+#define PRAND_STREAM_STEP_B2_2  40      /* distance between chunks (log2) */
+
+typedef struct prand_stream_struct {
+  prand_t *rng;                 /* single-stream interface for sampling */
+  void *start;                  /* initial state of this node */
+  void *sub_start;              /* initial state of the current substream */
+  void *jump;                   /* jump-ahead operators for all levels */
+  int level;                    /* depth of the node, 0 for the root */
+  uint64_t sub_index;           /* index of the current substream */
+} prand_stream_t;
+
 /******************************************************************************
 Function `prand_init`:
   Initialisation of the interface for the selected random number generator.
@@ -111,5 +140,68 @@ Arguments:
 ******************************************************************************/
 void prand_destroy(prand_t *rng);
 
+/******************************************************************************
+Function `prand_stream_init`:
+  Initialisation of the root of a stream hierarchy.
+Arguments:
+  * `type`:     the ID of the pre-defined random number generator;
+  * `seed`:     an integer for initalisation the generator;
+  * `err`:      an integer for storing the error message.
+Return:
+  The root node, sampling from the start of the sequence.
+******************************************************************************/
+prand_stream_t *prand_stream_init(const prand_rng_enum type,
+    const uint64_t seed, int *err);
+
+/******************************************************************************
+Function `prand_stream_split`:
+  Create a node at a deeper level of the hierarchy, without creating any of
+  its siblings. The node starts from the `index`-th multiple of the distance
+  between nodes at `level`, counted from the initial state of `parent`.
+Arguments:
+  * `parent`:   the node to be split;
+  * `level`:    depth of the new node, from `parent->level + 1` to
+                `PRAND_STREAM_NLEVEL`;
+  * `index`:    index of the new node, counted from the start of `parent`;
+  * `err`:      an integer for storing the error message.
+Return:
+  The new node, which has to be released separately from `parent`.
+******************************************************************************/
+prand_stream_t *prand_stream_split(const prand_stream_t *parent,
+    const int level, const uint64_t index, int *err);
+
+/******************************************************************************
+Function `prand_stream_next_substream`:
+  Move the node to the start of its next substream.
+Arguments:
+  * `node`:     the node to be advanced;
+  * `err`:      an integer for storing the error message.
+******************************************************************************/
+void prand_stream_next_substream(prand_stream_t *node, int *err);
+
+/******************************************************************************
+Function `prand_stream_reset_substream`:
+  Move the node back to the start of its current substream.
+Arguments:
+  * `node`:     the node to be reset.
+******************************************************************************/
+void prand_stream_reset_substream(prand_stream_t *node);
+
+/******************************************************************************
+Function `prand_stream_reset_start`:
+  Move the node back to its initial state, i.e. the start of substream 0.
+Arguments:
+  * `node`:     the node to be reset.
+******************************************************************************/
+void prand_stream_reset_start(prand_stream_t *node);
+
+/******************************************************************************
+Function `prand_stream_destroy`:
+  Release memory allocated for a node of the stream hierarchy.
+Arguments:
+  * `node`:     the node to be released.
+******************************************************************************/
+void prand_stream_destroy(prand_stream_t *node);
+
 #endif
 
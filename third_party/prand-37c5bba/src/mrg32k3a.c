@@ -119,7 +119,7 @@ Arguments:
 Return:
   A pseudo-random integer.
 ******************************************************************************/
-static uint64_t mrg32k3a_get(void *state) {
+static inline uint64_t mrg32k3a_get(void *state) {
   mrg32k3a_state_t *stat = (mrg32k3a_state_t *) state;
 
   /* Component 1 */
@@ -139,6 +139,19 @@ static uint64_t mrg32k3a_get(void *state) {
   else return (p1 - p2);
 }
 
+/******************************************************************************
+Function `mrg32k3a_get_array`:
+  Fill an array with integers and update the state.
+Arguments:
+  * `state`:    the state for the generator;
+  * `out`:      the array to be filled;
+  * `n`:        number of integers to be generated.
+******************************************************************************/
+static void mrg32k3a_get_array(void *state, uint64_t *out, const size_t n) {
+  /* the recurrence is serial, but inlining avoids the indirect calls */
+  for (size_t i = 0; i < n; i++) out[i] = mrg32k3a_get(state);
+}
+
 /******************************************************************************
 Function `mrg32k3a_get_double`:
   Generate a double-precision floating-point number in the range [0,1).
@@ -437,6 +450,79 @@ static void mrg32k3a_reset_all(prand_t *rng, const uint64_t seed,
 }
 
 
+/******************************************************************************
+Function `mrg32k3a_jump_init`:
+  Compute the jump-ahead operator for 2^`log2step` steps. The operator
+  consists of the matrices A1 and A2, stored consecutively.
+Arguments:
+  * `jump`:     the operator to be computed, with 18 words;
+  * `log2step`: the number of steps to be skipped (in log2);
+  * `err`:      an integer for storing the error message.
+******************************************************************************/
+static void mrg32k3a_jump_init(void *jump, const int log2step, int *err) {
+  uint64_t *A1 = (uint64_t *) jump;
+  uint64_t *A2 = A1 + 9;
+  if (PRAND_IS_ERROR(*err)) return;
+
+  if (log2step < 0) {
+    *err = PRAND_ERR_STEP;
+    return;
+  }
+  /* Skip lengths beyond the pre-computed ones are reached by squaring. */
+  if (log2step < 63) {
+    matrix_pow(A1, A2, (uint64_t) 1 << log2step);
+    return;
+  }
+  matrix_pow(A1, A2, (uint64_t) 1 << 62);
+  for (int i = 62; i < log2step; i++) {
+    matrix_dot(A1, A1, A1, m1);
+    matrix_dot(A2, A2, A2, m2);
+  }
+}
+
+/******************************************************************************
+Function `mrg32k3a_jump_pow`:
+  Jump ahead for one stream, by applying a jump-ahead operator `n` times.
+  The power of the operator is evaluated with O(log n) matrix productions.
+Arguments:
+  * `state`:    the current state (to be over-written);
+  * `jump`:     the operator from `mrg32k3a_jump_init`;
+  * `n`:        number of times the operator is applied;
+  * `err`:      an integer for storing the error message.
+******************************************************************************/
+static void mrg32k3a_jump_pow(void *state, const void *jump, const uint64_t n,
+    int *err) {
+  mrg32k3a_state_t *stat = (mrg32k3a_state_t *) state;
+  uint64_t A1[9], A2[9], B1[9], B2[9];
+  if (PRAND_IS_ERROR(*err)) return;
+  if (!n) return;
+
+  memcpy(B1, jump, sizeof(B1));
+  memcpy(B2, (const uint64_t *) jump + 9, sizeof(B2));
+
+  /* Binary exponentiation: A = B^n. A starts as the power of B for the
+     lowest set bit of n, so it is always initialised before use. */
+  uint64_t k = n;
+  while (!(k & 1)) {
+    matrix_dot(B1, B1, B1, m1);
+    matrix_dot(B2, B2, B2, m2);
+    k >>= 1;
+  }
+  memcpy(A1, B1, sizeof(A1));
+  memcpy(A2, B2, sizeof(A2));
+  for (k >>= 1; k; k >>= 1) {
+    matrix_dot(B1, B1, B1, m1);
+    matrix_dot(B2, B2, B2, m2);
+    if (k & 1) {
+      matrix_dot(A1, A1, B1, m1);
+      matrix_dot(A2, A2, B2, m2);
+    }
+  }
+
+  state_forward(stat, stat, A1, A2);
+}
+
+
 /*============================================================================*\
                           Interface for initialisation
 \*============================================================================*/
@@ -493,10 +579,15 @@ prand_t *mrg32k3a_init(const uint64_t seed, const unsigned int nstream,
   rng->get = &mrg32k3a_get;
   rng->get_double = &mrg32k3a_get_double;
   rng->get_double_pos = &mrg32k3a_get_double_pos;
+  rng->get_array = &mrg32k3a_get_array;
   rng->reset = &mrg32k3a_reset;
   rng->reset_all = &mrg32k3a_reset_all;
   rng->jump = &mrg32k3a_jump;
   rng->jump_all = &mrg32k3a_jump_all;
+  rng->state_size = sizeof(mrg32k3a_state_t);
+  rng->jump_size = sizeof(uint64_t) * 18;
+  rng->jump_init = &mrg32k3a_jump_init;
+  rng->jump_pow = &mrg32k3a_jump_pow;
 
   if (seed == 0) {
     *err = PRAND_WARN_SEED;
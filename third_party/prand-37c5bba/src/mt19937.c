@@ -114,6 +114,35 @@ static void mt19937_seed(void *state, uint64_t seed) {
   stat->idx = i;
 }
 
+/******************************************************************************
+Function `mt19937_regen`:
+  Generate the next N words of the state at one time.
+Arguments:
+  * `stat`:     the state for the generator.
+******************************************************************************/
+static inline void mt19937_regen(mt19937_state_t *stat) {
+  uint32_t y;
+  int k;
+  for (k = 0; k < N - M; k++) {
+    y = UPPER_MASK(stat->mt[k]) | LOWER_MASK(stat->mt[k+1]);
+    stat->mt[k] = stat->mt[k+M] ^ (y >> 1) ^ MAGIC(y);
+  }
+  for (; k < N - 1; k++) {
+    y = UPPER_MASK(stat->mt[k]) | LOWER_MASK(stat->mt[k+1]);
+    stat->mt[k] = stat->mt[k+M-N] ^ (y >> 1) ^ MAGIC(y);
+  }
+  y = UPPER_MASK(stat->mt[N-1]) | LOWER_MASK(stat->mt[0]);
+  stat->mt[N-1] = stat->mt[M-1] ^ (y >> 1) ^ MAGIC(y);
+  stat->idx = 0;
+}
+
+/* Tempering of a word of the state. */
+#define MT19937_TEMPER(y)       ( \
+  (y) ^= ((y) >> 11),             \
+  (y) ^= ((y) << 7) & 0x9d2c5680UL, \
+  (y) ^= ((y) << 15) & 0xefc60000UL, \
+  (y) ^ ((y) >> 18))
+
 /******************************************************************************
 Function `mt19937_get`:
   Generate an integer and update the state.
@@ -126,31 +155,39 @@ static uint64_t mt19937_get(void *state) {
   mt19937_state_t *stat = (mt19937_state_t *) state;
   uint32_t y;
 
-  if (stat->idx >= N) {         /* generate N words at one time */
-    int k;
-    for (k = 0; k < N - M; k++) {
-      y = UPPER_MASK(stat->mt[k]) | LOWER_MASK(stat->mt[k+1]);
-      stat->mt[k] = stat->mt[k+M] ^ (y >> 1) ^ MAGIC(y);
-    }
-    for (; k < N - 1; k++) {
-      y = UPPER_MASK(stat->mt[k]) | LOWER_MASK(stat->mt[k+1]);
-      stat->mt[k] = stat->mt[k+M-N] ^ (y >> 1) ^ MAGIC(y);
-    }
-    y = UPPER_MASK(stat->mt[N-1]) | LOWER_MASK(stat->mt[0]);
-    stat->mt[N-1] = stat->mt[M-1] ^ (y >> 1) ^ MAGIC(y);
-    stat->idx = 0;
-  }
+  if (stat->idx >= N) mt19937_regen(stat);      /* generate N words at one time */
 
   /* tempering */
   y = stat->mt[stat->idx];
-
-  y ^= (y >> 11);
-  y ^= (y << 7) & 0x9d2c5680UL;
-  y ^= (y << 15) & 0xefc60000UL;
-  y ^= (y >> 18);
-
   stat->idx += 1;
-  return y;
+  return MT19937_TEMPER(y);
+}
+
+/******************************************************************************
+Function `mt19937_get_array`:
+  Fill an array with integers and update the state.
+Arguments:
+  * `state`:    the state for the generator;
+  * `out`:      the array to be filled;
+  * `n`:        number of integers to be generated.
+******************************************************************************/
+static void mt19937_get_array(void *state, uint64_t *out, const size_t n) {
+  mt19937_state_t *stat = (mt19937_state_t *) state;
+  size_t i = 0;
+
+  while (i < n) {
+    if (stat->idx >= N) mt19937_regen(stat);
+    /* temper the remaining words of the block in a branch-free loop */
+    size_t len = N - stat->idx;
+    if (len > n - i) len = n - i;
+    const uint32_t *mt = stat->mt + stat->idx;
+    for (size_t j = 0; j < len; j++) {
+      uint32_t y = mt[j];
+      out[i + j] = MT19937_TEMPER(y);
+    }
+    stat->idx += (int) len;
+    i += len;
+  }
 }
 
 /******************************************************************************
@@ -499,6 +536,97 @@ static void mt19937_reset_all(prand_t *rng, const uint64_t seed,
 }
 
 
+/******************************************************************************
+Function `mt19937_jump_init`:
+  Compute the jump-ahead polynomial for 2^`log2step` steps.
+Arguments:
+  * `jump`:     the polynomial to be computed, with N words;
+  * `log2step`: the number of steps to be skipped (in log2);
+  * `err`:      an integer for storing the error message.
+******************************************************************************/
+static void mt19937_jump_init(void *jump, const int log2step, int *err) {
+  if (PRAND_IS_ERROR(*err)) return;
+
+  if (log2step < 0) {
+    *err = PRAND_ERR_STEP;
+    return;
+  }
+  /* Skip lengths beyond the pre-computed ones are reached by squaring. */
+  uint32_t *poly = get_poly((uint64_t) 1 << (log2step < 63 ? log2step : 62));
+  if (!poly) {
+    *err = PRAND_ERR_MEMORY_JUMP;
+    return;
+  }
+
+  uint32_t *pm = poly + N;      /* 2N words for the result of multiplication */
+  uint32_t *tmp = pm + (N << 1);        /* temporary array for multiplication */
+  for (int i = 62; i < log2step; i++) {
+    poly_mul(pm, poly, poly, N, tmp);
+    poly_mod_phi(pm, tmp);
+    memcpy(poly, pm, sizeof(uint32_t) * N);
+  }
+
+  memcpy(jump, poly, sizeof(uint32_t) * N);
+  free(poly);
+}
+
+/******************************************************************************
+Function `mt19937_jump_pow`:
+  Jump ahead for one stream, by applying a jump-ahead polynomial `n` times.
+  The power of the polynomial is evaluated with O(log n) multiplications.
+Arguments:
+  * `state`:    the current state (to be over-written);
+  * `jump`:     the polynomial from `mt19937_jump_init`;
+  * `n`:        number of times the polynomial is applied;
+  * `err`:      an integer for storing the error message.
+******************************************************************************/
+static void mt19937_jump_pow(void *state, const void *jump, const uint64_t n,
+    int *err) {
+  mt19937_state_t *stat = (mt19937_state_t *) state;
+  if (PRAND_IS_ERROR(*err)) return;
+  if (!n) return;
+
+  /* Same layout as `get_poly`, with N extra words for the squared base. */
+  uint32_t *poly = calloc(N * 12, sizeof(uint32_t));
+  if (!poly) {
+    *err = PRAND_ERR_MEMORY_JUMP;
+    return;
+  }
+  uint32_t *pm = poly + N;
+  uint32_t *tmp = pm + (N << 1);
+  uint32_t *base = poly + N * 11;
+  memcpy(base, jump, sizeof(uint32_t) * N);
+
+  /* Binary exponentiation: poly = base^n % phi. */
+  uint64_t k = n;
+  int init = 0;
+  while (k) {
+    if (k & 1) {
+      if (!init) {
+        memcpy(poly, base, sizeof(uint32_t) * N);
+        init = 1;
+      }
+      else {
+        poly_mul(pm, poly, base, N, tmp);
+        poly_mod_phi(pm, tmp);
+        memcpy(poly, pm, sizeof(uint32_t) * N);
+      }
+    }
+    k >>= 1;
+    if (k) {
+      poly_mul(pm, base, base, N, tmp);
+      poly_mod_phi(pm, tmp);
+      memcpy(base, pm, sizeof(uint32_t) * N);
+    }
+  }
+
+  /* Advance states with the polynomial. */
+  state_forward(stat, stat, poly);
+
+  free(poly);
+}
+
+
 /*============================================================================*\
                           Interface for initialisation
 \*============================================================================*/
@@ -555,10 +683,15 @@ prand_t *mt19937_init(const uint64_t seed, const unsigned int nstream,
   rng->get = &mt19937_get;
   rng->get_double = &mt19937_get_double;
   rng->get_double_pos = &mt19937_get_double_pos;
+  rng->get_array = &mt19937_get_array;
   rng->reset = &mt19937_reset;
   rng->reset_all = &mt19937_reset_all;
   rng->jump = &mt19937_jump;
   rng->jump_all = &mt19937_jump_all;
+  rng->state_size = sizeof(mt19937_state_t);
+  rng->jump_size = sizeof(uint32_t) * N;
+  rng->jump_init = &mt19937_jump_init;
+  rng->jump_pow = &mt19937_jump_pow;
 
   if (seed == 0) {
     *err = PRAND_WARN_SEED;
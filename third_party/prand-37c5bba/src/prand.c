@@ -32,6 +32,12 @@
 #include "mrg32k3a.h"
 #include "mt19937.h"
 #include <stdlib.h>
+#include <string.h>
+
+/* Distance between sibling nodes at each level of the hierarchy (in log2). */
+static const int prand_stream_step_b2[PRAND_STREAM_NLEVEL] = {
+  PRAND_STREAM_STEP_B2_0, PRAND_STREAM_STEP_B2_1, PRAND_STREAM_STEP_B2_2
+};
 
 /******************************************************************************
 Function `prand_init`:
@@ -79,6 +85,8 @@ const char *prand_errmsg(const int err) {
       return "the step size for jumping ahead is too large";
     case PRAND_ERR_UNDEF_RNG:
       return "the type of the random number generator is undefined";
+    case PRAND_ERR_LEVEL:
+      return "invalid level for the hierarchy of streams";
     case PRAND_WARN_SEED:
       return "invalid seed value";
     default:
@@ -98,3 +106,205 @@ void prand_destroy(prand_t *rng) {
   free(rng);
 }
 
+
+/*============================================================================*\
+                    Hierarchy of streams, substreams and chunks
+\*============================================================================*/
+
+/******************************************************************************
+Function `stream_alloc`:
+  Allocate a node of the stream hierarchy, with an uninitialised state.
+Arguments:
+  * `type`:     the ID of the pre-defined random number generator;
+  * `seed`:     an integer for initalisation the generator;
+  * `err`:      an integer for storing the error message.
+Return:
+  The node, with the states and jump-ahead operators allocated.
+******************************************************************************/
+static prand_stream_t *stream_alloc(const prand_rng_enum type,
+    const uint64_t seed, int *err) {
+  prand_stream_t *node = malloc(sizeof(prand_stream_t));
+  if (!node) {
+    *err = PRAND_ERR_MEMORY;
+    return NULL;
+  }
+
+  node->rng = prand_init(type, seed, 0, 0, err);
+  if (PRAND_IS_ERROR(*err)) {
+    free(node);
+    return NULL;
+  }
+
+  /* The initial states and operators share a single allocation. */
+  const size_t ssize = node->rng->state_size;
+  node->start = malloc(ssize * 2 + node->rng->jump_size * PRAND_STREAM_NLEVEL);
+  if (!node->start) {
+    prand_destroy(node->rng);
+    free(node);
+    *err = PRAND_ERR_MEMORY;
+    return NULL;
+  }
+  node->sub_start = (char *) node->start + ssize;
+  node->jump = (char *) node->sub_start + ssize;
+  node->level = 0;
+  node->sub_index = 0;
+  return node;
+}
+
+/******************************************************************************
+Function `prand_stream_init`:
+  Initialisation of the root of a stream hierarchy.
+Arguments:
+  * `type`:     the ID of the pre-defined random number generator;
+  * `seed`:     an integer for initalisation the generator;
+  * `err`:      an integer for storing the error message.
+Return:
+  The root node, sampling from the start of the sequence.
+******************************************************************************/
+prand_stream_t *prand_stream_init(const prand_rng_enum type,
+    const uint64_t seed, int *err) {
+  *err = 0;
+  prand_stream_t *node = stream_alloc(type, seed, err);
+  if (!node) return NULL;
+
+  /* The operators are computed once and copied to all descendants. */
+  const prand_t *rng = node->rng;
+  for (int i = 0; i < PRAND_STREAM_NLEVEL; i++)
+    rng->jump_init((char *) node->jump + rng->jump_size * i,
+        prand_stream_step_b2[i], err);
+  if (PRAND_IS_ERROR(*err)) {
+    prand_stream_destroy(node);
+    return NULL;
+  }
+
+  memcpy(node->start, rng->state, rng->state_size);
+  memcpy(node->sub_start, rng->state, rng->state_size);
+  return node;
+}
+
+/******************************************************************************
+Function `stream_count_b2`:
+  Number of nodes at `level` that fit into a node at `parent_level` (in log2).
+Arguments:
+  * `parent_level`:     depth of the enclosing node;
+  * `level`:            depth of the enclosed nodes.
+Return:
+  The number of nodes in log2, or a negative value if it is unlimited.
+******************************************************************************/
+static inline int stream_count_b2(const int parent_level, const int level) {
+  if (parent_level == 0) return -1;
+  return prand_stream_step_b2[parent_level - 1] -
+      prand_stream_step_b2[level - 1];
+}
+
+/******************************************************************************
+Function `prand_stream_split`:
+  Create a node at a deeper level of the hierarchy, without creating any of
+  its siblings. The node starts from the `index`-th multiple of the distance
+  between nodes at `level`, counted from the initial state of `parent`.
+Arguments:
+  * `parent`:   the node to be split;
+  * `level`:    depth of the new node, from `parent->level + 1` to
+                `PRAND_STREAM_NLEVEL`;
+  * `index`:    index of the new node, counted from the start of `parent`;
+  * `err`:      an integer for storing the error message.
+Return:
+  The new node, which has to be released separately from `parent`.
+******************************************************************************/
+prand_stream_t *prand_stream_split(const prand_stream_t *parent,
+    const int level, const uint64_t index, int *err) {
+  *err = 0;
+  if (level <= parent->level || level > PRAND_STREAM_NLEVEL) {
+    *err = PRAND_ERR_LEVEL;
+    return NULL;
+  }
+  /* The new node must not overlap with the siblings of `parent`. */
+  const int nb2 = stream_count_b2(parent->level, level);
+  if (nb2 >= 0 && nb2 < 64 && index >> nb2) {
+    *err = PRAND_ERR_STEP;
+    return NULL;
+  }
+
+  const prand_t *prng = parent->rng;
+  prand_stream_t *node = stream_alloc(prng->type, 1, err);
+  if (!node) return NULL;
+  memcpy(node->jump, parent->jump, prng->jump_size * PRAND_STREAM_NLEVEL);
+  memcpy(node->start, parent->start, prng->state_size);
+
+  /* A single jump ahead, regardless of the number of siblings. */
+  prng->jump_pow(node->start,
+      (char *) parent->jump + prng->jump_size * (level - 1), index, err);
+  if (PRAND_IS_ERROR(*err)) {
+    prand_stream_destroy(node);
+    return NULL;
+  }
+
+  node->level = level;
+  memcpy(node->sub_start, node->start, prng->state_size);
+  memcpy(node->rng->state, node->start, prng->state_size);
+  return node;
+}
+
+/******************************************************************************
+Function `prand_stream_next_substream`:
+  Move the node to the start of its next substream.
+Arguments:
+  * `node`:     the node to be advanced;
+  * `err`:      an integer for storing the error message.
+******************************************************************************/
+void prand_stream_next_substream(prand_stream_t *node, int *err) {
+  const prand_t *rng = node->rng;
+  *err = 0;
+
+  /* Nodes at the deepest level have no substreams. */
+  if (node->level >= PRAND_STREAM_NLEVEL) {
+    *err = PRAND_ERR_LEVEL;
+    return;
+  }
+  const int nb2 = stream_count_b2(node->level, node->level + 1);
+  if (nb2 >= 0 && nb2 < 64 && (node->sub_index + 1) >> nb2) {
+    *err = PRAND_ERR_STEP;
+    return;
+  }
+
+  rng->jump_pow(node->sub_start,
+      (char *) node->jump + rng->jump_size * node->level, 1, err);
+  if (PRAND_IS_ERROR(*err)) return;
+  node->sub_index++;
+  memcpy(rng->state, node->sub_start, rng->state_size);
+}
+
+/******************************************************************************
+Function `prand_stream_reset_substream`:
+  Move the node back to the start of its current substream.
+Arguments:
+  * `node`:     the node to be reset.
+******************************************************************************/
+void prand_stream_reset_substream(prand_stream_t *node) {
+  memcpy(node->rng->state, node->sub_start, node->rng->state_size);
+}
+
+/******************************************************************************
+Function `prand_stream_reset_start`:
+  Move the node back to its initial state, i.e. the start of substream 0.
+Arguments:
+  * `node`:     the node to be reset.
+******************************************************************************/
+void prand_stream_reset_start(prand_stream_t *node) {
+  memcpy(node->sub_start, node->start, node->rng->state_size);
+  memcpy(node->rng->state, node->start, node->rng->state_size);
+  node->sub_index = 0;
+}
+
+/******************************************************************************
+Function `prand_stream_destroy`:
+  Release memory allocated for a node of the stream hierarchy.
+Arguments:
+  * `node`:     the node to be released.
+******************************************************************************/
+void prand_stream_destroy(prand_stream_t *node) {
+  if (!node) return;
+  free(node->start);
+  prand_destroy(node->rng);
+  free(node);
+}